@@ -0,0 +1,138 @@
+//
+//  SPBenchmarkSuite.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Foundation/Foundation.h>
+#import <Sparrow/Sparrow.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPBenchmarkSuite;
+
+typedef void (^SPBenchmarkSetupBlock)(SPBenchmarkSuite *suite, SPSprite *root);
+typedef void (^SPBenchmarkFrameBlock)(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame);
+
+/** ------------------------------------------------------------------------------------------------
+
+ A benchmark scenario describes one scripted scene of the benchmark suite.
+
+ The setup block populates an empty root sprite; the (optional) frame block is executed once per
+ frame, right before the suite advances time by one fixed timestep and renders the stage.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPBenchmarkScenario : NSObject
+
+/// Initializes a scenario with a name, a setup block and an optional frame block.
+- (instancetype)initWithName:(NSString *)name setup:(SPBenchmarkSetupBlock)setup
+                       frame:(nullable SPBenchmarkFrameBlock)frame;
+
+/// Factory method.
++ (instancetype)scenarioWithName:(NSString *)name setup:(SPBenchmarkSetupBlock)setup
+                           frame:(nullable SPBenchmarkFrameBlock)frame;
+
+/// The name of the scenario, as it appears in the results.
+@property (nonatomic, readonly) NSString *name;
+
+/// The block that creates the scenario's display objects.
+@property (nonatomic, readonly) SPBenchmarkSetupBlock setupBlock;
+
+/// The block that is executed once per frame.
+@property (nonatomic, readonly, nullable) SPBenchmarkFrameBlock frameBlock;
+
+@end
+
+/** ------------------------------------------------------------------------------------------------
+
+ The benchmark suite runs a set of scenarios without any user interface and reports the results
+ in a machine-readable format.
+
+ The suite sets up its own (offscreen) rendering context and a view controller that is never
+ displayed. Each scenario is rendered into a render texture with a fixed timestep, and all random
+ values are taken from a generator with a fixed seed, so two runs of the same engine version
+ process exactly the same frames.
+
+ For each scenario, the suite measures the CPU time per frame (advancing time plus rendering,
+ excluding the time the GPU needs to finish), the number of draw calls, the number of quads and
+ the number of vertex bytes uploaded to the GPU.
+
+	SPBenchmarkSuite *suite = [[SPBenchmarkSuite alloc] initWithSeed:42];
+	[suite addDefaultScenarios];
+	[suite writeResultsToFile:@"/tmp/benchmark.json"];
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPBenchmarkSuite : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a suite with the seed for its random number generator. _Designated Initializer_.
+- (instancetype)initWithSeed:(uint)seed;
+
+/// Initializes a suite with a default seed.
+- (instancetype)init;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Adds a scenario to the suite.
+- (void)addScenario:(SPBenchmarkScenario *)scenario;
+
+/// Adds the standard scenarios: moving images, mixed atlases, text fields, filters, masks,
+/// flatten/unflatten and tweens.
+- (void)addDefaultScenarios;
+
+/// Runs all scenarios and returns the results as a JSON-compatible dictionary.
+- (NSDictionary *)run;
+
+/// Runs all scenarios and writes the results as JSON to the given path.
+- (BOOL)writeResultsToFile:(NSString *)path;
+
+/// Returns a deterministic random number between 0.0 and 1.0.
+- (float)randomFloat;
+
+/// Returns a deterministic random number between 'minValue' (inclusive) and 'maxValue' (exclusive).
+- (float)randomFloatBetweenMin:(float)minValue andMax:(float)maxValue;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The seed of the random number generator. It is restored before each scenario.
+@property (nonatomic, readonly) uint seed;
+
+/// The time that passes between two frames, in seconds. Default: 1/60.
+@property (nonatomic, assign) double timestep;
+
+/// The number of frames that are rendered before the measurement starts. Default: 30.
+@property (nonatomic, assign) NSInteger numWarmupFrames;
+
+/// The number of frames that are measured per scenario. Default: 300.
+@property (nonatomic, assign) NSInteger numFrames;
+
+/// The size of the stage, in points. Default: 320x480.
+@property (nonatomic, assign) float stageWidth;
+@property (nonatomic, assign) float stageHeight;
+
+/// The juggler that is advanced once per frame.
+@property (nonatomic, readonly) SPJuggler *juggler;
+
+/// A small circular texture that is used by the standard scenarios.
+@property (nonatomic, readonly) SPTexture *objectTexture;
+
+/// The scenarios of the suite.
+@property (nonatomic, readonly) SP_GENERIC(NSArray, SPBenchmarkScenario*) *scenarios;
+
+@end
+
+NS_ASSUME_NONNULL_END
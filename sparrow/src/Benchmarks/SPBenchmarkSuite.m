@@ -0,0 +1,482 @@
+//
+//  SPBenchmarkSuite.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBenchmarkSuite.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+#define DEFAULT_SEED 0x5eed
+
+// --- scenario implementation ---------------------------------------------------------------------
+
+@implementation SPBenchmarkScenario
+
+- (instancetype)initWithName:(NSString *)name setup:(SPBenchmarkSetupBlock)setup
+                       frame:(SPBenchmarkFrameBlock)frame
+{
+    if ((self = [super init]))
+    {
+        _name = [name copy];
+        _setupBlock = [setup copy];
+        _frameBlock = [frame copy];
+    }
+    return self;
+}
+
++ (instancetype)scenarioWithName:(NSString *)name setup:(SPBenchmarkSetupBlock)setup
+                           frame:(SPBenchmarkFrameBlock)frame
+{
+    return [[self alloc] initWithName:name setup:setup frame:frame];
+}
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPBenchmarkSuite
+{
+    SPViewController *_controller;
+    SPContext *_context;
+    SPRenderSupport *_support;
+    SPRenderTexture *_renderTarget;
+    SPTexture *_objectTexture;
+    SP_GENERIC(NSMutableArray, SPBenchmarkScenario*) *_scenarios;
+    uint _randomState;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithSeed:(uint)seed
+{
+    if ((self = [super init]))
+    {
+        _seed = seed ?: DEFAULT_SEED;
+        _randomState = _seed;
+        _timestep = 1.0 / 60.0;
+        _numWarmupFrames = 30;
+        _numFrames = 300;
+        _stageWidth = 320;
+        _stageHeight = 480;
+        _scenarios = [[NSMutableArray alloc] init];
+
+        // the controller is never displayed; it provides the stage, the juggler and the
+        // program cache that are used by the rendering code.
+        _controller = [[SPViewController alloc] init];
+        [_controller makeCurrent];
+
+        _context = [[SPContext alloc] init];
+        if (![SPContext setCurrentContext:_context])
+            [NSException raise:SPExceptionOperationFailed format:@"could not create render context"];
+
+        _support = [[SPRenderSupport alloc] init];
+        _objectTexture = [[SPTexture alloc] initWithWidth:32 height:32 draw:^(CGContextRef context)
+        {
+            CGContextSetRGBFillColor(context, 1.0f, 0.8f, 0.2f, 1.0f);
+            CGContextFillEllipseInRect(context, CGRectMake(0, 0, 32, 32));
+        }];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithSeed:DEFAULT_SEED];
+}
+
+#pragma mark Methods
+
+- (void)addScenario:(SPBenchmarkScenario *)scenario
+{
+    [_scenarios addObject:scenario];
+}
+
+- (NSDictionary *)run
+{
+    SP_GENERIC(NSMutableArray, NSDictionary*) *scenarioResults = [NSMutableArray array];
+
+    [self setupStage];
+
+    for (SPBenchmarkScenario *scenario in _scenarios)
+    {
+        @autoreleasepool
+        {
+            [scenarioResults addObject:[self runScenario:scenario]];
+        }
+    }
+
+    return @{
+        @"engine":       SPARROW_VERSION,
+        @"platform":     [[UIDevice currentDevice] platform],
+        @"seed":         @(_seed),
+        @"timestep":     @(_timestep),
+        @"warmupFrames": @(_numWarmupFrames),
+        @"frames":       @(_numFrames),
+        @"stageWidth":   @(_stageWidth),
+        @"stageHeight":  @(_stageHeight),
+        @"scenarios":    scenarioResults
+    };
+}
+
+- (BOOL)writeResultsToFile:(NSString *)path
+{
+    NSError *error = nil;
+    NSData *json = [NSJSONSerialization dataWithJSONObject:[self run]
+                                                   options:NSJSONWritingPrettyPrinted error:&error];
+
+    if (!json || ![json writeToFile:path options:NSDataWritingAtomic error:&error])
+    {
+        SPLog(@"Could not write benchmark results to '%@': %@", path, error);
+        return NO;
+    }
+
+    return YES;
+}
+
+- (float)randomFloat
+{
+    // xorshift32 -- small, fast and identical on every platform.
+    _randomState ^= _randomState << 13;
+    _randomState ^= _randomState >> 17;
+    _randomState ^= _randomState << 5;
+    return (_randomState >> 8) / (float)(1 << 24);
+}
+
+- (float)randomFloatBetweenMin:(float)minValue andMax:(float)maxValue
+{
+    return minValue + [self randomFloat] * (maxValue - minValue);
+}
+
+#pragma mark Scenarios
+
+- (void)addDefaultScenarios
+{
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"images" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         // the classic: lots of rotating images in a rotating container (see 'BenchmarkScene').
+         SPSprite *container = [SPSprite sprite];
+         container.x = suite.stageWidth  / 2;
+         container.y = suite.stageHeight / 2;
+         [root addChild:container];
+
+         for (NSInteger i=0; i<1000; ++i)
+         {
+             SPImage *image = [SPImage imageWithTexture:suite.objectTexture];
+             float distance = [suite randomFloatBetweenMin:100 andMax:200];
+             float angle = [suite randomFloat] * TWO_PI;
+             [image alignPivotToCenter];
+             image.x = cosf(angle) * distance;
+             image.y = sinf(angle) * distance;
+             image.rotation = angle + PI_HALF;
+             [container addChild:image];
+         }
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         SPDisplayObject *container = root[0];
+         container.rotation += suite.timestep * 0.5;
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"mixedAtlases" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         // images from two different atlases, randomly interleaved; each texture switch
+         // breaks the batch.
+         NSMutableArray *atlases = [NSMutableArray array];
+         for (NSInteger a=0; a<2; ++a)
+         {
+             SPTexture *texture = [SPTexture textureWithWidth:128 height:128 draw:^(CGContextRef context)
+             {
+                 for (NSInteger i=0; i<16; ++i)
+                 {
+                     CGContextSetRGBFillColor(context, (i % 4) / 3.0f, (i / 4) / 3.0f, a, 1.0f);
+                     CGContextFillRect(context, CGRectMake((i % 4) * 32, (i / 4) * 32, 32, 32));
+                 }
+             }];
+
+             SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithTexture:texture];
+             [atlases addObject:atlas];
+
+             for (NSInteger i=0; i<16; ++i)
+                 [atlas addRegion:[SPRectangle rectangleWithX:(i % 4) * 32 y:(i / 4) * 32
+                                                        width:32 height:32]
+                         withName:[NSString stringWithFormat:@"tile_%02ld", (long)i]];
+         }
+
+         for (NSInteger i=0; i<600; ++i)
+         {
+             SPTextureAtlas *atlas = atlases[[suite randomFloat] < 0.5f ? 0 : 1];
+             NSString *name = [NSString stringWithFormat:@"tile_%02d", (int)([suite randomFloat] * 16)];
+             SPImage *image = [SPImage imageWithTexture:[atlas textureByName:name]];
+             image.x = [suite randomFloatBetweenMin:0 andMax:suite.stageWidth  - 32];
+             image.y = [suite randomFloatBetweenMin:0 andMax:suite.stageHeight - 32];
+             [root addChild:image];
+         }
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         float offset = (frame % 2) ? 1.0f : -1.0f;
+         for (SPDisplayObject *child in root) child.x += offset;
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"textFields" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         for (NSInteger i=0; i<40; ++i)
+         {
+             SPTextField *textField = [SPTextField textFieldWithWidth:150 height:20 text:@"0"];
+             textField.x = (i % 2) * 160;
+             textField.y = (i / 2) * 24;
+
+             // every fourth text field uses a system font, the others the embedded bitmap font
+             if (i % 4) textField.fontName = SPBitmapFontMiniName;
+             [root addChild:textField];
+         }
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         NSInteger i = 0;
+         for (SPTextField *textField in root)
+         {
+             // bitmap text changes every frame, system font text every 10 frames
+             if ((i++ % 4) || frame % 10 == 0)
+                 textField.text = [NSString stringWithFormat:@"Score: %ld", (long)(frame * 17 + i)];
+         }
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"filters" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         for (NSInteger i=0; i<12; ++i)
+         {
+             SPSprite *sprite = [SPSprite sprite];
+             for (NSInteger j=0; j<4; ++j)
+             {
+                 SPImage *image = [SPImage imageWithTexture:suite.objectTexture];
+                 image.x = j * 20;
+                 [sprite addChild:image];
+             }
+
+             switch (i % 3)
+             {
+                 case 0:  sprite.filter = [SPBlurFilter glow]; break;
+                 case 1:  sprite.filter = [SPBlurFilter dropShadow]; break;
+                 default:
+                 {
+                     SPColorMatrixFilter *filter = [SPColorMatrixFilter colorMatrixFilter];
+                     [filter adjustSaturation:-1];
+                     sprite.filter = filter;
+                 }
+             }
+
+             sprite.x = [suite randomFloatBetweenMin:0 andMax:suite.stageWidth  - 100];
+             sprite.y = [suite randomFloatBetweenMin:0 andMax:suite.stageHeight - 40];
+             [root addChild:sprite];
+         }
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         for (SPSprite *sprite in root)
+             ((SPDisplayObject *)sprite[0]).rotation += suite.timestep;
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"masks" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         // scroll panes: clipped by rectangular quads, with nested masks in every other pane
+         for (NSInteger i=0; i<8; ++i)
+         {
+             SPSprite *pane = [SPSprite sprite];
+             pane.x = (i % 2) * 160;
+             pane.y = (i / 2) * 120;
+             pane.mask = [SPQuad quadWithWidth:150 height:110];
+             [root addChild:pane];
+
+             SPSprite *content = [SPSprite sprite];
+             if (i % 2) content.mask = [SPQuad quadWithWidth:100 height:60];
+             [pane addChild:content];
+
+             for (NSInteger j=0; j<20; ++j)
+             {
+                 SPImage *image = [SPImage imageWithTexture:suite.objectTexture];
+                 image.x = [suite randomFloatBetweenMin:-20 andMax:150];
+                 image.y = [suite randomFloatBetweenMin:-20 andMax:110];
+                 [content addChild:image];
+             }
+         }
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         for (SPSprite *pane in root)
+         {
+             SPDisplayObject *content = pane[0];
+             content.y = sinf(frame * suite.timestep) * 20;
+         }
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"flatten" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         SPSprite *sprite = [SPSprite sprite];
+         for (NSInteger i=0; i<500; ++i)
+         {
+             SPImage *image = [SPImage imageWithTexture:suite.objectTexture];
+             image.x = [suite randomFloatBetweenMin:0 andMax:suite.stageWidth  - 32];
+             image.y = [suite randomFloatBetweenMin:0 andMax:suite.stageHeight - 32];
+             image.alpha = [suite randomFloatBetweenMin:0.5f andMax:1.0f];
+             [sprite addChild:image];
+         }
+         [root addChild:sprite];
+     }
+     frame:^(SPBenchmarkSuite *suite, SPSprite *root, NSInteger frame)
+     {
+         // flatten for 30 frames, then render unflattened for 30 frames
+         SPSprite *sprite = (SPSprite *)root[0];
+         if      (frame % 60 ==  0) [sprite flatten];
+         else if (frame % 60 == 30) [sprite unflatten];
+     }]];
+
+    [self addScenario:[SPBenchmarkScenario scenarioWithName:@"tweens" setup:
+     ^(SPBenchmarkSuite *suite, SPSprite *root)
+     {
+         for (NSInteger i=0; i<500; ++i)
+         {
+             SPQuad *quad = [SPQuad quadWithWidth:8 height:8 color:0xff0000 + i];
+             quad.x = [suite randomFloatBetweenMin:0 andMax:suite.stageWidth];
+             quad.y = [suite randomFloatBetweenMin:0 andMax:suite.stageHeight];
+             [root addChild:quad];
+
+             SPTween *tween = [SPTween tweenWithTarget:quad time:[suite randomFloatBetweenMin:0.5f andMax:2.0f]
+                                            transition:SPTransitionEaseInOut];
+             [tween moveToX:[suite randomFloatBetweenMin:0 andMax:suite.stageWidth]
+                          y:[suite randomFloatBetweenMin:0 andMax:suite.stageHeight]];
+             [tween animateProperty:@"rotation" targetValue:PI];
+             [tween fadeTo:0.2f];
+             tween.repeatCount = 0;
+             tween.reverse = YES;
+             [suite.juggler addObject:tween];
+         }
+     }
+     frame:nil]];
+}
+
+#pragma mark Private
+
+- (void)setupStage
+{
+    SPStage *stage = _controller.stage;
+    stage.width  = _stageWidth;
+    stage.height = _stageHeight;
+
+    if (!_renderTarget || _renderTarget.width != _stageWidth || _renderTarget.height != _stageHeight)
+        _renderTarget = [[SPRenderTexture alloc] initWithWidth:_stageWidth height:_stageHeight
+                                                     fillColor:0x0 scale:1.0f];
+}
+
+- (NSDictionary *)runScenario:(SPBenchmarkScenario *)scenario
+{
+    SPStage *stage = _controller.stage;
+    SPSprite *root = [SPSprite sprite];
+    NSInteger numFrames = MAX(1, _numFrames);
+    double *frameTimes = calloc(numFrames, sizeof(double));
+    double totalDrawCalls = 0, totalQuads = 0, totalBytesUploaded = 0;
+
+    _randomState = _seed;
+    [_controller makeCurrent];
+    [SPContext setCurrentContext:_context];
+    [_controller.juggler removeAllObjects];
+
+    scenario.setupBlock(self, root);
+    [stage addChild:root];
+
+    for (NSInteger frame=-_numWarmupFrames; frame<numFrames; ++frame)
+    {
+        @autoreleasepool
+        {
+            double startTime = CACurrentMediaTime();
+
+            if (scenario.frameBlock) scenario.frameBlock(self, root, frame + _numWarmupFrames);
+            [_controller advanceTime:_timestep];
+            [self renderStage:stage];
+
+            double frameTime = CACurrentMediaTime() - startTime;
+
+            // wait for the GPU, so that it does not leak into the CPU time of the next frame
+            glFinish();
+
+            if (frame >= 0)
+            {
+                frameTimes[frame] = frameTime;
+                totalDrawCalls += _support.numDrawCalls;
+                totalQuads += _support.numQuads;
+                totalBytesUploaded += _support.numBytesUploaded;
+            }
+        }
+    }
+
+    [root removeFromParent];
+    [_controller.juggler removeAllObjects];
+
+    double sum = 0.0;
+    for (NSInteger i=0; i<numFrames; ++i) sum += frameTimes[i];
+
+    qsort_b(frameTimes, numFrames, sizeof(double), ^int(const void *a, const void *b)
+    {
+        double diff = *(const double *)a - *(const double *)b;
+        return diff < 0 ? -1 : diff > 0 ? 1 : 0;
+    });
+
+    NSDictionary *frameTime = @{
+        @"mean":   @(sum / numFrames * 1000.0),
+        @"median": @(frameTimes[numFrames / 2] * 1000.0),
+        @"p95":    @(frameTimes[MIN(numFrames - 1, (NSInteger)(numFrames * 0.95))] * 1000.0),
+        @"min":    @(frameTimes[0] * 1000.0),
+        @"max":    @(frameTimes[numFrames - 1] * 1000.0)
+    };
+
+    free(frameTimes);
+
+    return @{
+        @"name":                scenario.name,
+        @"frameTimeMs":         frameTime,
+        @"drawCalls":           @(totalDrawCalls / numFrames),
+        @"quads":               @(totalQuads / numFrames),
+        @"bytesUploaded":       @(totalBytesUploaded / numFrames),
+        @"totalBytesUploaded":  @(totalBytesUploaded)
+    };
+}
+
+- (void)renderStage:(SPStage *)stage
+{
+    [_support nextFrame];
+    [_support setStencilReferenceValue:0];
+    [_support setRenderTarget:_renderTarget];
+    [_support setupOrthographicProjectionWithLeft:0 right:_stageWidth top:_stageHeight bottom:0];
+    [_support clearWithColor:stage.color alpha:1.0f];
+    [stage render:_support];
+    [_support finishQuadBatch];
+    [_support setRenderTarget:nil];
+    [_context evictIdleRenderTargets];
+}
+
+#pragma mark Properties
+
+- (SPJuggler *)juggler
+{
+    return _controller.juggler;
+}
+
+- (SP_GENERIC(NSArray, SPBenchmarkScenario*) *)scenarios
+{
+    return [_scenarios copy];
+}
+
+@end
@@ -0,0 +1,66 @@
+//
+//  SPBenchmarks.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+//  Runs the benchmark suite headlessly, e.g. with:
+//
+//    SP_BENCHMARK_OUTPUT=/tmp/sparrow.json xcodebuild test -project Sparrow.xcodeproj \
+//        -scheme Benchmarks -destination 'platform=iOS Simulator,name=iPhone 6'
+//
+//  Optional environment variables: SP_BENCHMARK_SEED, SP_BENCHMARK_FRAMES.
+//  The micro benchmarks write their results to SP_MICROBENCHMARK_OUTPUT.
+//
+
+#import <XCTest/XCTest.h>
+#import "SPBenchmarkSuite.h"
+#import "SPMicroBenchmarks.h"
+
+@interface SPBenchmarks : XCTestCase
+
+@end
+
+@implementation SPBenchmarks
+
+- (void)testDefaultScenarios
+{
+    NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+    NSString *outputPath = environment[@"SP_BENCHMARK_OUTPUT"] ?:
+        [NSTemporaryDirectory() stringByAppendingPathComponent:@"sparrow_benchmark.json"];
+    
+    uint seed = (uint)[environment[@"SP_BENCHMARK_SEED"] integerValue];
+    SPBenchmarkSuite *suite = [[SPBenchmarkSuite alloc] initWithSeed:seed];
+    
+    if (environment[@"SP_BENCHMARK_FRAMES"])
+        suite.numFrames = [environment[@"SP_BENCHMARK_FRAMES"] integerValue];
+    
+    [suite addDefaultScenarios];
+    
+    XCTAssertTrue([suite writeResultsToFile:outputPath], @"could not write benchmark results");
+    NSLog(@"Benchmark results written to %@", outputPath);
+}
+
+- (void)testMicroBenchmarks
+{
+    NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+    NSString *outputPath = environment[@"SP_MICROBENCHMARK_OUTPUT"] ?:
+        [NSTemporaryDirectory() stringByAppendingPathComponent:@"sparrow_microbenchmark.json"];
+    
+    // the bitmap font benchmark creates a texture
+    SPContext *context = [[SPContext alloc] init];
+    [SPContext setCurrentContext:context];
+    
+    NSMutableArray *benchmarks = [NSMutableArray arrayWithArray:[SPMicroBenchmarks coreBenchmarks]];
+    [benchmarks addObjectsFromArray:[SPMicroBenchmarks engineBenchmarks]];
+    
+    XCTAssertTrue([SPMicroBenchmarks runBenchmarks:benchmarks writeResultsToFile:outputPath],
+                  @"could not write micro benchmark results");
+    NSLog(@"Micro benchmark results written to %@", outputPath);
+}
+
+@end
@@ -13,6 +13,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPColorMatrix;
+@class SPDistanceFieldStyle;
 @class SPMatrix;
 @class SPMatrix3D;
 @class SPTexture;
@@ -36,7 +38,16 @@ NS_ASSUME_NONNULL_BEGIN
 
 /// Activates the optimal shader program for the current settings; alpha and matrix uniforms are
 /// passed to the program right away, and the texture (if available) is bound.
-- (void)prepareToDraw;
+///
+/// When programs are compiled asynchronously, the optimal program might not be ready yet. The
+/// effect then uses an equivalent tinted variant if that one is ready; otherwise, nothing is
+/// activated, and the method returns `NO` -- skip the draw call in that case.
+- (BOOL)prepareToDraw;
+
+/// Creates the shader programs for all possible settings, so that `prepareToDraw` never has to
+/// compile one. Called by `[SPViewController warmUpPrograms]`. The programs are compiled
+/// asynchronously if the view controller is configured that way.
++ (void)warmUpPrograms;
 
 /// ----------------
 /// @name Properties
@@ -64,6 +75,16 @@ NS_ASSUME_NONNULL_BEGIN
 /// The alpha value with which every vertex color will be multiplied. (Default: 1)
 @property (nonatomic, assign) float alpha;
 
+/// A color matrix that is applied to the final color of each fragment, or `nil` if there is none.
+/// That's the same transformation an `SPColorMatrixFilter` applies, but without the detour
+/// through a render texture. (Default: `nil`)
+@property (nonatomic, copy, nullable) SPColorMatrix *colorMatrix;
+
+/// The style with which the texture is rendered if it contains a distance field, or `nil` for
+/// regular textures. The vertex colors fill the shapes; outline and shadow are drawn in the same
+/// pass. Requires a texture. (Default: `nil`)
+@property (nonatomic, copy, nullable) SPDistanceFieldStyle *distanceFieldStyle;
+
 /// The index of the vertex attribute storing the position vector.
 @property (nonatomic, readonly) int attribPosition;
 
@@ -11,6 +11,9 @@
 
 #import "SparrowClass.h"
 #import "SPBaseEffect.h"
+#import "SPColorMatrix.h"
+#import "SPDistanceFieldStyle.h"
+#import "SPGLTexture.h"
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPNSExtensions.h"
@@ -32,22 +35,67 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
     }
 }
 
+static NSString *getColorMatrixProgramName(BOOL hasTexture, BOOL useTinting, BOOL pma)
+{
+    // the color matrix works on non-premultiplied colors, so PMA needs its own variant
+    return [getProgramName(hasTexture, useTinting) stringByAppendingString:pma ? @"#CM1" : @"#CM0"];
+}
+
+static NSString *getDistanceFieldProgramName(uint distanceField, BOOL hasColorMatrix, BOOL pma)
+{
+    // distance fields are always textured and tinted
+    NSString *programName = hasColorMatrix ? getColorMatrixProgramName(YES, YES, pma) : getProgramName(YES, YES);
+    return [programName stringByAppendingFormat:@"#DF%d%d", distanceField, pma];
+}
+
+// the features of a distance field style that need a program of their own
+#define DISTANCE_FIELD                 1
+#define DISTANCE_FIELD_MULTI_CHANNEL   2
+#define DISTANCE_FIELD_STYLED          4 // outline and/or shadow
+
+static uint getDistanceFieldFeatures(SPDistanceFieldStyle *style)
+{
+    if (!style) return 0;
+
+    uint features = DISTANCE_FIELD;
+    if (style.multiChannel) features |= DISTANCE_FIELD_MULTI_CHANNEL;
+    if (style.outlineWidth > 0.0f || style.shadowAlpha > 0.0f) features |= DISTANCE_FIELD_STYLED;
+    return features;
+}
+
+static void getPremultipliedColor(uint color, float alpha, float *rgba)
+{
+    rgba[0] = SPColorGetRed(color)   / 255.0f * alpha;
+    rgba[1] = SPColorGetGreen(color) / 255.0f * alpha;
+    rgba[2] = SPColorGetBlue(color)  / 255.0f * alpha;
+    rgba[3] = alpha;
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPBaseEffect
 {
     SPMatrix3D *_mvpMatrix3D;
     SPTexture *_texture;
+    SPColorMatrix *_colorMatrix;
+    SPDistanceFieldStyle *_distanceFieldStyle;
     float _alpha;
     BOOL _useTinting;
     BOOL _premultipliedAlpha;
     
     SPProgram *_program;
+    SPProgram *_activeProgram;
     int _aPosition;
     int _aColor;
     int _aTexCoords;
     int _uMvpMatrix;
     int _uAlpha;
+    int _uColorMatrix;
+    int _uColorOffset;
+    int _uDistanceField;
+    int _uOutlineColor;
+    int _uShadowColor;
+    int _uShadowOffset;
 }
 
 @synthesize attribPosition = _aPosition;
@@ -72,46 +120,100 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
 {
     [_mvpMatrix3D release];
     [_texture release];
+    [_colorMatrix release];
+    [_distanceFieldStyle release];
     [_program release];
+    [_activeProgram release];
     [super dealloc];
 }
 
 #pragma mark Methods
 
-- (void)prepareToDraw
+- (BOOL)prepareToDraw
 {
+    BOOL hasTexture = _texture != nil;
+    BOOL hasColorMatrix = _colorMatrix != nil;
+    uint distanceField = hasTexture ? getDistanceFieldFeatures(_distanceFieldStyle) : 0;
+    BOOL useTinting = _useTinting || !_texture || _alpha != 1.0f || distanceField;
+    
+    if (!_program)
+        _program = [[SPBaseEffect programWithTexture:hasTexture useTinting:useTinting
+                                         colorMatrix:hasColorMatrix distanceField:distanceField
+                                  premultipliedAlpha:_premultipliedAlpha] retain];
+    
+    SPProgram *program = _program;
+    
+    if (!program.isReady && !useTinting)
+    {
+        // with white vertex colors and an alpha of one, tinting doesn't change the output
+        useTinting = YES;
+        program = [SPBaseEffect programWithTexture:hasTexture useTinting:YES colorMatrix:hasColorMatrix
+                                     distanceField:0 premultipliedAlpha:_premultipliedAlpha];
+    }
+    
+    if (!program.isReady)
+        return NO;
+    
+    if (program != _activeProgram)
+    {
+        SP_RELEASE_AND_RETAIN(_activeProgram, program);
+        
+        _aPosition  = [program attributeByName:@"aPosition"];
+        _aColor     = [program attributeByName:@"aColor"];
+        _aTexCoords = [program attributeByName:@"aTexCoords"];
+        _uMvpMatrix = [program uniformByName:@"uMvpMatrix"];
+        _uAlpha     = [program uniformByName:@"uAlpha"];
+        _uColorMatrix = [program uniformByName:@"uColorMatrix"];
+        _uColorOffset = [program uniformByName:@"uColorOffset"];
+        _uDistanceField = [program uniformByName:@"uDistanceField"];
+        _uOutlineColor = [program uniformByName:@"uOutlineColor"];
+        _uShadowColor = [program uniformByName:@"uShadowColor"];
+        _uShadowOffset = [program uniformByName:@"uShadowOffset"];
+    }
+    
     SPExecuteWithDebugMarker("BaseEffect")
     {
-        BOOL hasTexture = _texture != nil;
-        BOOL useTinting = _useTinting || !_texture || _alpha != 1.0f;
+        glUseProgram(program.name);
+        [program setMatrix4:_mvpMatrix3D.rawData forUniform:_uMvpMatrix];
         
-        if (!_program)
+        if (useTinting)
         {
-            NSString *programName = getProgramName(hasTexture, useTinting);
-            _program = [[Sparrow.currentController programByName:programName] retain];
+            float alpha[4] = { 1.0f, 1.0f, 1.0f, _alpha };
+            if (_premultipliedAlpha) alpha[0] = alpha[1] = alpha[2] = _alpha;
             
-            if (!_program)
-            {
-                NSString *vertexShader   = [self vertexShaderForTexture:_texture   useTinting:useTinting];
-                NSString *fragmentShader = [self fragmentShaderForTexture:_texture useTinting:useTinting];
-                _program = [[SPProgram alloc] initWithVertexShader:vertexShader fragmentShader:fragmentShader];
-                [Sparrow.currentController registerProgram:_program name:programName];
-            }
-            
-            _aPosition  = [_program attributeByName:@"aPosition"];
-            _aColor     = [_program attributeByName:@"aColor"];
-            _aTexCoords = [_program attributeByName:@"aTexCoords"];
-            _uMvpMatrix = [_program uniformByName:@"uMvpMatrix"];
-            _uAlpha     = [_program uniformByName:@"uAlpha"];
+            [program setVector4:alpha forUniform:_uAlpha];
         }
         
-        glUseProgram(_program.name);
-        glUniformMatrix4fv(_uMvpMatrix, 1, NO, _mvpMatrix3D.rawData);
+        if (hasColorMatrix)
+        {
+            GLKMatrix4 shaderMatrix;
+            GLKVector4 shaderOffset;
+            
+            [_colorMatrix getShaderMatrix:&shaderMatrix offset:&shaderOffset];
+            [program setMatrix4:shaderMatrix.m forUniform:_uColorMatrix];
+            [program setVector4:shaderOffset.v forUniform:_uColorOffset];
+        }
         
-        if (useTinting)
+        if (distanceField)
         {
-            if (_premultipliedAlpha) glUniform4f(_uAlpha, _alpha, _alpha, _alpha, _alpha);
-            else                     glUniform4f(_uAlpha, 1.0f, 1.0f, 1.0f, _alpha);
+            SPDistanceFieldStyle *style = _distanceFieldStyle;
+            float settings[4] = { style.threshold, 0.5f * style.softness, style.outlineWidth, 0.0f };
+            [program setVector4:settings forUniform:_uDistanceField];
+            
+            if (distanceField & DISTANCE_FIELD_STYLED)
+            {
+                // the shadow is offset in texture coordinates of the root texture
+                SPGLTexture *root = _texture.root;
+                float shadowOffset[2] = { style.shadowOffsetX / root.width, style.shadowOffsetY / root.height };
+                float outlineColor[4], shadowColor[4];
+                
+                getPremultipliedColor(style.outlineColor, _alpha, outlineColor);
+                getPremultipliedColor(style.shadowColor, _alpha * style.shadowAlpha, shadowColor);
+                
+                [program setVector4:outlineColor forUniform:_uOutlineColor];
+                [program setVector4:shadowColor forUniform:_uShadowColor];
+                [program setVector2:shadowOffset forUniform:_uShadowOffset];
+            }
         }
         
         if (hasTexture)
@@ -120,6 +222,28 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
             glBindTexture(GL_TEXTURE_2D, _texture.name);
         }
     }
+    
+    return YES;
+}
+
++ (void)warmUpPrograms
+{
+    for (int colorMatrix=0; colorMatrix<2; ++colorMatrix)
+    {
+        for (int pma=0; pma<=colorMatrix; ++pma) // PMA only makes a difference with a color matrix
+        {
+            // without a texture, tinting is always used
+            [self programWithTexture:NO  useTinting:YES colorMatrix:colorMatrix distanceField:0 premultipliedAlpha:pma];
+            [self programWithTexture:YES useTinting:YES colorMatrix:colorMatrix distanceField:0 premultipliedAlpha:pma];
+            [self programWithTexture:YES useTinting:NO  colorMatrix:colorMatrix distanceField:0 premultipliedAlpha:pma];
+        }
+        
+        // distance fields always depend on PMA
+        for (int pma=0; pma<2; ++pma)
+            for (uint features=0; features<4; ++features)
+                [self programWithTexture:YES useTinting:YES colorMatrix:colorMatrix
+                           distanceField:DISTANCE_FIELD | (features << 1) premultipliedAlpha:pma];
+    }
 }
 
 #pragma mark Properties
@@ -156,6 +280,39 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
     }
 }
 
+- (void)setPremultipliedAlpha:(BOOL)value
+{
+    if (value != _premultipliedAlpha && (_colorMatrix || _distanceFieldStyle))
+        SP_RELEASE_AND_NIL(_program);
+    
+    _premultipliedAlpha = value;
+}
+
+- (void)setColorMatrix:(SPColorMatrix *)value
+{
+    if ((_colorMatrix && !value) || (!_colorMatrix && value))
+        SP_RELEASE_AND_NIL(_program);
+    
+    // this is called for each draw call, so we avoid creating a new matrix each time
+    if (!value)
+        SP_RELEASE_AND_NIL(_colorMatrix);
+    else if (!_colorMatrix)
+        _colorMatrix = [value copy];
+    else
+        memcpy(_colorMatrix.values, value.values, sizeof(float) * value.numValues);
+}
+
+- (void)setDistanceFieldStyle:(SPDistanceFieldStyle *)value
+{
+    // this is called for each draw call, so the style is only copied when it changes
+    if ([value isEqualToStyle:_distanceFieldStyle] || (!value && !_distanceFieldStyle)) return;
+    
+    if (getDistanceFieldFeatures(value) != getDistanceFieldFeatures(_distanceFieldStyle))
+        SP_RELEASE_AND_NIL(_program);
+    
+    SP_RELEASE_AND_COPY(_distanceFieldStyle, value);
+}
+
 - (void)setTexture:(SPTexture *)value
 {
     if ((_texture && !value) || (!_texture && value))
@@ -166,11 +323,40 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
 
 #pragma mark Private
 
-- (NSString *)vertexShaderForTexture:(SPTexture *)texture useTinting:(BOOL)useTinting
++ (SPProgram *)programWithTexture:(BOOL)hasTexture useTinting:(BOOL)useTinting
+                      colorMatrix:(BOOL)hasColorMatrix distanceField:(uint)distanceField
+               premultipliedAlpha:(BOOL)pma
+{
+    NSString *programName = distanceField ?
+        getDistanceFieldProgramName(distanceField, hasColorMatrix, pma) : hasColorMatrix ?
+        getColorMatrixProgramName(hasTexture, useTinting, pma) :
+        getProgramName(hasTexture, useTinting);
+    SPViewController *controller = Sparrow.currentController;
+    SPProgram *program = [controller programByName:programName];
+    
+    if (!program)
+    {
+        NSString *vertexShader   = [self vertexShaderWithTexture:hasTexture useTinting:useTinting
+                                                   distanceField:distanceField];
+        NSString *fragmentShader = [self fragmentShaderWithTexture:hasTexture useTinting:useTinting
+                                                       colorMatrix:hasColorMatrix distanceField:distanceField
+                                                premultipliedAlpha:pma];
+        program = [[[SPProgram alloc] initWithVertexShader:vertexShader fragmentShader:fragmentShader
+                                              asynchronous:controller.compilesProgramsAsynchronously] autorelease];
+        [controller registerProgram:program name:programName];
+    }
+    
+    return program;
+}
+
++ (NSString *)vertexShaderWithTexture:(BOOL)hasTexture useTinting:(BOOL)useTinting
+                        distanceField:(uint)distanceField
 {
-    BOOL hasTexture = texture != nil;
     NSMutableString *source = [NSMutableString string];
     
+    // distance fields are sampled at offsets, which needs more precision
+    NSString *texCoordsPrecision = distanceField ? @"mediump" : @"lowp";
+    
     // variables
     
     [source appendLine:@"attribute vec4 aPosition;"];
@@ -181,7 +367,7 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
     if (useTinting) [source appendLine:@"uniform vec4 uAlpha;"];
     
     if (useTinting) [source appendLine:@"varying lowp vec4 vColor;"];
-    if (hasTexture) [source appendLine:@"varying lowp vec2 vTexCoords;"];
+    if (hasTexture) [source appendFormat:@"varying %@ vec2 vTexCoords;\n", texCoordsPrecision];
     
     // main
     
@@ -196,11 +382,16 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
     return source;
 }
 
-- (NSString *)fragmentShaderForTexture:(SPTexture *)texture useTinting:(BOOL)useTinting
++ (NSString *)fragmentShaderWithTexture:(BOOL)hasTexture useTinting:(BOOL)useTinting
+                            colorMatrix:(BOOL)hasColorMatrix distanceField:(uint)distanceField
+                     premultipliedAlpha:(BOOL)pma
 {
-    BOOL hasTexture = texture != nil;
+    NSString *output = hasColorMatrix ? @"color" : @"gl_FragColor";
     NSMutableString *source = [NSMutableString string];
     
+    if (distanceField)
+        [source appendLine:@"#extension GL_OES_standard_derivatives : enable"];
+    
     // variables
     
     if (useTinting)
@@ -208,23 +399,102 @@ static NSString *getProgramName(BOOL hasTexture, BOOL useTinting)
     
     if (hasTexture)
     {
-        [source appendLine:@"varying lowp vec2 vTexCoords;"];
+        [source appendFormat:@"varying %@ vec2 vTexCoords;\n", distanceField ? @"mediump" : @"lowp"];
         [source appendLine:@"uniform lowp sampler2D uTexture;"];
     }
     
+    if (distanceField)
+    {
+        [source appendLine:@"uniform mediump vec4 uDistanceField;"]; // threshold, softness, outline
+        
+        if (distanceField & DISTANCE_FIELD_STYLED)
+        {
+            [source appendLine:@"uniform lowp vec4 uOutlineColor;"];
+            [source appendLine:@"uniform lowp vec4 uShadowColor;"];
+            [source appendLine:@"uniform mediump vec2 uShadowOffset;"];
+        }
+        
+        // single-channel fields store the distance in alpha, multi-channel ones use the
+        // median of red, green and blue.
+        
+        [source appendLine:@"mediump float getDistance(mediump vec2 texCoords) {"];
+        [source appendLine:@"  lowp vec4 texel = texture2D(uTexture, texCoords);"];
+        
+        if (distanceField & DISTANCE_FIELD_MULTI_CHANNEL)
+            [source appendLine:@"  return max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b));"];
+        else
+            [source appendLine:@"  return texel.a;"];
+        
+        [source appendLine:@"}"];
+    }
+    
+    if (hasColorMatrix)
+    {
+        [source appendLine:@"uniform lowp mat4 uColorMatrix;"];
+        [source appendLine:@"uniform lowp vec4 uColorOffset;"];
+        [source appendLine:@"const lowp vec4 MIN_COLOR = vec4(0, 0, 0, 0.0001);"];
+    }
+    
     // main
     
     [source appendLine:@"void main() {"];
     
-    if (hasTexture)
+    if (hasColorMatrix)
+        [source appendLine:@"  lowp vec4 color;"];
+    
+    if (distanceField)
+    {
+        // the shape is composed with premultiplied colors: the fill on top of the outline,
+        // the shadow below both.
+        
+        [source appendLine:@"  mediump float distance = getDistance(vTexCoords);"];
+        [source appendLine:@"  mediump float width = max(fwidth(distance) * uDistanceField.y, 0.001);"];
+        [source appendLine:@"  lowp float inner = smoothstep(uDistanceField.x - width, uDistanceField.x + width, distance);"];
+        
+        if (pma) [source appendLine:@"  lowp vec4 fill = vColor;"];
+        else     [source appendLine:@"  lowp vec4 fill = vec4(vColor.rgb * vColor.a, vColor.a);"];
+        
+        if (distanceField & DISTANCE_FIELD_STYLED)
+        {
+            [source appendLine:@"  mediump float edge = uDistanceField.x - uDistanceField.z;"];
+            [source appendLine:@"  lowp float outer = smoothstep(edge - width, edge + width, distance);"];
+            [source appendLine:@"  lowp vec4 shape = mix(uOutlineColor, fill, inner) * outer;"];
+            [source appendLine:@"  mediump float shadowDistance = getDistance(vTexCoords - uShadowOffset);"];
+            [source appendLine:@"  lowp float shadow = smoothstep(edge - width, edge + width, shadowDistance);"];
+            [source appendLine:@"  shape += uShadowColor * shadow * (1.0 - shape.a);"];
+        }
+        else
+            [source appendLine:@"  lowp vec4 shape = fill * inner;"];
+        
+        if (pma) [source appendFormat:@"  %@ = shape;\n", output];
+        else     [source appendFormat:@"  %@ = vec4(shape.rgb / max(shape.a, 0.0001), shape.a);\n", output];
+    }
+    else if (hasTexture)
     {
         if (useTinting)
-            [source appendLine:@"  gl_FragColor = texture2D(uTexture, vTexCoords) * vColor;"];
+            [source appendFormat:@"  %@ = texture2D(uTexture, vTexCoords) * vColor;\n", output];
         else
-            [source appendLine:@"  gl_FragColor = texture2D(uTexture, vTexCoords);"];
+            [source appendFormat:@"  %@ = texture2D(uTexture, vTexCoords);\n", output];
     }
     else
-        [source appendLine:@"  gl_FragColor = vColor;"];
+        [source appendFormat:@"  %@ = vColor;\n", output];
+    
+    if (hasColorMatrix)
+    {
+        if (pma)
+        {
+            [source appendLine:@"  color = max(color, MIN_COLOR);"];    // avoid division through zero
+            [source appendLine:@"  color.xyz /= color.www;"];           // restore non-PMA RGB values
+        }
+        
+        [source appendLine:@"  color *= uColorMatrix;"];                // multiply with 4x4 matrix
+        [source appendLine:@"  color += uColorOffset;"];                // add offset
+        
+        if (pma)
+            [source appendLine:@"  color.xyz *= color.www;"];          // multiply with alpha again
+        
+        [source appendLine:@"  gl_FragColor = color;"];
+    }
     
     [source appendString:@"}"];
     
@@ -39,7 +39,9 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Methods
 /// -------------
 
-/// Adds kerning information relative to a specific other character ID.
+/// Adds kerning information relative to a specific other character ID. A bitmap font takes over
+/// this information when the char is added to it; kerning that is added later is forwarded to the
+/// font the char was added to most recently.
 - (void)addKerning:(float)amount toChar:(int)charID;
 
 /// Retrieve kerning information relative to the given character ID.
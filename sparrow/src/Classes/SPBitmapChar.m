@@ -10,6 +10,8 @@
 //
 
 #import "SPBitmapChar.h"
+#import "SPBitmapChar_Internal.h"
+#import "SPBitmapFont.h"
 #import "SPImage.h"
 #import "SPMacros.h"
 #import "SPTexture.h"
@@ -22,6 +24,10 @@
     float _yOffset;
     float _xAdvance;
     NSMutableDictionary *_kernings;
+    GLKVector2 _texCoords[4];
+    BOOL _texCoordsValid;
+    int _page;
+    SPBitmapFont *_font; // not retained
 }
 
 #pragma mark Initialization
@@ -67,6 +73,7 @@
         _kernings = [[NSMutableDictionary alloc] init];    
 
 	_kernings[@(charID)] = @(amount);
+    [_font addKerning:amount betweenChar:charID andChar:_charID];
 }
 
 - (float)kerningToChar:(int)charID
@@ -93,3 +100,48 @@
 }
 
 @end
+
+@implementation SPBitmapChar (Internal)
+
+- (const GLKVector2 *)texCoords
+{
+    if (!_texCoordsValid)
+    {
+        _texCoords[0] = GLKVector2Make(0.0f, 0.0f);
+        _texCoords[1] = GLKVector2Make(1.0f, 0.0f);
+        _texCoords[2] = GLKVector2Make(0.0f, 1.0f);
+        _texCoords[3] = GLKVector2Make(1.0f, 1.0f);
+
+        [_texture adjustTexCoords:_texCoords numVertices:4 stride:0];
+        _texCoordsValid = YES;
+    }
+
+    return _texCoords;
+}
+
+- (NSDictionary *)kernings
+{
+    return _kernings;
+}
+
+- (int)page
+{
+    return _page;
+}
+
+- (void)setPage:(int)page
+{
+    _page = page;
+}
+
+- (SPBitmapFont *)font
+{
+    return _font;
+}
+
+- (void)setFont:(SPBitmapFont *)font
+{
+    _font = font;
+}
+
+@end
@@ -0,0 +1,39 @@
+//
+//  SPBitmapChar_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import "SPBitmapChar.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPBitmapFont;
+
+@interface SPBitmapChar (Internal)
+
+/// The texture coordinates of the char's quad (top left, top right, bottom left, bottom right),
+/// within the root texture. They are calculated once and then cached.
+- (const GLKVector2 *)texCoords;
+
+/// The kerning information of the char, mapping the IDs of preceding chars to amounts.
+- (nullable NSDictionary *)kernings;
+
+/// The index of the font texture (page) that contains the char.
+- (int)page;
+- (void)setPage:(int)page;
+
+/// The font the char was added to most recently (not retained); kerning that is added to the char
+/// is forwarded to it.
+- (nullable SPBitmapFont *)font;
+- (void)setFont:(nullable SPBitmapFont *)font;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -16,6 +16,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class SPBitmapChar;
+@class SPDistanceFieldStyle;
 @class SPQuadBatch;
 @class SPSprite;
 
@@ -25,23 +26,43 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 
  The SPBitmapFont class parses bitmap font files and arranges the glyphs in the form of a text.
  
- The class parses the XML format as it is used in the AngelCode Bitmap Font Generator. This is what
- the file format looks like:
+ The class parses the formats of the AngelCode Bitmap Font Generator: XML and binary. This is what
+ the XML format looks like:
  
 	<font>
 	  <info face="BranchingMouse" size="40" />
 	  <common lineHeight="40" />
-	  <pages>  <!-- currently, only one page is supported -->
+	  <pages>
 	    <page id="0" file="texture.png" />
 	  </pages>
 	  <chars>
-	    <char id="32" x="60" y="29" width="1" height="1" xoffset="0" yoffset="27" xadvance="8" />
-	    <char id="33" x="155" y="144" width="9" height="21" xoffset="0" yoffset="6" xadvance="9" />
+	    <char id="32" x="60" y="29" width="1" height="1" xoffset="0" yoffset="27" xadvance="8" page="0" />
+	    <char id="33" x="155" y="144" width="9" height="21" xoffset="0" yoffset="6" xadvance="9" page="0" />
 	  </chars>
 	  <kernings> <!-- Kerning is optional -->
 	    <kerning first="83" second="83" amount="-4"/>
 	  </kernings>
 	</font>
+
+ The binary format (version 3) contains the same information, but is much faster to load: font
+ files are memory mapped, and the chars are read without any parsing. For fonts with thousands
+ of glyphs (e.g. Chinese or Japanese), choose "Binary" as the font descriptor in the export
+ options of the tool.
+
+ Large fonts may be split up into several pages (textures). Since a quad batch can only reference
+ one texture, a text that uses several pages has to be drawn with `fillQuadBatches:...`, which
+ groups the chars by page. SPTextField does that automatically.
+
+ **Distance field fonts**
+
+ A font whose textures contain signed distance fields (e.g. created with Hiero or msdf-bmfont)
+ stays sharp at any size, so one texture serves all font sizes. Such fonts are recognized by the
+ `distanceField` element that those tools add to the XML format:
+
+	<distanceField fieldType="msdf" distanceRange="4" />
+
+ For binary files, assign a `distanceFieldStyle` manually. The style is passed on to the quad
+ batches the text is arranged in; it can also add an outline and a drop shadow.
   
  _You don't have to use this class directly in most cases. SPTextField contains methods that
  handle bitmap fonts for you._
@@ -54,17 +75,23 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 /// @name Initialization
 /// --------------------
 
-/// Initializes a bitmap font by parsing the XML data and using the specified texture.
+/// Initializes a bitmap font by parsing the XML or binary font data and using the specified
+/// textures, one per page. If `textures` is `nil`, the textures referenced by the data are loaded.
 /// _Designated Initializer_.
+- (instancetype)initWithContentsOfData:(nullable NSData *)data
+                              textures:(nullable SP_GENERIC(NSArray, SPTexture*) *)textures;
+
+/// Initializes a bitmap font with a single page by parsing the font data and using the
+/// specified texture.
 - (instancetype)initWithContentsOfData:(nullable NSData *)data texture:(nullable SPTexture *)texture;
 
-/// Initializes a bitmap font by parsing the XML data and loading the texture that is specified there.
+/// Initializes a bitmap font by parsing the font data and loading the texture that is specified there.
 - (instancetype)initWithContentsOfData:(NSData *)data;
 
-/// Initializes a bitmap font by parsing an XML file and using the specified texture.
+/// Initializes a bitmap font by parsing an XML or binary font file and using the specified texture.
 - (instancetype)initWithContentsOfFile:(NSString *)path texture:(nullable SPTexture *)texture;
 
-/// Initializes a bitmap font by parsing an XML file and loading the texture that is specified there.
+/// Initializes a bitmap font by parsing a font file and loading the texture that is specified there.
 - (instancetype)initWithContentsOfFile:(NSString *)path;
 
 /// Initializes a bitmap font with an integrated, very small font, which is useful for debug output.
@@ -80,26 +107,44 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 /// Adds a bitmap char with a certain character ID.
 - (void)addBitmapChar:(SPBitmapChar *)bitmapChar charID:(int)charID;
 
+/// Adds kerning information: the amount that the second char moves when it follows the first one.
+- (void)addKerning:(float)amount betweenChar:(int)firstID andChar:(int)secondID;
+
+/// Returns the kerning between two chars, or zero if there is none.
+- (float)kerningBetweenChar:(int)firstID andChar:(int)secondID;
+
 /// Returns a vector containing all the character IDs that are contained in this font.
 - (SP_GENERIC(NSArray, NSNumber*) *)allCharIDs;
 
 /// Checks whether a provided string can be displayed with the font.
 - (BOOL)hasCharsInString:(NSString *)string;
 
-/// Creates a sprite that contains the given text by arranging individual chars.
+/// Creates a sprite that contains the given text by arranging individual chars. With a distance
+/// field font, the sprite contains one quad batch per page instead, since only batches can render
+/// the `distanceFieldStyle`.
 - (SPSprite *)createSpriteWithWidth:(float)width height:(float)height
                                text:(NSString *)text fontSize:(float)size color:(uint)color
                              hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
                           autoScale:(BOOL)autoScale kerning:(BOOL)kerning
                             leading:(float)leading;
 
-/// Draws text into a quad batch.
+/// Draws text into a quad batch. Raises an exception if the text uses chars from several pages.
 - (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
                  text:(NSString *)text fontSize:(float)size color:(uint)color
                hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
             autoScale:(BOOL)autoScale kerning:(BOOL)kerning
               leading:(float)leading;
 
+/// Draws text into one quad batch per page that is used by the text. All batches in the array
+/// are reset, then filled in order; if there are not enough of them, new ones are added.
+/// Returns the number of batches that contain text.
+- (NSInteger)fillQuadBatches:(SP_GENERIC(NSMutableArray, SPQuadBatch*) *)quadBatches
+                   withWidth:(float)width height:(float)height
+                        text:(NSString *)text fontSize:(float)size color:(uint)color
+                      hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                   autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+                     leading:(float)leading;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -127,9 +172,17 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 /// Useful to make up for incorrect font data. Default: 0
 @property (nonatomic, assign) float offsetY;
 
-/// The underlying texture that contains all the chars.
+/// The underlying texture that contains the chars; for fonts with several pages, the first one.
 @property (nonatomic, readonly) SPTexture *texture;
 
+/// The textures of all pages of the font.
+@property (nonatomic, readonly) SP_GENERIC(NSArray, SPTexture*) *textures;
+
+/// The style with which the chars are rendered if the textures contain distance fields, or `nil`
+/// for regular fonts. Changes affect texts that are arranged afterwards. Default: nil, or a
+/// style parsed from the font file
+@property (nonatomic, copy, nullable) SPDistanceFieldStyle *distanceFieldStyle;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,11 +11,16 @@
 
 #import "SparrowClass.h"
 #import "SPBitmapFont.h"
+#import "SPBitmapFont_Internal.h"
 #import "SPBitmapChar.h"
+#import "SPBitmapChar_Internal.h"
 #import "SPDisplayObject.h"
+#import "SPDistanceFieldStyle.h"
 #import "SPImage.h"
+#import "SPMatrix.h"
 #import "SPNSExtensions.h"
 #import "SPQuadBatch.h"
+#import "SPQuadBatch_Internal.h"
 #import "SPRectangle.h"
 #import "SPSprite.h"
 #import "SPStage.h"
@@ -31,30 +36,352 @@ NSString *const SPBitmapFontMiniName = @"mini";
 #define CHAR_NEWLINE         10
 #define CHAR_CARRIAGE_RETURN 13
 
-// --- helper class --------------------------------------------------------------------------------
+// chars with IDs in the Basic Multilingual Plane are stored in a table that is indexed directly,
+// as long as it stays reasonably dense; all others are stored in a hash table.
+#define MAX_DENSE_CHAR_ID   0xffff
+#define MIN_DENSE_SIZE         256
+#define MAX_DENSE_WASTE          4
 
-@interface SPCharLocation : SPPoolObject
+// the binary format of AngelCode's Bitmap Font Generator consists of a header ('BMF' + version)
+// and a sequence of blocks, each starting with its type (1 byte) and size (4 bytes).
+#define BINARY_FONT_VERSION         3
+#define BINARY_BLOCK_INFO           1
+#define BINARY_BLOCK_COMMON         2
+#define BINARY_BLOCK_PAGES          3
+#define BINARY_BLOCK_CHARS          4
+#define BINARY_BLOCK_KERNING_PAIRS  5
 
-- (instancetype)initWithChar:(SPBitmapChar *)bitmapChar;
+// --- helper structs ------------------------------------------------------------------------------
 
-@property (nonatomic, assign) SPBitmapChar* bitmapChar;
-@property (nonatomic) float scale;
-@property (nonatomic) float x;
-@property (nonatomic) float y;
+// the blocks of a binary font file; like the devices, the format is little endian.
 
-@end
+typedef struct __attribute__((packed))
+{
+    int16_t fontSize;
+    uint8_t bitField;   // bit 0: smooth, 1: unicode, 2: italic, 3: bold, 4: fixed height
+    uint8_t charSet;
+    uint16_t stretchH;
+    uint8_t aa;
+    uint8_t padding[4];
+    uint8_t spacing[2];
+    uint8_t outline;
+    char fontName[];    // zero-terminated
+} SPBinaryFontInfo;
 
-@implementation SPCharLocation
+typedef struct __attribute__((packed))
+{
+    uint16_t lineHeight;
+    uint16_t base;
+    uint16_t scaleW;
+    uint16_t scaleH;
+    uint16_t pages;
+    uint8_t bitField;
+    uint8_t alphaChannel;
+    uint8_t redChannel;
+    uint8_t greenChannel;
+    uint8_t blueChannel;
+} SPBinaryFontCommon;
 
-- (instancetype)initWithChar:(SPBitmapChar *)bitmapChar
+typedef struct __attribute__((packed))
 {
-    if ((self = [super init]))
-        _bitmapChar = bitmapChar;
-    
-    return self;
+    uint32_t id;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    int16_t xOffset;
+    int16_t yOffset;
+    int16_t xAdvance;
+    uint8_t page;
+    uint8_t channel;
+} SPBinaryFontChar;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t first;
+    uint32_t second;
+    int16_t amount;
+} SPBinaryFontKerningPair;
+
+typedef struct
+{
+    SPBitmapChar *bitmapChar; // not retained
+    int page;
+    float x;
+    float y;
+} SPCharLocation;
+
+typedef struct
+{
+    SPBitmapChar *bitmapChar; // not retained; NULL for missing chars
+    float kerning;            // relative to the previous char that's not missing
+    float xOffset;
+    float yOffset;
+    float xAdvance;
+    float width;
+    int page;
+} SPCharMetrics;
+
+typedef enum
+{
+    SPWordTypeWord,
+    SPWordTypeWhiteSpace,
+    SPWordTypeLineBreak
+} SPWordType;
+
+typedef struct
+{
+    SPWordType type;
+    NSInteger firstChar;
+    NSInteger numChars;
+    float kerning;            // of the first visible char, relative to the previous one
+    float extent;             // right edge of the rightmost glyph, relative to the start
+    float xAdvance;           // without the kerning of the first visible char
+} SPWordMetrics;
+
+typedef struct
+{
+    uint64_t key;
+    BOOL used; // any key is valid, so free entries need a flag of their own
+    union
+    {
+        SPBitmapChar *bitmapChar;
+        float kerning;
+    };
+} SPHashEntry;
+
+typedef struct
+{
+    SPHashEntry *entries;
+    NSInteger capacity; // zero or a power of two
+    NSInteger count;
+} SPHashTable;
+
+typedef struct
+{
+    SPBitmapChar **dense; // indexed by 'charID - denseMin'
+    int denseMin;
+    int denseSize;
+    NSInteger numDense;
+    SPHashTable sparse;
+} SPCharTable;
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static inline NSInteger hashIndex(uint64_t key, NSInteger capacity)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (NSInteger)(key & (capacity - 1));
 }
 
-@end
+static inline SPHashEntry *hashTableFind(SPHashTable *table, uint64_t key)
+{
+    if (!table->count) return NULL;
+
+    NSInteger mask = table->capacity - 1;
+
+    for (NSInteger i = hashIndex(key, table->capacity); ; i = (i + 1) & mask)
+    {
+        SPHashEntry *entry = &table->entries[i];
+        if (!entry->used) return NULL;
+        else if (entry->key == key) return entry;
+    }
+}
+
+static SPHashEntry *hashTableInsert(SPHashTable *table, uint64_t key)
+{
+    // open addressing with linear probing; the table grows before it's half full.
+
+    if ((table->count + 1) * 2 > table->capacity)
+    {
+        SPHashTable oldTable = *table;
+
+        table->capacity = MAX(16, oldTable.capacity * 2);
+        table->entries = calloc(table->capacity, sizeof(SPHashEntry));
+        table->count = 0;
+
+        for (NSInteger i=0; i<oldTable.capacity; ++i)
+            if (oldTable.entries[i].used)
+                *hashTableInsert(table, oldTable.entries[i].key) = oldTable.entries[i];
+
+        free(oldTable.entries);
+    }
+
+    NSInteger mask = table->capacity - 1;
+
+    for (NSInteger i = hashIndex(key, table->capacity); ; i = (i + 1) & mask)
+    {
+        SPHashEntry *entry = &table->entries[i];
+
+        if (!entry->used)
+        {
+            entry->key = key;
+            entry->used = YES;
+            entry->bitmapChar = nil;
+            table->count++;
+            return entry;
+        }
+        else if (entry->key == key) return entry;
+    }
+}
+
+static inline uint64_t kerningKey(int firstID, int secondID)
+{
+    return ((uint64_t)(uint32_t)firstID << 32) | (uint32_t)secondID;
+}
+
+static inline float getKerning(SPHashTable *kernings, int firstID, int secondID)
+{
+    SPHashEntry *entry = hashTableFind(kernings, kerningKey(firstID, secondID));
+    return entry ? entry->kerning : 0.0f;
+}
+
+static inline SPBitmapChar *charTableGet(SPCharTable *table, int charID)
+{
+    uint index = (uint)(charID - table->denseMin);
+    if (index < (uint)table->denseSize) return table->dense[index];
+
+    SPHashEntry *entry = hashTableFind(&table->sparse, (uint32_t)charID);
+    return entry ? entry->bitmapChar : nil;
+}
+
+static void charTableResize(SPCharTable *table, int newMin, int newSize)
+{
+    SPBitmapChar **dense = calloc(newSize, sizeof(SPBitmapChar *));
+
+    if (table->denseSize)
+        memcpy(dense + (table->denseMin - newMin), table->dense, sizeof(SPBitmapChar *) * table->denseSize);
+
+    free(table->dense);
+    table->dense = dense;
+    table->denseMin = newMin;
+    table->denseSize = newSize;
+
+    // sparse chars that are now within the range of the dense table move over
+    SPHashTable sparse = table->sparse;
+    table->sparse = (SPHashTable){ NULL, 0, 0 };
+
+    for (NSInteger i=0; i<sparse.capacity; ++i)
+    {
+        SPHashEntry entry = sparse.entries[i];
+        if (!entry.used) continue;
+
+        uint index = (uint)((int)entry.key - newMin);
+        if (index < (uint)newSize)
+        {
+            dense[index] = entry.bitmapChar;
+            table->numDense++;
+        }
+        else *hashTableInsert(&table->sparse, entry.key) = entry;
+    }
+
+    free(sparse.entries);
+}
+
+static SPBitmapChar **charTableSlot(SPCharTable *table, int charID)
+{
+    // returns the place where the char with that ID is stored; the caller must fill it.
+
+    uint index = (uint)(charID - table->denseMin);
+
+    if (index >= (uint)table->denseSize && charID >= 0 && charID <= MAX_DENSE_CHAR_ID)
+    {
+        int denseMax = table->denseMin + table->denseSize - 1;
+        int newMin  = table->denseSize ? MIN(table->denseMin, charID) : charID;
+        int newMax  = table->denseSize ? MAX(denseMax, charID) : charID;
+        int newSize = newMax - newMin + 1;
+        NSInteger numChars = table->numDense + table->sparse.count + 1;
+
+        if (newSize <= MAX(MIN_DENSE_SIZE, MAX_DENSE_WASTE * numChars))
+        {
+            charTableResize(table, newMin, newSize);
+            index = (uint)(charID - table->denseMin);
+        }
+    }
+
+    if (index < (uint)table->denseSize)
+    {
+        SPBitmapChar **slot = &table->dense[index];
+        if (!*slot) table->numDense++;
+        return slot;
+    }
+    else return &hashTableInsert(&table->sparse, (uint32_t)charID)->bitmapChar;
+}
+
+static void charTableEnumerate(SPCharTable *table, void (^block)(int charID, SPBitmapChar *bitmapChar))
+{
+    for (int i=0; i<table->denseSize; ++i)
+        if (table->dense[i]) block(table->denseMin + i, table->dense[i]);
+
+    for (NSInteger i=0; i<table->sparse.capacity; ++i)
+    {
+        SPHashEntry *entry = &table->sparse.entries[i];
+        if (entry->used) block((int)entry->key, entry->bitmapChar);
+    }
+}
+
+static void charTableClear(SPCharTable *table, SPBitmapFont *font)
+{
+    charTableEnumerate(table, ^(int charID, SPBitmapChar *bitmapChar)
+    {
+        if (bitmapChar.font == font) [bitmapChar setFont:nil];
+        [bitmapChar release];
+    });
+
+    free(table->dense);
+    free(table->sparse.entries);
+    memset(table, 0, sizeof(SPCharTable));
+}
+
+static inline BOOL startNewLine(float *currentX, float *currentY, float lineHeight, float leading,
+                                float containerHeight)
+{
+    if (*currentY + leading + (2 * lineHeight) > containerHeight) return NO;
+
+    *currentX = 0.0f;
+    *currentY += lineHeight + leading;
+    return YES;
+}
+
+static BOOL isBinaryFontData(NSData *data)
+{
+    return data.length >= 4 && memcmp(data.bytes, "BMF", 3) == 0;
+}
+
+static void enumerateBinaryFontBlocks(NSData *data, void (^block)(uint8_t type, const void *bytes, uint32_t size))
+{
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+
+    if (bytes[3] != BINARY_FONT_VERSION)
+        [NSException raise:SPExceptionDataInvalid format:@"Unsupported binary font version: %d", bytes[3]];
+
+    for (NSUInteger offset = 4; offset < length; )
+    {
+        uint8_t type = bytes[offset];
+        uint32_t size = 0;
+
+        if (length - offset < 5)
+            [NSException raise:SPExceptionDataInvalid format:@"Binary font data is truncated"];
+
+        memcpy(&size, bytes + offset + 1, sizeof(uint32_t));
+        offset += 5;
+
+        if (size > length - offset)
+            [NSException raise:SPExceptionDataInvalid format:@"Binary font data is truncated"];
+
+        block(type, bytes + offset, size);
+        offset += size;
+    }
+}
+
+static NSString *stringFromBinaryFontData(const char *bytes, NSUInteger maxLength)
+{
+    NSUInteger length = strnlen(bytes, maxLength);
+    return [[[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] autorelease];
+}
 
 // --- class implementation ------------------------------------------------------------------------
 
@@ -62,18 +389,30 @@ NSString *const SPBitmapFontMiniName = @"mini";
 {
     NSString *_name;
     SPTexture *_texture;
-    SP_GENERIC(NSMutableDictionary, NSNumber*, SPBitmapChar*) *_chars;
+    SP_GENERIC(NSArray, SPTexture*) *_textures;
+    SPCharTable _chars;
+    SPHashTable _kernings;
     float _size;
     float _lineHeight;
     float _baseline;
     float _offsetX;
     float _offsetY;
-    SPImage *_helperImage;
+    SPDistanceFieldStyle *_distanceFieldStyle;
+
+    // layout buffers, reused by all texts of the font. Text fields may arrange their text in a
+    // background queue, so all methods that use them are synchronized.
+    SPCharLocation *_charLocations;
+    SPCharMetrics *_charMetrics;
+    SPWordMetrics *_wordMetrics;
+    NSInteger *_lineEnds;
+    NSInteger *_lineStarts;
+    int *_charIDs;
+    NSInteger _layoutCapacity;
 }
 
 #pragma mark Initialization
 
-- (instancetype)initWithContentsOfData:(NSData *)data texture:(SPTexture *)texture
+- (instancetype)initWithContentsOfData:(NSData *)data textures:(NSArray *)textures
 {
     if ((self = [super init]))
     {
@@ -81,15 +420,14 @@ NSString *const SPBitmapFontMiniName = @"mini";
         if (!data)
         {
             NSData *imgData =  [NSData dataWithBase64EncodedString:MiniFontImgDataBase64];
-            texture = [[[SPTexture alloc] initWithContentsOfImage:[UIImage imageWithData:imgData]] autorelease];
+            textures = @[[[[SPTexture alloc] initWithContentsOfImage:[UIImage imageWithData:imgData]] autorelease]];
             data = [[NSData dataWithBase64EncodedString:MiniFontXmlDataBase64] gzipInflate];
         }
         
         _name = @"unknown";
         _lineHeight = _size = _baseline = SPDefaultFontSize;
-        _chars = [[NSMutableDictionary alloc] init];
-        _texture = texture ? [texture retain] : [self textureReferencedByXmlData:data];
-        _helperImage = [[SPImage alloc] initWithTexture:_texture];
+        _textures = [(textures.count ? textures : [self texturesReferencedByFontData:data]) copy];
+        _texture = [_textures[0] retain];
         
         [self parseFontData:data];
     }
@@ -97,24 +435,31 @@ NSString *const SPBitmapFontMiniName = @"mini";
     return self;
 }
 
+- (instancetype)initWithContentsOfData:(NSData *)data texture:(SPTexture *)texture
+{
+    return [self initWithContentsOfData:data textures:texture ? @[texture] : nil];
+}
+
 - (instancetype)initWithContentsOfData:(NSData *)data
 {
-    return [self initWithContentsOfData:data texture:nil];
+    return [self initWithContentsOfData:data textures:nil];
 }
 
 - (instancetype)initWithContentsOfFile:(NSString *)path texture:(SPTexture *)texture
 {
     NSString *absolutePath = [SPUtils absolutePathToFile:path];
     if (!absolutePath) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", path];
-    NSData *xmlData = [NSData dataWithContentsOfFile:absolutePath];
+    NSData *fontData = [NSData dataWithContentsOfFile:absolutePath options:NSDataReadingMappedIfSafe
+                                                error:nil];
+    NSArray *textures = texture ? @[texture] : nil;
 
-    if (!texture)
+    if (!textures)
     {
         NSString *folder = [absolutePath stringByDeletingLastPathComponent];
-        texture = [self textureReferencedByXmlData:xmlData inFolder:folder];
+        textures = [self texturesReferencedByFontData:fontData inFolder:folder];
     }
     
-    return [self initWithContentsOfData:xmlData texture:texture];
+    return [self initWithContentsOfData:fontData textures:textures];
 }
 
 - (instancetype)initWithContentsOfFile:(NSString *)path
@@ -124,7 +469,7 @@ NSString *const SPBitmapFontMiniName = @"mini";
 
 - (instancetype)init
 {
-    return [self initWithContentsOfData:nil texture:nil];
+    return [self initWithContentsOfData:nil textures:nil];
 }
 
 - (instancetype)initWithMiniFont
@@ -136,8 +481,16 @@ NSString *const SPBitmapFontMiniName = @"mini";
 {
     [_name release];
     [_texture release];
-    [_chars release];
-    [_helperImage release];
+    [_textures release];
+    [_distanceFieldStyle release];
+    charTableClear(&_chars, self);
+    free(_kernings.entries);
+    free(_charLocations);
+    free(_charMetrics);
+    free(_wordMetrics);
+    free(_lineEnds);
+    free(_lineStarts);
+    free(_charIDs);
     [super dealloc];
 }
 
@@ -145,35 +498,76 @@ NSString *const SPBitmapFontMiniName = @"mini";
 
 - (SPBitmapChar *)charByID:(int)charID
 {
-    return _chars[@(charID)];
+    return charTableGet(&_chars, charID);
 }
 
 - (void)addBitmapChar:(SPBitmapChar *)bitmapChar charID:(int)charID
 {
-    _chars[@(charID)] = bitmapChar;
+    SPBitmapChar **slot = charTableSlot(&_chars, charID);
+
+    // the page decides on the quad batch the char is drawn into
+    [bitmapChar setPage:[self pageOfTexture:bitmapChar.texture]];
+
+    [bitmapChar retain];
+    if ((*slot).font == self) [*slot setFont:nil];
+    [*slot release];
+    *slot = bitmapChar;
+
+    // kerning that is added to the char later is forwarded to the font
+    [bitmapChar setFont:self];
+
+    // kerning that was added to the char itself is taken over
+    [bitmapChar.kernings enumerateKeysAndObjectsUsingBlock:^(NSNumber *firstID, NSNumber *amount, BOOL *stop)
+    {
+        [self addKerning:amount.floatValue betweenChar:firstID.intValue andChar:charID];
+    }];
+}
+
+- (void)addKerning:(float)amount betweenChar:(int)firstID andChar:(int)secondID
+{
+    hashTableInsert(&_kernings, kerningKey(firstID, secondID))->kerning = amount;
+}
+
+- (float)kerningBetweenChar:(int)firstID andChar:(int)secondID
+{
+    return getKerning(&_kernings, firstID, secondID);
 }
 
 - (SP_GENERIC(NSArray, NSNumber*) *)allCharIDs
 {
-    return _chars.allKeys;
+    NSMutableArray *charIDs = [NSMutableArray array];
+
+    charTableEnumerate(&_chars, ^(int charID, SPBitmapChar *bitmapChar)
+    {
+        [charIDs addObject:@(charID)];
+    });
+
+    return charIDs;
 }
 
 - (BOOL)hasCharsInString:(NSString *)string
 {
     if (!string) return YES;
     
-    for (NSInteger i=0; i<string.length; ++i)
+    NSInteger length = string.length;
+    int *charIDs = malloc(sizeof(int) * length);
+    BOOL hasChars = YES;
+    
+    [self getCharIDs:charIDs ofText:string range:NSMakeRange(0, length)];
+    
+    for (NSInteger i=0; i<length && hasChars; ++i)
     {
-        int charID = [string characterAtIndex:i];
+        int charID = charIDs[i];
         
         if (charID != CHAR_SPACE && charID != CHAR_TAB && charID != CHAR_NEWLINE &&
-            charID != CHAR_CARRIAGE_RETURN && ![self charByID:charID])
+            charID != CHAR_CARRIAGE_RETURN && charID != SPCharIDContinuation && ![self charByID:charID])
         {
-            return NO;
+            hasChars = NO;
         }
     }
     
-    return YES;
+    free(charIDs);
+    return hasChars;
 }
 
 - (SPSprite *)createSpriteWithWidth:(float)width height:(float)height
@@ -182,22 +576,44 @@ NSString *const SPBitmapFontMiniName = @"mini";
                           autoScale:(BOOL)autoScale kerning:(BOOL)kerning
                             leading:(float)leading
 {
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *charLocations = [self arrangeCharsInAreaWithWidth:width height:height
-		text:text fontSize:size hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning leading:leading];
+    @synchronized (self)
+    {
+        float scale = 1.0f;
+        NSInteger numLocations = [self arrangeCharsInAreaWithWidth:width height:height text:text
+                                                          fontSize:size hAlign:hAlign vAlign:vAlign
+                                                         autoScale:autoScale kerning:kerning
+                                                           leading:leading scale:&scale];
+        SPSprite *sprite = [SPSprite sprite];
 
-    SPSprite *sprite = [SPSprite sprite];
+        if (_distanceFieldStyle)
+        {
+            // images can't carry a distance field style, so the chars are batched per page
+            for (int page=0; page<_textures.count; ++page)
+            {
+                if (![self hasCharLocations:numLocations onPage:page]) continue;
 
-    for (SPCharLocation *charLocation in charLocations)
-    {
-        SPImage *charImage = [charLocation.bitmapChar createImage];
-        charImage.x = charLocation.x;
-        charImage.y = charLocation.y;
-        charImage.scaleX = charImage.scaleY = charLocation.scale;
-        charImage.color = color;
-        [sprite addChild:charImage];
-    }
+                SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+                [self addCharLocations:numLocations onPage:page toQuadBatch:quadBatch
+                                 scale:scale color:color];
+                [sprite addChild:quadBatch];
+            }
+
+            return sprite;
+        }
+
+        for (NSInteger i=0; i<numLocations; ++i)
+        {
+            SPCharLocation *charLocation = &_charLocations[i];
+            SPImage *charImage = [charLocation->bitmapChar createImage];
+            charImage.x = charLocation->x;
+            charImage.y = charLocation->y;
+            charImage.scaleX = charImage.scaleY = scale;
+            charImage.color = color;
+            [sprite addChild:charImage];
+        }
 
-    return sprite;
+        return sprite;
+    }
 }
 
 - (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
@@ -206,28 +622,69 @@ NSString *const SPBitmapFontMiniName = @"mini";
             autoScale:(BOOL)autoScale kerning:(BOOL)kerning
               leading:(float)leading
 {
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *charLocations = [self arrangeCharsInAreaWithWidth:width height:height
-		text:text fontSize:size hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning leading:leading];
+    @synchronized (self)
+    {
+        float scale = 1.0f;
+        NSInteger numLocations = [self arrangeCharsInAreaWithWidth:width height:height text:text
+                                                          fontSize:size hAlign:hAlign vAlign:vAlign
+                                                         autoScale:autoScale kerning:kerning
+                                                           leading:leading scale:&scale];
+        int page = numLocations ? _charLocations[0].page : 0;
 
-    _helperImage.color = color;
+        for (NSInteger i=1; i<numLocations; ++i)
+            if (_charLocations[i].page != page)
+                [NSException raise:SPExceptionInvalidOperation
+                            format:@"Text spans several pages of the font; use 'fillQuadBatches:'"];
 
-    if (charLocations.count > 8192)
-        [NSException raise:SPExceptionInvalidOperation
-                    format:@"Bitmap font text is limited to 8192 characters"];
+        [self addCharLocations:numLocations onPage:page toQuadBatch:quadBatch scale:scale color:color];
+    }
+}
 
-    for (SPCharLocation *charLocation in charLocations)
+- (NSInteger)fillQuadBatches:(NSMutableArray *)quadBatches
+                   withWidth:(float)width height:(float)height
+                        text:(NSString *)text fontSize:(float)size color:(uint)color
+                      hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                   autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+                     leading:(float)leading
+{
+    @synchronized (self)
     {
-        _helperImage.texture = charLocation.bitmapChar.texture;
-        _helperImage.x = charLocation.x;
-        _helperImage.y = charLocation.y;
-        _helperImage.scaleX = _helperImage.scaleY = charLocation.scale;
-        [_helperImage readjustSize];
-        [quadBatch addQuad:_helperImage];
+        float scale = 1.0f;
+        NSInteger numLocations = [self arrangeCharsInAreaWithWidth:width height:height text:text
+                                                          fontSize:size hAlign:hAlign vAlign:vAlign
+                                                         autoScale:autoScale kerning:kerning
+                                                           leading:leading scale:&scale];
+        NSInteger numPages = _textures.count;
+        NSInteger numBatches = 0;
+
+        for (SPQuadBatch *quadBatch in quadBatches)
+            [quadBatch reset];
+
+        // the chars are grouped by page, so each page needs just one batch -- no matter how often
+        // the text switches between pages.
+
+        for (int page=0; page<numPages; ++page)
+        {
+            if (![self hasCharLocations:numLocations onPage:page]) continue;
+
+            if (numBatches == quadBatches.count)
+                [quadBatches addObject:[SPQuadBatch quadBatch]];
+
+            [self addCharLocations:numLocations onPage:page toQuadBatch:quadBatches[numBatches++]
+                             scale:scale color:color];
+        }
+
+        return numBatches;
     }
 }
 
 #pragma mark Properties
 
+- (void)setDistanceFieldStyle:(SPDistanceFieldStyle *)distanceFieldStyle
+{
+    SP_RELEASE_AND_COPY(_distanceFieldStyle, distanceFieldStyle);
+}
+
 - (SPTextureSmoothing)smoothing
 {
     return _texture.smoothing;
@@ -235,20 +692,39 @@ NSString *const SPBitmapFontMiniName = @"mini";
 
 - (void)setSmoothing:(SPTextureSmoothing)smoothing
 {
-    _texture.smoothing = smoothing;
+    for (SPTexture *texture in _textures)
+        texture.smoothing = smoothing;
 }
 
 #pragma mark Private
 
-- (SPTexture *)textureReferencedByXmlData:(NSData *)data
+- (NSArray *)texturesReferencedByFontData:(NSData *)data
 {
     NSString *folder = [[NSBundle mainBundle] resourcePath];
-    return [self textureReferencedByXmlData:data inFolder:folder];
+    return [self texturesReferencedByFontData:data inFolder:folder];
+}
+
+- (NSArray *)texturesReferencedByFontData:(NSData *)data inFolder:(NSString *)folder
+{
+    NSArray *filenames = isBinaryFontData(data) ? [self pagesReferencedByBinaryData:data]
+                                                : [self pagesReferencedByXmlData:data];
+    if (!filenames.count)
+        [NSException raise:SPExceptionDataInvalid format:@"Font data did not contain path to texture"];
+
+    NSMutableArray *textures = [NSMutableArray arrayWithCapacity:filenames.count];
+
+    for (NSString *filename in filenames)
+    {
+        NSString *absolutePath = [folder stringByAppendingPathComponent:filename];
+        [textures addObject:[SPTexture textureWithContentsOfFile:absolutePath]];
+    }
+
+    return textures;
 }
 
-- (SPTexture *)textureReferencedByXmlData:(NSData *)data inFolder:(NSString *)folder
+- (NSArray *)pagesReferencedByXmlData:(NSData *)data
 {
-    __block SPTexture *texture = nil;
+    NSMutableArray *filenames = [NSMutableArray array];
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
     
     [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
@@ -256,31 +732,122 @@ NSString *const SPBitmapFontMiniName = @"mini";
         if ([elementName isEqualToString:@"page"])
         {
             int id = [[attributes valueForKey:@"id"] intValue];
-            if (id != 0) [NSException raise:SPExceptionFileInvalid
-                                     format:@"Bitmap fonts with multiple pages are not supported"];
-            
-            NSString *filename = [attributes valueForKey:@"file"];
-            NSString *absolutePath = [folder stringByAppendingPathComponent:filename];
-            texture = [[SPTexture alloc] initWithContentsOfFile:absolutePath];
+            if (id != filenames.count) [NSException raise:SPExceptionFileInvalid
+                                                   format:@"Font pages must be listed in order"];
             
+            [filenames addObject:[attributes valueForKey:@"file"]];
+        }
+        else if ([elementName isEqualToString:@"chars"])
+        {
             // that's all info we need at this time.
             [parser abortParsing];
         }
     }];
 
     [parser release];
-    
-    if (!texture)
-        [NSException raise:SPExceptionDataInvalid format:@"Font XML did not contain path to texture"];
-    
-    return [texture autorelease];
+    return filenames;
+}
+
+- (NSArray *)pagesReferencedByBinaryData:(NSData *)data
+{
+    NSMutableArray *filenames = [NSMutableArray array];
+
+    enumerateBinaryFontBlocks(data, ^(uint8_t type, const void *bytes, uint32_t size)
+    {
+        if (type == BINARY_BLOCK_PAGES && size > 0)
+        {
+            // all page names are zero-terminated and have the same length
+            NSUInteger nameSize = strnlen(bytes, size) + 1;
+
+            for (NSUInteger offset = 0; offset < size; offset += nameSize)
+                [filenames addObject:stringFromBinaryFontData((const char *)bytes + offset, size - offset)];
+        }
+    });
+
+    return filenames;
 }
 
 - (BOOL)parseFontData:(NSData *)data
 {
     if (!_texture)
         [NSException raise:SPExceptionInvalidOperation format:@"Font parsing requires texture to be set"];
-    
+
+    if (isBinaryFontData(data)) return [self parseBinaryFontData:data];
+    else                        return [self parseXmlFontData:data];
+}
+
+- (BOOL)parseBinaryFontData:(NSData *)data
+{
+    // The chars are read directly from the (usually memory mapped) data. The region is copied
+    // by each subtexture, so one instance is enough.
+
+    float scale = _texture.scale;
+    SPRectangle *region = [[SPRectangle alloc] init];
+
+    enumerateBinaryFontBlocks(data, ^(uint8_t type, const void *bytes, uint32_t size)
+    {
+        if (type == BINARY_BLOCK_CHARS)
+        {
+            const SPBinaryFontChar *chars = bytes;
+            NSInteger numChars = size / sizeof(SPBinaryFontChar);
+
+            for (NSInteger i=0; i<numChars; ++i)
+            {
+                const SPBinaryFontChar *binaryChar = &chars[i];
+                SPTexture *page = [self textureOfPage:binaryChar->page];
+                int charID = binaryChar->id;
+
+                [region setX:binaryChar->x / scale + page.frame.x y:binaryChar->y / scale + page.frame.y
+                       width:binaryChar->width / scale height:binaryChar->height / scale];
+
+                SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:region ofTexture:page];
+                SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:charID texture:texture
+                                                                    xOffset:binaryChar->xOffset / scale
+                                                                    yOffset:binaryChar->yOffset / scale
+                                                                   xAdvance:binaryChar->xAdvance / scale];
+                [self addBitmapChar:bitmapChar charID:charID];
+
+                [texture release];
+                [bitmapChar release];
+            }
+        }
+        else if (type == BINARY_BLOCK_KERNING_PAIRS)
+        {
+            const SPBinaryFontKerningPair *pairs = bytes;
+            NSInteger numPairs = size / sizeof(SPBinaryFontKerningPair);
+
+            for (NSInteger i=0; i<numPairs; ++i)
+            {
+                int first  = pairs[i].first;
+                int second = pairs[i].second;
+                float amount = pairs[i].amount / scale;
+                [[self charByID:second] addKerning:amount toChar:first];
+                [self addKerning:amount betweenChar:first andChar:second];
+            }
+        }
+        else if (type == BINARY_BLOCK_INFO && size >= sizeof(SPBinaryFontInfo))
+        {
+            const SPBinaryFontInfo *info = bytes;
+            _name = [stringFromBinaryFontData(info->fontName, size - sizeof(SPBinaryFontInfo)) copy];
+            _size = info->fontSize / scale;
+
+            if (!(info->bitField & 1))
+                self.smoothing = SPTextureSmoothingNone;
+        }
+        else if (type == BINARY_BLOCK_COMMON && size >= sizeof(SPBinaryFontCommon))
+        {
+            const SPBinaryFontCommon *common = bytes;
+            _lineHeight = common->lineHeight / scale;
+            _baseline = common->base / scale;
+        }
+    });
+
+    [region release];
+    return YES;
+}
+
+- (BOOL)parseXmlFontData:(NSData *)data
+{
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
     BOOL success = [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
     {
@@ -289,14 +856,15 @@ NSString *const SPBitmapFontMiniName = @"mini";
         if ([elementName isEqualToString:@"char"])
         {
             int charID = [[attributes valueForKey:@"id"] intValue];
+            SPTexture *page = [self textureOfPage:[[attributes valueForKey:@"page"] intValue]];
             
             SPRectangle *region = [[SPRectangle alloc] init];
-            region.x = [[attributes valueForKey:@"x"] floatValue] / scale + _texture.frame.x;
-            region.y = [[attributes valueForKey:@"y"] floatValue] / scale + _texture.frame.y;
+            region.x = [[attributes valueForKey:@"x"] floatValue] / scale + page.frame.x;
+            region.y = [[attributes valueForKey:@"y"] floatValue] / scale + page.frame.y;
             region.width = [[attributes valueForKey:@"width"] floatValue] / scale;
             region.height = [[attributes valueForKey:@"height"] floatValue] / scale;
 
-            SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:region ofTexture:_texture];
+            SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:region ofTexture:page];
             
             float xOffset = [[attributes valueForKey:@"xoffset"] floatValue] / scale;
             float yOffset = [[attributes valueForKey:@"yoffset"] floatValue] / scale;
@@ -306,7 +874,7 @@ NSString *const SPBitmapFontMiniName = @"mini";
                                                                 xOffset:xOffset yOffset:yOffset
                                                                xAdvance:xAdvance];
 
-            _chars[@(charID)] = bitmapChar;
+            [self addBitmapChar:bitmapChar charID:charID];
 
             [region release];
             [texture release];
@@ -318,6 +886,7 @@ NSString *const SPBitmapFontMiniName = @"mini";
             int second = [[attributes valueForKey:@"second"] intValue];
             float amount = [[attributes valueForKey:@"amount"] floatValue] / scale;
             [[self charByID:second] addKerning:amount toChar:first];
+            [self addKerning:amount betweenChar:first andChar:second];
         }
         else if ([elementName isEqualToString:@"info"])
         {
@@ -332,6 +901,14 @@ NSString *const SPBitmapFontMiniName = @"mini";
             _lineHeight = [[attributes valueForKey:@"lineHeight"] floatValue] / scale;
             _baseline = [[attributes valueForKey:@"base"] floatValue] / scale;
         }
+        else if ([elementName isEqualToString:@"distanceField"])
+        {
+            // the edges are anti-aliased with screen-space derivatives, so the distance range
+            // is not needed.
+            SPDistanceFieldStyle *style = [SPDistanceFieldStyle style];
+            style.multiChannel = [[attributes valueForKey:@"fieldType"] isEqualToString:@"msdf"];
+            self.distanceFieldStyle = style;
+        }
     }];
 
     [parser release];
@@ -343,158 +920,491 @@ NSString *const SPBitmapFontMiniName = @"mini";
     return success;
 }
 
-- (SP_GENERIC(NSMutableArray, SPCharLocation*) *)arrangeCharsInAreaWithWidth:(float)width height:(float)height
-                                                            text:(NSString *)text fontSize:(float)size
-                                                          hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
-                                                       autoScale:(BOOL)autoScale kerning:(BOOL)kerning
-                                                         leading:(float)leading
+- (SPTexture *)textureOfPage:(int)page
+{
+    if (page < 0 || page >= _textures.count)
+        [NSException raise:SPExceptionDataInvalid
+                    format:@"Font data references page %d, but there are %d textures",
+                           page, (int)_textures.count];
 
+    return _textures[page];
+}
+
+- (int)pageOfTexture:(SPTexture *)texture
 {
-    if (text.length == 0) return [NSMutableArray array];
-    if (size < 0) size *= -_size;
-    
-    SP_GENERIC(NSMutableArray, SP_GENERIC(NSMutableArray, SPCharLocation*)*) *lines = nil;
-    float scale = 0.0f;
-    float containerWidth = 0.0f;
-    float containerHeight = 0.0f;
+    // textures are on the same page if they share their GL texture
+    for (int i=0; i<_textures.count; ++i)
+        if ([_textures[i] name] == texture.name) return i;
+
+    return 0;
+}
+
+- (BOOL)hasCharLocations:(NSInteger)numLocations onPage:(int)page
+{
+    for (NSInteger i=0; i<numLocations; ++i)
+        if (_charLocations[i].page == page) return YES;
+
+    return NO;
+}
+
+- (void)addCharLocations:(NSInteger)numLocations onPage:(int)page toQuadBatch:(SPQuadBatch *)quadBatch
+                   scale:(float)scale color:(uint)color
+{
+    NSInteger numQuads = 0;
+    NSInteger firstLocation = -1;
+
+    for (NSInteger i=0; i<numLocations; ++i)
+    {
+        if (_charLocations[i].page == page)
+        {
+            if (firstLocation < 0) firstLocation = i;
+            ++numQuads;
+        }
+    }
+
+    if (numQuads > 8192)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"Bitmap font text is limited to 8192 characters"];
+
+    if (numQuads == 0) return;
+
+    // the vertices are written directly, which saves creating and transforming a quad per char.
+    // all chars of a page share its texture, so the first one decides on the state of the batch.
+
+    SPTexture *texture = _charLocations[firstLocation].bitmapChar.texture;
+    SPVertexColor vertexColor = SPVertexColorMakeWithColorAndAlpha(color, 1.0f);
+    SPVertex *vertices = [quadBatch appendQuads:numQuads texture:texture
+                                         tinted:color != SPColorWhite];
+
+    quadBatch.distanceFieldStyle = _distanceFieldStyle;
+
+    for (NSInteger i=firstLocation; i<numLocations; ++i)
+    {
+        SPCharLocation *charLocation = &_charLocations[i];
+        if (charLocation->page != page) continue;
+
+        SPBitmapChar *bitmapChar = charLocation->bitmapChar;
+        const GLKVector2 *texCoords = bitmapChar.texCoords;
+
+        float left   = charLocation->x;
+        float top    = charLocation->y;
+        float right  = left + bitmapChar.width  * scale;
+        float bottom = top  + bitmapChar.height * scale;
+
+        vertices[0].position = GLKVector2Make(left,  top);
+        vertices[1].position = GLKVector2Make(right, top);
+        vertices[2].position = GLKVector2Make(left,  bottom);
+        vertices[3].position = GLKVector2Make(right, bottom);
+
+        for (int j=0; j<4; ++j)
+        {
+            vertices[j].texCoords = texCoords[j];
+            vertices[j].color = vertexColor;
+        }
+
+        vertices += 4;
+    }
+}
+
+- (void)ensureLayoutCapacity:(NSInteger)numChars
+{
+    if (numChars <= _layoutCapacity) return;
+
+    _layoutCapacity = MAX(numChars, _layoutCapacity * 2);
+    _charLocations = realloc(_charLocations, sizeof(SPCharLocation) * _layoutCapacity);
+    _charMetrics = realloc(_charMetrics, sizeof(SPCharMetrics) * _layoutCapacity);
+    _wordMetrics = realloc(_wordMetrics, sizeof(SPWordMetrics) * _layoutCapacity);
+    _lineEnds = realloc(_lineEnds, sizeof(NSInteger) * (_layoutCapacity + 1));
+    _lineStarts = realloc(_lineStarts, sizeof(NSInteger) * (_layoutCapacity + 1));
+    _charIDs = realloc(_charIDs, sizeof(int) * _layoutCapacity);
+}
+
+- (void)measureChars:(NSInteger)numChars fromChar:(NSInteger)firstChar kerning:(BOOL)kerning
+{
+    // the metrics don't depend on the font size, so they are looked up only once per layout
+    int lastCharID = -1;
+
+    for (NSInteger i=firstChar; i<numChars; ++i)
+    {
+        int charID = _charIDs[i];
+        SPCharMetrics *metrics = &_charMetrics[i];
+        SPBitmapChar *bitmapChar = charID == SPCharIDContinuation ? nil : charTableGet(&_chars, charID);
+
+        metrics->bitmapChar = bitmapChar;
+
+        if (charID == SPCharIDContinuation)
+        {
+            continue; // the rest of a char that spans several UTF-16 units
+        }
+        else if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
+        {
+            lastCharID = -1;
+        }
+        else if (!bitmapChar)
+        {
+            SPLog(@"Missing character: %d", charID);
+        }
+        else
+        {
+            metrics->kerning = kerning ? getKerning(&_kernings, lastCharID, charID) : 0.0f;
+            metrics->xOffset = bitmapChar.xOffset;
+            metrics->yOffset = bitmapChar.yOffset;
+            metrics->xAdvance = bitmapChar.xAdvance;
+            metrics->width = bitmapChar.width;
+            metrics->page = bitmapChar.page;
+            lastCharID = charID;
+        }
+    }
+}
+
+- (NSInteger)measureWords:(NSInteger)numChars
+{
+    // Splits the measured chars into words, white spaces and line breaks, so that the auto-scale
+    // search can place a complete word at once. Chars without a glyph are part of the words;
+    // words that consist only of such chars are dropped.
+
+    NSInteger numWords = 0;
+    SPWordMetrics *word = NULL;
+
+    for (NSInteger i=0; i<numChars; ++i)
+    {
+        int charID = _charIDs[i];
+        SPCharMetrics *metrics = &_charMetrics[i];
+        SPWordType type = SPWordTypeWord;
+
+        if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
+            type = SPWordTypeLineBreak;
+        else if (metrics->bitmapChar && (charID == CHAR_SPACE || charID == CHAR_TAB))
+            type = SPWordTypeWhiteSpace;
+
+        if (!word || type != SPWordTypeWord || word->type != SPWordTypeWord)
+        {
+            if (word && word->type == SPWordTypeWord && word->extent == -FLT_MAX)
+                --numWords;
+
+            word = &_wordMetrics[numWords++];
+            word->type = type;
+            word->firstChar = i;
+            word->numChars = 0;
+            word->kerning = 0.0f;
+            word->extent = -FLT_MAX;
+            word->xAdvance = 0.0f;
+        }
+
+        ++word->numChars;
+
+        if (metrics->bitmapChar && type != SPWordTypeLineBreak)
+        {
+            if (word->extent == -FLT_MAX) word->kerning = metrics->kerning;
+            else word->xAdvance += metrics->kerning;
+
+            word->extent = MAX(word->extent, word->xAdvance + metrics->xOffset + metrics->width);
+            word->xAdvance += metrics->xAdvance;
+        }
+    }
+
+    if (word && word->type == SPWordTypeWord && word->extent == -FLT_MAX)
+        --numWords;
+
+    return numWords;
+}
+
+- (BOOL)canArrangeWords:(NSInteger)numWords numChars:(NSInteger)numChars
+         containerWidth:(float)containerWidth containerHeight:(float)containerHeight
+                leading:(float)leading
+{
+    // Simulates 'arrangeChars:...' on the word metrics, without storing any locations. The result
+    // is the same, but a word that fits into the current line is placed with a single comparison.
+
+    if (_lineHeight > containerHeight) return NO;
+
+    BOOL lineStarted = NO;
+    BOOL whiteSpaceInLine = NO;
+    float currentX = 0.0f;
+    float currentY = 0.0f;
+
+    for (NSInteger w=0; w<numWords; ++w)
+    {
+        SPWordMetrics *word = &_wordMetrics[w];
+        BOOL isLastChar = word->firstChar + word->numChars == numChars;
+
+        if (word->type == SPWordTypeLineBreak)
+        {
+            if (isLastChar) return YES;
+            if (!startNewLine(&currentX, &currentY, _lineHeight, leading, containerHeight))
+                return NO;
+
+            lineStarted = whiteSpaceInLine = NO;
+            continue;
+        }
+
+        float kerning = lineStarted ? word->kerning : 0.0f;
+
+        if (currentX + kerning + word->extent <= containerWidth)
+        {
+            currentX += kerning + word->xAdvance;
+            lineStarted = YES;
+            whiteSpaceInLine |= word->type == SPWordTypeWhiteSpace;
+        }
+        else if (word->type == SPWordTypeWhiteSpace)
+        {
+            // the white space ends the line
+            if (isLastChar) return YES;
+            if (!startNewLine(&currentX, &currentY, _lineHeight, leading, containerHeight))
+                return NO;
+
+            lineStarted = whiteSpaceInLine = NO;
+        }
+        else if (whiteSpaceInLine)
+        {
+            // the word is moved to the next line
+            if (!startNewLine(&currentX, &currentY, _lineHeight, leading, containerHeight))
+                return NO;
+
+            lineStarted = whiteSpaceInLine = NO;
+            --w;
+        }
+        else
+        {
+            // the word doesn't fit into a line of its own, so it is split up
+            NSInteger lastChar = word->firstChar + word->numChars;
+
+            for (NSInteger i=word->firstChar; i<lastChar; ++i)
+            {
+                SPCharMetrics *metrics = &_charMetrics[i];
+                if (!metrics->bitmapChar) continue;
+
+                kerning = lineStarted ? metrics->kerning : 0.0f;
+
+                if (currentX + kerning + metrics->xOffset + metrics->width > containerWidth)
+                {
+                    if (!lineStarted) return NO;
+                    if (!startNewLine(&currentX, &currentY, _lineHeight, leading, containerHeight))
+                        return NO;
+
+                    lineStarted = whiteSpaceInLine = NO;
+                    --i;
+                }
+                else
+                {
+                    currentX += kerning + metrics->xAdvance;
+                    lineStarted = YES;
+                }
+            }
+        }
+    }
+
+    return YES;
+}
+
+- (BOOL)arrangeChars:(NSInteger)numChars fromChar:(NSInteger)firstChar line:(NSInteger)firstLine
+      containerWidth:(float)containerWidth containerHeight:(float)containerHeight
+             leading:(float)leading numLocations:(NSInteger *)outNumLocations
+            numLines:(NSInteger *)outNumLines
+{
+    // The chars are arranged in '_charLocations', line after line, starting with a certain char
+    // at the beginning of a certain line. '_lineEnds' stores the index behind the last location
+    // of each line, '_lineStarts' the index of its first char. Returns NO if the text did not
+    // fit into the container.
+
+    NSInteger numLocations = 0;
+    NSInteger numLines = 0;
     BOOL finished = NO;
     
-    while (!finished)
+    if (_lineHeight <= containerHeight)
     {
-        lines = [NSMutableArray array];
-        scale = size / _size;
-        containerWidth  = width  / scale;
-        containerHeight = height / scale;
+        int lastWhiteSpace = -1;
+        NSInteger lastWhiteSpaceLocation = -1;
+        BOOL lineStarted = NO;
+        float currentX = 0;
+        float currentY = firstLine * (_lineHeight + leading);
+        NSInteger lineStart = 0;
+        NSInteger lineStartChar = firstChar;
         
-        if (_lineHeight <= containerHeight)
-        {
-            int lastWhiteSpace = -1;
-            int lastCharID = -1;
-            int numChars = (int)text.length;
-            float currentX = 0;
-            float currentY = 0;
-            SP_GENERIC(NSMutableArray, SPCharLocation*) *currentLine = [NSMutableArray array];
+        for (int i=(int)firstChar; i<numChars; i++)
+        {
+            BOOL lineFull = NO;
+            int charID = _charIDs[i];
+            SPCharMetrics *metrics = &_charMetrics[i];
             
-            for (int i=0; i<numChars; i++)
+            if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
             {
-                BOOL lineFull = NO;
-                int charID = [text characterAtIndex:i];
-                SPBitmapChar *bitmapChar = [self charByID:charID];
-                
-                if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
-                {
-                    lineFull = YES;
-                }
-                else if (!bitmapChar)
+                lineFull = YES;
+            }
+            else if (metrics->bitmapChar)
+            {
+                if (charID == CHAR_SPACE || charID == CHAR_TAB)
                 {
-                    SPLog(@"Missing character: %d", charID);
+                    lastWhiteSpace = i;
+                    lastWhiteSpaceLocation = numLocations;
                 }
-                else
+                
+                // there's no kerning to the last char of the previous line
+                if (lineStarted)
+                    currentX += metrics->kerning;
+                
+                SPCharLocation *charLocation = &_charLocations[numLocations++];
+                charLocation->bitmapChar = metrics->bitmapChar;
+                charLocation->page = metrics->page;
+                charLocation->x = currentX + metrics->xOffset;
+                charLocation->y = currentY + metrics->yOffset;
+                
+                currentX += metrics->xAdvance;
+                lineStarted = YES;
+                
+                if (charLocation->x + metrics->width > containerWidth)
                 {
-                    if (charID == CHAR_SPACE || charID == CHAR_TAB)
-                        lastWhiteSpace = i;
-                    
-                    if (kerning)
-                        currentX += [bitmapChar kerningToChar:lastCharID];
-                    
-                    SPCharLocation *charLocation = [[SPCharLocation alloc] initWithChar:bitmapChar];
-                    charLocation.x = currentX + bitmapChar.xOffset;
-                    charLocation.y = currentY + bitmapChar.yOffset;
-
-                    [currentLine addObject:charLocation];
-                    [charLocation release];
+                    // remove characters and add them again to next line. Not every char has a
+                    // location (e.g. missing chars, or the second half of a surrogate pair), so
+                    // the locations are counted separately.
+                    numLocations = MAX(lineStart, lastWhiteSpace == -1 ?
+                                       numLocations - 1 : lastWhiteSpaceLocation + 1);
                     
-                    currentX += bitmapChar.xAdvance;
-                    lastCharID = charID;
+                    if (numLocations == lineStart)
+                        break;
                     
-                    if (charLocation.x + bitmapChar.width > containerWidth)
-                    {
-                        // remove characters and add them again to next line
-                        int numCharsToRemove = lastWhiteSpace == -1 ? 1 : i - lastWhiteSpace;
-                        int removeIndex = (int)currentLine.count - numCharsToRemove;
-                        
-                        [currentLine removeObjectsInRange:NSMakeRange(removeIndex, numCharsToRemove)];
-                        
-                        if (currentLine.count == 0)
-                            break;
-                        
-                        i -= numCharsToRemove;
-                        lineFull = YES;
-                    }
+                    i = lastWhiteSpace == -1 ? i - 1 : lastWhiteSpace;
+                    lineFull = YES;
                 }
+            }
+            
+            if (i == numChars - 1)
+            {
+                _lineStarts[numLines] = lineStartChar;
+                _lineEnds[numLines++] = numLocations;
+                finished = YES;
+            }
+            else if (lineFull)
+            {
+                if (lastWhiteSpace == i && numLocations > lineStart)
+                    --numLocations;
+
+                _lineStarts[numLines] = lineStartChar;
+                _lineEnds[numLines++] = numLocations;
                 
-                if (i == numChars - 1)
+                if (currentY + leading + (2 * _lineHeight) <= containerHeight)
                 {
-                    [lines addObject:currentLine];
-                    finished = YES;
+                    lineStart = numLocations;
+                    lineStartChar = i + 1;
+                    currentX = 0.0f;
+                    currentY += _lineHeight + leading;
+                    lastWhiteSpace = -1;
+                    lineStarted = NO;
                 }
-                else if (lineFull)
+                else
                 {
-                    [lines addObject:currentLine];
-                    
-                    if (lastWhiteSpace == i)
-                        [currentLine removeLastObject];
-                    
-                    if (currentY + leading + (2 * _lineHeight) <= containerHeight)
-                    {
-                        currentLine = [NSMutableArray array];
-                        currentX = 0.0f;
-                        currentY += _lineHeight + leading;
-                        lastWhiteSpace = -1;
-                        lastCharID = -1;
-                    }
-                    else
-                    {
-                        break;
-                    }
+                    break;
                 }
-            } // for each char
-        } // if (_lineHeight < containerHeight)
-        
-        if (autoScale && !finished)
-        {
-            size -= 1;
-            [lines removeAllObjects];
-        }
-        else
+            }
+        } // for each char
+    } // if (_lineHeight < containerHeight)
+
+    *outNumLocations = numLocations;
+    *outNumLines = numLines;
+    return finished;
+}
+
+- (NSInteger)arrangeCharsInAreaWithWidth:(float)width height:(float)height
+                                    text:(NSString *)text fontSize:(float)size
+                                  hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                               autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+                                 leading:(float)leading scale:(float *)outScale
+{
+    // All buffers are reused, so no objects are created.
+
+    NSInteger numChars = text.length;
+    if (numChars == 0) return 0;
+    if (size < 0) size *= -_size;
+
+    [self ensureLayoutCapacity:numChars];
+    [self getCharIDs:_charIDs ofText:text range:NSMakeRange(0, numChars)];
+    [self measureChars:numChars fromChar:0 kerning:kerning];
+
+    NSInteger numLocations = 0;
+    NSInteger numLines = 0;
+    float scale = size / _size;
+
+    BOOL finished = [self arrangeChars:numChars fromChar:0 line:0 containerWidth:width / scale
+                       containerHeight:height / scale leading:leading
+                          numLocations:&numLocations numLines:&numLines];
+
+    int maxSteps = (int)ceilf(size) - 1;
+
+    if (autoScale && !finished && maxSteps > 0)
+    {
+        // The biggest size that fits is searched by bisection, in steps of one point below the
+        // requested size. 'minSteps' is known not to fit, 'maxSteps' is the smallest size > 0.
+        // The steps are tested on the word metrics, which are the same for all sizes; if not even
+        // the smallest size fits, it is used anyway and the text is cut off.
+
+        NSInteger numWords = [self measureWords:numChars];
+        int minSteps = 0;
+
+        scale = (size - maxSteps) / _size;
+
+        if ([self canArrangeWords:numWords numChars:numChars containerWidth:width / scale
+                  containerHeight:height / scale leading:leading])
         {
-            finished = YES;
+            while (maxSteps - minSteps > 1)
+            {
+                int steps = (minSteps + maxSteps) / 2;
+                scale = (size - steps) / _size;
+
+                if ([self canArrangeWords:numWords numChars:numChars containerWidth:width / scale
+                          containerHeight:height / scale leading:leading])
+                    maxSteps = steps;
+                else
+                    minSteps = steps;
+            }
         }
-    } // while (!finished)
-    
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *finalLocations = [NSMutableArray array];
-    int numLines = (int)lines.count;
+
+        size -= maxSteps;
+        scale = size / _size;
+
+        [self arrangeChars:numChars fromChar:0 line:0 containerWidth:width / scale
+           containerHeight:height / scale leading:leading
+              numLocations:&numLocations numLines:&numLines];
+    }
+
+    float containerWidth  = width  / scale;
+    float containerHeight = height / scale;
+    NSInteger numFinalLocations = 0;
+    NSInteger lineStart = 0;
     float bottom = numLines * _lineHeight;
     int yOffset = 0;
     
     if (vAlign == SPVAlignBottom)      yOffset =  containerHeight - bottom;
     else if (vAlign == SPVAlignCenter) yOffset = (containerHeight - bottom) / 2;
     
-    for (NSArray *line in lines)
+    for (NSInteger l=0; l<numLines; ++l)
     {
-        int numChars = (int)line.count;
-        if (!numChars) continue;
+        NSInteger lineEnd = _lineEnds[l];
+        if (lineEnd == lineStart) continue;
         
         int xOffset = 0;
-        SPCharLocation *lastLocation = [line lastObject];
-        float right = lastLocation.x - lastLocation.bitmapChar.xOffset
-                                     + lastLocation.bitmapChar.xAdvance;
+        SPCharLocation *lastLocation = &_charLocations[lineEnd - 1];
+        float right = lastLocation->x - lastLocation->bitmapChar.xOffset
+                                      + lastLocation->bitmapChar.xAdvance;
         
         if (hAlign == SPHAlignRight)       xOffset =  containerWidth - right;
         else if (hAlign == SPHAlignCenter) xOffset = (containerWidth - right) / 2;
         
-        for (SPCharLocation *charLocation in line)
+        // empty chars are dropped, so the locations move to the front of the buffer
+        for (NSInteger i=lineStart; i<lineEnd; ++i)
         {
+            SPCharLocation charLocation = _charLocations[i];
             charLocation.x = scale * (charLocation.x + xOffset + _offsetX);
             charLocation.y = scale * (charLocation.y + yOffset + _offsetY);
-            charLocation.scale = scale;
             
             if (charLocation.bitmapChar.width > 0 && charLocation.bitmapChar.height > 0)
-                [finalLocations addObject:charLocation];
+                _charLocations[numFinalLocations++] = charLocation;
         }
+
+        lineStart = lineEnd;
     }
     
-    return finalLocations;
+    *outScale = scale;
+    return numFinalLocations;
 }
 
 #pragma mark Mini Font
@@ -542,3 +1452,162 @@ NSString *MiniFontImgDataBase64 =
     "wXwvv3ujr2dcijOSoMA1BCXLL+E5M5NT/sh/2v9idsZLc1sYX4WAAAAABJRU5ErkJggg==";
 
 @end
+
+@implementation SPBitmapFont (Internal)
+
+- (instancetype)initWithName:(NSString *)name texture:(SPTexture *)texture size:(float)size
+                  lineHeight:(float)lineHeight baseline:(float)baseline
+{
+    if ((self = [super init]))
+    {
+        _name = [name copy];
+        _size = size;
+        _lineHeight = lineHeight;
+        _baseline = baseline;
+        _texture = [texture retain];
+        _textures = [@[texture] retain];
+    }
+
+    return self;
+}
+
+- (void)getCharIDs:(int *)charIDs ofText:(NSString *)text range:(NSRange)range
+{
+    CFStringInlineBuffer buffer;
+    CFStringInitInlineBuffer((CFStringRef)text, &buffer, CFRangeMake(range.location, range.length));
+
+    for (NSInteger i=0; i<range.length; ++i)
+    {
+        unichar character = CFStringGetCharacterFromInlineBuffer(&buffer, i);
+        unichar next = i + 1 < range.length ? CFStringGetCharacterFromInlineBuffer(&buffer, i + 1) : 0;
+
+        if (CFStringIsSurrogateHighCharacter(character) && CFStringIsSurrogateLowCharacter(next))
+        {
+            charIDs[i]   = (int)CFStringGetLongCharacterForSurrogatePair(character, next);
+            charIDs[++i] = SPCharIDContinuation;
+        }
+        else charIDs[i] = character;
+    }
+}
+
+- (void)removeAllChars
+{
+    charTableClear(&_chars, self);
+}
+
+- (void)setTexture:(SPTexture *)texture
+{
+    SP_RELEASE_AND_RETAIN(_texture, texture);
+    SP_RELEASE_AND_RETAIN(_textures, @[texture]);
+}
+
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
+                 text:(NSString *)text fontSize:(float)size color:(uint)color
+               hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+              kerning:(BOOL)kerning leading:(float)leading
+                lines:(NSMutableData *)lines numUnchangedChars:(NSInteger)numUnchangedChars
+{
+    @synchronized (self)
+    {
+        // The line breaks only depend on the lines above. A change may let the first word of its
+        // line move up, though; so the layout restarts one line before the change. Each line is
+        // aligned horizontally on its own; the vertical alignment depends on the number of lines,
+        // so the lines in front of the change are moved if that number changes.
+
+        NSInteger numChars = text.length;
+        NSInteger numOldLines = lines.length / sizeof(SPTextLine);
+        const SPTextLine *oldLines = lines.bytes;
+        NSInteger firstLine = 0;
+
+        // the quads of another texture (e.g. a replaced glyph cache) can't be kept
+        if (quadBatch.numQuads && quadBatch.texture.name != _texture.name)
+            numUnchangedChars = 0;
+
+        for (NSInteger l=1; l<numOldLines && oldLines[l].charIndex <= numUnchangedChars; ++l)
+            firstLine = l - 1;
+
+        NSInteger firstChar = numOldLines ? MIN(oldLines[firstLine].charIndex, numChars) : 0;
+        NSInteger firstQuad = numOldLines ? oldLines[firstLine].quadIndex : 0;
+        float oldYOffset = numOldLines ? oldLines[0].yOffset : 0.0f;
+
+        [quadBatch truncateToNumQuads:firstQuad];
+        lines.length = firstLine * sizeof(SPTextLine);
+
+        if (firstChar == numChars) return;
+        if (size < 0) size *= -_size;
+
+        // only the chars from 'firstChar' on are read from the buffers
+        [self ensureLayoutCapacity:numChars];
+        [self getCharIDs:_charIDs + firstChar ofText:text range:NSMakeRange(firstChar, numChars - firstChar)];
+        [self measureChars:numChars fromChar:firstChar kerning:kerning];
+
+        NSInteger numLocations = 0;
+        NSInteger numLines = 0;
+        float scale = size / _size;
+        float containerWidth  = width  / scale;
+        float containerHeight = height / scale;
+
+        [self arrangeChars:numChars fromChar:firstChar line:firstLine containerWidth:containerWidth
+           containerHeight:containerHeight leading:leading
+              numLocations:&numLocations numLines:&numLines];
+
+        // the offsets are calculated just like in 'arrangeCharsInAreaWithWidth:...'
+        float bottom = (firstLine + numLines) * _lineHeight;
+        int yOffset = 0;
+
+        if (vAlign == SPVAlignBottom)      yOffset =  containerHeight - bottom;
+        else if (vAlign == SPVAlignCenter) yOffset = (containerHeight - bottom) / 2;
+
+        if (firstLine && yOffset != oldYOffset)
+        {
+            SPMatrix *matrix = [SPMatrix matrixWithA:1 b:0 c:0 d:1 tx:0 ty:scale * (yOffset - oldYOffset)];
+            [quadBatch transformQuadsWithMatrix:matrix atIndex:0 numQuads:firstQuad];
+
+            SPTextLine *keptLines = lines.mutableBytes;
+            for (NSInteger l=0; l<firstLine; ++l)
+                keptLines[l].yOffset = yOffset;
+        }
+
+        NSInteger numFinalLocations = 0;
+        NSInteger lineStart = 0;
+
+        for (NSInteger l=0; l<numLines; ++l)
+        {
+            NSInteger lineEnd = _lineEnds[l];
+            int xOffset = 0;
+
+            if (lineEnd > lineStart && hAlign != SPHAlignLeft)
+            {
+                SPCharLocation *lastLocation = &_charLocations[lineEnd - 1];
+                float right = lastLocation->x - lastLocation->bitmapChar.xOffset
+                                              + lastLocation->bitmapChar.xAdvance;
+
+                if (hAlign == SPHAlignRight) xOffset =  containerWidth - right;
+                else                         xOffset = (containerWidth - right) / 2;
+            }
+
+            SPTextLine line = { _lineStarts[l], firstQuad + numFinalLocations, yOffset };
+            [lines appendBytes:&line length:sizeof(SPTextLine)];
+
+            for (NSInteger i=lineStart; i<lineEnd; ++i)
+            {
+                SPCharLocation charLocation = _charLocations[i];
+                charLocation.x = scale * (charLocation.x + xOffset + _offsetX);
+                charLocation.y = scale * (charLocation.y + yOffset + _offsetY);
+
+                if (charLocation.bitmapChar.width > 0 && charLocation.bitmapChar.height > 0)
+                    _charLocations[numFinalLocations++] = charLocation;
+            }
+
+            lineStart = lineEnd;
+        }
+
+        if (firstQuad + numFinalLocations > 8192)
+            [NSException raise:SPExceptionInvalidOperation
+                        format:@"Bitmap font text is limited to 8192 characters"];
+
+        [self addCharLocations:numFinalLocations onPage:0 toQuadBatch:quadBatch scale:scale color:color];
+    }
+}
+
+@end
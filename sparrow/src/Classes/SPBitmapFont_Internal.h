@@ -0,0 +1,62 @@
+//
+//  SPBitmapFont_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import "SPBitmapFont.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPQuadBatch;
+
+/// Where a line of text starts: at which char of the text, and at which quad of the batch; and by
+/// how much the text was moved vertically (in the coordinates of the font) to align it.
+typedef struct
+{
+    NSInteger charIndex;
+    NSInteger quadIndex;
+    float yOffset;
+} SPTextLine;
+
+/// The ID that marks the UTF-16 units which belong to the char in front of them.
+#define SPCharIDContinuation (-1)
+
+@interface SPBitmapFont (Internal)
+
+/// Initializes a font without any chars, for subclasses that create them on their own.
+- (instancetype)initWithName:(NSString *)name texture:(SPTexture *)texture size:(float)size
+                  lineHeight:(float)lineHeight baseline:(float)baseline;
+
+/// Stores the IDs of the chars in a range of the text, one per UTF-16 unit: the ID of each char
+/// is stored at its first unit, followed by `SPCharIDContinuation` for any further units it spans.
+/// Surrogate pairs form a single char with the ID of their code point; subclasses may combine
+/// longer sequences. The range has to start at the beginning of a char.
+- (void)getCharIDs:(int *)charIDs ofText:(NSString *)text range:(NSRange)range;
+
+/// Removes all chars from the font.
+- (void)removeAllChars;
+
+/// The texture that contains the chars.
+- (void)setTexture:(SPTexture *)texture;
+
+/// Fills a quad batch with text that might have been arranged in it before. `lines` contains an
+/// `SPTextLine` per line of that previous layout; the quads of all lines that can't be affected
+/// by a change behind the first `numUnchangedChars` chars are kept (moving them if the vertical
+/// alignment requires it), the rest is arranged anew, and `lines` is updated. Pass 0 to arrange
+/// the complete text. Only for fonts with a single page, and without auto-scaling.
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
+                 text:(NSString *)text fontSize:(float)size color:(uint)color
+               hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+              kerning:(BOOL)kerning leading:(float)leading
+                lines:(NSMutableData *)lines numUnchangedChars:(NSInteger)numUnchangedChars;
+
+@end
+
+NS_ASSUME_NONNULL_END
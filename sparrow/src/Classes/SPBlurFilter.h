@@ -14,6 +14,13 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Blur Mode
+typedef NS_ENUM(NSInteger, SPBlurMode)
+{
+    SPBlurModeGaussian,
+    SPBlurModeDownsampled
+};
+
 /** ------------------------------------------------------------------------------------------------
 
  The SPBlurFilter applies a gaussian blur to an object. The strength of the blur can be
@@ -29,6 +36,12 @@ NS_ASSUME_NONNULL_BEGIN
     blur = 2.0: 2 passes
     etc.
 
+ For big blur values, that gets expensive. In that case, switch to 'SPBlurModeDownsampled': it
+ repeatedly halves the texture size and then scales it up again (a "dual filter" blur), and each
+ halving doubles the blur radius. Thus, blur = 2 needs 4 small passes, blur = 16 needs 10, and
+ most of them work on just a fraction of the pixels. The output is similar to the gaussian
+ blur, but not identical; and the blur is always applied in both directions at the same time.
+
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPBlurFilter : SPFragmentFilter
@@ -115,6 +128,10 @@ NS_ASSUME_NONNULL_BEGIN
 /// multiplied with the given factor. Pass NO as the first parameter to deactivate the uniform color.
 - (void)setUniformColor:(BOOL)enable color:(uint)color alpha:(float)alpha;
 
+/// Creates the shader programs of all blur modes and outputs, so that they don't have to be
+/// compiled when a blur filter first uses them. Called by `[SPViewController warmUpPrograms]`.
++ (void)warmUpPrograms;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -125,6 +142,11 @@ NS_ASSUME_NONNULL_BEGIN
 /// The blur factor in y-direction (stage coordinates).
 @property (nonatomic, assign) float blurY;
 
+/// The algorithm that is used for the blur, one of the constants defined in the 'SPBlurMode' enum.
+/// Use 'SPBlurModeDownsampled' for big blur values, like the glow of a large panel.
+/// (default: SPBlurModeGaussian)
+@property (nonatomic, assign) SPBlurMode blurMode;
+
 @end
 
 NS_ASSUME_NONNULL_END
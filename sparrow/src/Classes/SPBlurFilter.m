@@ -11,6 +11,7 @@
 
 #import "SparrowClass.h"
 #import "SPBlurFilter.h"
+#import "SPColorMatrix.h"
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPNSExtensions.h"
@@ -18,18 +19,66 @@
 #import "SPProgram.h"
 #import "SPTexture.h"
 
+// The processing that's applied to the output color of a pass.
+typedef NS_ENUM(NSInteger, SPBlurOutput)
+{
+    SPBlurOutputNone,
+    SPBlurOutputTint,
+    SPBlurOutputColorMatrix
+};
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static void appendOutputDeclarations(NSMutableString *source, SPBlurOutput output)
+{
+    if (output == SPBlurOutputTint)
+    {
+        [source appendLine:@"uniform lowp vec4 uColor;"];
+    }
+    else if (output == SPBlurOutputColorMatrix)
+    {
+        [source appendLine:@"uniform lowp mat4 uColorMatrix;"];
+        [source appendLine:@"uniform lowp vec4 uColorOffset;"];
+        [source appendLine:@"const lowp vec4 MIN_COLOR = vec4(0, 0, 0, 0.0001);"];
+    }
+}
+
+static void appendOutput(NSMutableString *source, SPBlurOutput output, NSString *color)
+{
+    if (output == SPBlurOutputTint)
+    {
+        [source appendFormat:@"  %@.xyz = uColor.xyz * %@.www;\n", color, color];    // set rgb with correct alpha
+        [source appendFormat:@"  gl_FragColor = %@ * uColor.wwww;\n", color];        // multiply alpha
+    }
+    else if (output == SPBlurOutputColorMatrix)
+    {
+        [source appendFormat:@"  %@ = max(%@, MIN_COLOR);\n", color, color];         // avoid division through zero
+        [source appendFormat:@"  %@.xyz /= %@.www;\n", color, color];                 // restore non-PMA RGB values
+        [source appendFormat:@"  %@ *= uColorMatrix;\n", color];                      // multiply with 4x4 matrix
+        [source appendFormat:@"  %@ += uColorOffset;\n", color];                      // add offset
+        [source appendFormat:@"  %@.xyz *= %@.www;\n", color, color];                 // multiply with alpha again
+        [source appendFormat:@"  gl_FragColor = %@;\n", color];
+    }
+    else
+    {
+        [source appendFormat:@"  gl_FragColor = %@;\n", color];
+    }
+}
+
 #pragma mark - SPBlurProgram
 
 @interface SPBlurProgram : SPProgram
 
-- (instancetype)initWithTintedFragmentShader:(BOOL)isTinted;
+- (instancetype)initWithOutput:(SPBlurOutput)output asynchronous:(BOOL)async;
 
-@property (nonatomic, readonly) BOOL tinted;
+@property (nonatomic, readonly) SPBlurOutput output;
 @property (nonatomic, readonly) int aPosition;
 @property (nonatomic, readonly) int aTexCoords;
 @property (nonatomic, readonly) int uOffsets;
 @property (nonatomic, readonly) int uWeights;
 @property (nonatomic, readonly) int uColor;
+@property (nonatomic, readonly) int uColorMatrix;
+@property (nonatomic, readonly) int uColorOffset;
 @property (nonatomic, readonly) int uMvpMatrix;
 
 @end
@@ -38,35 +87,46 @@
 
 @implementation SPBlurProgram
 {
-    BOOL _tinted;
+    SPBlurOutput _output;
     int _aPosition;
     int _aTexCoords;
     int _uOffsets;
     int _uWeights;
     int _uColor;
+    int _uColorMatrix;
+    int _uColorOffset;
     int _uMvpMatrix;
 }
 
 #pragma mark Initialization
 
-- (instancetype)initWithTintedFragmentShader:(BOOL)isTinted
+- (instancetype)initWithOutput:(SPBlurOutput)output asynchronous:(BOOL)async
 {
     if ((self = [super initWithVertexShader:[self vertexShader]
-                             fragmentShader:[self fragmentShader:isTinted]]))
+                             fragmentShader:[self fragmentShader:output]
+                               asynchronous:async]))
     {
-        _tinted = isTinted;
-        _aPosition = [self attributeByName:@"aPosition"];
-        _aTexCoords = [self attributeByName:@"aTexCoords"];
-        _uOffsets = [self uniformByName:@"uOffsets"];
-        _uWeights = [self uniformByName:@"uWeights"];
-        _uColor = [self uniformByName:@"uColor"];
-        _uMvpMatrix = [self uniformByName:@"uMvpMatrix"];
+        _output = output;
     }
     return self;
 }
 
 #pragma mark Methods
 
+- (void)didBecomeReady
+{
+    [super didBecomeReady];
+
+    _aPosition = [self attributeByName:@"aPosition"];
+    _aTexCoords = [self attributeByName:@"aTexCoords"];
+    _uOffsets = [self uniformByName:@"uOffsets"];
+    _uWeights = [self uniformByName:@"uWeights"];
+    _uColor = [self uniformByName:@"uColor"];
+    _uColorMatrix = [self uniformByName:@"uColorMatrix"];
+    _uColorOffset = [self uniformByName:@"uColorOffset"];
+    _uMvpMatrix = [self uniformByName:@"uMvpMatrix"];
+}
+
 - (NSString *)vertexShader
 {
     NSMutableString *vertSource = [NSMutableString string];
@@ -101,7 +161,7 @@
     return vertSource;
 }
 
-- (NSString *)fragmentShader:(BOOL)isTinted
+- (NSString *)fragmentShader:(SPBlurOutput)output
 {
     NSMutableString *fragSource = [NSMutableString string];
 
@@ -113,7 +173,7 @@
     [fragSource appendLine:@"varying lowp vec2 v3;"];
     [fragSource appendLine:@"varying lowp vec2 v4;"];
 
-    if (isTinted) [fragSource appendLine:@"uniform lowp vec4 uColor;"];
+    appendOutputDeclarations(fragSource, output);
     [fragSource appendLine:@"uniform sampler2D uTexture;"];
     [fragSource appendLine:@"uniform lowp vec4 uWeights;"];
 
@@ -145,35 +205,186 @@
 
     [fragSource appendLine:@"  ft4 = texture2D(uTexture,v4);"];  // read pixel +2
     [fragSource appendLine:@"  ft4 = ft4 * uWeights.zzzz;"];     // multiply with weight
+    [fragSource appendLine:@"  ft5 = ft5 + ft4;"];               // add to output color
+
+    appendOutput(fragSource, output, @"ft5");
+    
+    [fragSource appendLine:@"}"];
+    
+    return fragSource;
+}
+
+#pragma mark Class
+
++ (NSString *)programNameForOutput:(SPBlurOutput)output
+{
+    return [NSString stringWithFormat:@"SPBlurFilter#0%ld", (long)output];
+}
+
+@end
+
+#pragma mark - SPDualBlurProgram
+
+@interface SPDualBlurProgram : SPProgram
+
+- (instancetype)initWithUpsampling:(BOOL)isUpsampling output:(SPBlurOutput)output asynchronous:(BOOL)async;
+
+@property (nonatomic, readonly) int aPosition;
+@property (nonatomic, readonly) int aTexCoords;
+@property (nonatomic, readonly) int uOffset;
+@property (nonatomic, readonly) int uColor;
+@property (nonatomic, readonly) int uColorMatrix;
+@property (nonatomic, readonly) int uColorOffset;
+@property (nonatomic, readonly) int uMvpMatrix;
+
+@end
+
+// --- dual blur implementation --------------------------------------------------------------------
 
-    if (isTinted)
+@implementation SPDualBlurProgram
+{
+    int _aPosition;
+    int _aTexCoords;
+    int _uOffset;
+    int _uColor;
+    int _uColorMatrix;
+    int _uColorOffset;
+    int _uMvpMatrix;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithUpsampling:(BOOL)isUpsampling output:(SPBlurOutput)output asynchronous:(BOOL)async
+{
+    return [super initWithVertexShader:[self vertexShader:isUpsampling]
+                        fragmentShader:[self fragmentShader:isUpsampling output:output]
+                          asynchronous:async];
+}
+
+#pragma mark Methods
+
+- (void)didBecomeReady
+{
+    [super didBecomeReady];
+
+    _aPosition = [self attributeByName:@"aPosition"];
+    _aTexCoords = [self attributeByName:@"aTexCoords"];
+    _uOffset = [self uniformByName:@"uOffset"];
+    _uColor = [self uniformByName:@"uColor"];
+    _uColorMatrix = [self uniformByName:@"uColorMatrix"];
+    _uColorOffset = [self uniformByName:@"uColorOffset"];
+    _uMvpMatrix = [self uniformByName:@"uMvpMatrix"];
+}
+
+- (NSString *)vertexShader:(BOOL)isUpsampling
+{
+    NSMutableString *vertSource = [NSMutableString string];
+    NSInteger numVaryings = isUpsampling ? 8 : 5;
+
+    // attributes (SPProgram binds them to the same locations as in the blur program)
+    [vertSource appendLine:@"attribute vec4 aPosition;"];
+    [vertSource appendLine:@"attribute lowp vec2 aTexCoords;"];
+
+    // uniforms
+    [vertSource appendLine:@"uniform mat4 uMvpMatrix;"];
+    [vertSource appendLine:@"uniform mediump vec2 uOffset;"];
+
+    // varying -- the textures may be big, so 'lowp' is not precise enough here
+    for (NSInteger i=0; i<numVaryings; ++i)
+        [vertSource appendFormat:@"varying mediump vec2 v%ld;\n", (long)i];
+
+    // main
+    [vertSource appendLine:@"void main() {"];
+    [vertSource appendLine:@"  gl_Position = uMvpMatrix * aPosition;"];
+
+    if (isUpsampling)
     {
-        [fragSource appendLine:@"  ft5 = ft5 + ft4;"];                   // add to output color
-        [fragSource appendLine:@"  ft5.xyz = uColor.xyz * ft5.www;"];    // set rgb with correct alpha
-        [fragSource appendLine:@"  gl_FragColor = ft5 * uColor.wwww;"];  // multiply alpha
+        // a tent filter: 4 taps on the axes, 4 (double weighted) taps on the diagonals
+        [vertSource appendLine:@"  v0 = aTexCoords + vec2(-2.0 * uOffset.x, 0.0);"];
+        [vertSource appendLine:@"  v1 = aTexCoords + vec2(-uOffset.x, uOffset.y);"];
+        [vertSource appendLine:@"  v2 = aTexCoords + vec2(0.0, 2.0 * uOffset.y);"];
+        [vertSource appendLine:@"  v3 = aTexCoords + uOffset;"];
+        [vertSource appendLine:@"  v4 = aTexCoords + vec2(2.0 * uOffset.x, 0.0);"];
+        [vertSource appendLine:@"  v5 = aTexCoords + vec2(uOffset.x, -uOffset.y);"];
+        [vertSource appendLine:@"  v6 = aTexCoords + vec2(0.0, -2.0 * uOffset.y);"];
+        [vertSource appendLine:@"  v7 = aTexCoords - uOffset;"];
     }
     else
     {
-        [fragSource appendLine:@"  gl_FragColor = ft5 + ft4;"];          // add to output color
+        // the center (weighted 4x) and the 4 diagonal neighbours. All of them are placed between
+        // source pixels, so linear sampling averages 4 pixels per lookup.
+        [vertSource appendLine:@"  v0 = aTexCoords;"];
+        [vertSource appendLine:@"  v1 = aTexCoords - uOffset;"];
+        [vertSource appendLine:@"  v2 = aTexCoords + uOffset;"];
+        [vertSource appendLine:@"  v3 = aTexCoords + vec2(uOffset.x, -uOffset.y);"];
+        [vertSource appendLine:@"  v4 = aTexCoords + vec2(-uOffset.x, uOffset.y);"];
     }
-    
+
+    [vertSource appendLine:@"}"];
+
+    return vertSource;
+}
+
+- (NSString *)fragmentShader:(BOOL)isUpsampling output:(SPBlurOutput)output
+{
+    NSMutableString *fragSource = [NSMutableString string];
+    NSInteger numVaryings = isUpsampling ? 8 : 5;
+
+    // variables
+
+    for (NSInteger i=0; i<numVaryings; ++i)
+        [fragSource appendFormat:@"varying mediump vec2 v%ld;\n", (long)i];
+
+    appendOutputDeclarations(fragSource, output);
+    [fragSource appendLine:@"uniform sampler2D uTexture;"];
+
+    // main
+
+    [fragSource appendLine:@"void main() {"];
+    [fragSource appendLine:@"  lowp vec4 sum;"];
+
+    if (isUpsampling)
+    {
+        [fragSource appendLine:@"  sum  = texture2D(uTexture, v0);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v1) * 2.0;"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v2);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v3) * 2.0;"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v4);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v5) * 2.0;"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v6);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v7) * 2.0;"];
+        [fragSource appendLine:@"  sum *= 0.0833333;"];                     // divide by 12
+    }
+    else
+    {
+        [fragSource appendLine:@"  sum  = texture2D(uTexture, v0) * 4.0;"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v1);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v2);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v3);"];
+        [fragSource appendLine:@"  sum += texture2D(uTexture, v4);"];
+        [fragSource appendLine:@"  sum *= 0.125;"];                         // divide by 8
+    }
+
+    appendOutput(fragSource, output, @"sum");
+
     [fragSource appendLine:@"}"];
-    
+
     return fragSource;
 }
 
 #pragma mark Class
 
-+ (NSString *)programNameForTinting:(BOOL)tinting
++ (NSString *)programNameForUpsampling:(BOOL)upsampling output:(SPBlurOutput)output
 {
-    if (tinting) return @"SPBlurFilter#01";
-    else         return @"SPBlurFilter#00";
+    return [NSString stringWithFormat:@"SPBlurFilter#%d%ld", upsampling ? 2 : 1, (long)output];
 }
 
 @end
 
 #pragma mark - SPBlurFilter
 
+#define MAX_NUM_LEVELS 6
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPBlurFilter
@@ -184,6 +395,15 @@
     float _color[4];
     SPBlurProgram *_program;
     SPBlurProgram *_tintedProgram;
+    SPBlurProgram *_colorMatrixProgram;
+    SPDualBlurProgram *_downsampleProgram;
+    SPDualBlurProgram *_upsampleProgram;
+    SPDualBlurProgram *_tintedUpsampleProgram;
+    SPDualBlurProgram *_colorMatrixUpsampleProgram;
+    SPColorMatrix *_shaderColorMatrix;
+    NSInteger _numLevels;
+    float _levelOffsetX;
+    float _levelOffsetY;
 }
 
 #pragma mark Initialization
@@ -214,6 +434,12 @@
 {
     [_program release];
     [_tintedProgram release];
+    [_colorMatrixProgram release];
+    [_downsampleProgram release];
+    [_upsampleProgram release];
+    [_tintedUpsampleProgram release];
+    [_colorMatrixUpsampleProgram release];
+    [_shaderColorMatrix release];
 
     [super dealloc];
 }
@@ -252,6 +478,19 @@
     _color[2] = SPColorGetBlue(color)  / 255.0f;
     _color[3] = alpha;
     _enableColorUniform = enable;
+    [self setRequiresRedraw];
+}
+
++ (void)warmUpPrograms
+{
+    for (SPBlurOutput output=SPBlurOutputNone; output<=SPBlurOutputColorMatrix; ++output)
+    {
+        [self blurProgramWithOutput:output];
+        [self dualBlurProgramForUpsampling:YES output:output];
+    }
+
+    // downsampling passes are never the final pass, so they don't need an output stage
+    [self dualBlurProgramForUpsampling:NO output:SPBlurOutputNone];
 }
 
 #pragma mark SPFragmentFilter (Subclasses)
@@ -259,27 +498,21 @@
 - (void)createPrograms
 {
     if (!_program)
-    {
-        NSString *programName = [SPBlurProgram programNameForTinting:NO];
-        _program = (SPBlurProgram *)[[[Sparrow currentController] programByName:programName] retain];
-
-        if (!_program)
-        {
-            _program = [[SPBlurProgram alloc] initWithTintedFragmentShader:NO];
-            [[Sparrow currentController] registerProgram:_program name:programName];
-        }
-    }
+        _program = [[SPBlurFilter blurProgramWithOutput:SPBlurOutputNone] retain];
 
     if (!_tintedProgram)
+        _tintedProgram = [[SPBlurFilter blurProgramWithOutput:SPBlurOutputTint] retain];
+
+    if (_blurMode == SPBlurModeDownsampled)
     {
-        NSString *programName = [SPBlurProgram programNameForTinting:YES];
-        _tintedProgram = (SPBlurProgram *)[[[Sparrow currentController] programByName:programName] retain];
-
-        if (!_tintedProgram)
-        {
-            _tintedProgram = [[SPBlurProgram alloc] initWithTintedFragmentShader:YES];
-            [[Sparrow currentController] registerProgram:_tintedProgram name:programName];
-        }
+        if (!_downsampleProgram)
+            _downsampleProgram = [[SPBlurFilter dualBlurProgramForUpsampling:NO output:SPBlurOutputNone] retain];
+
+        if (!_upsampleProgram)
+            _upsampleProgram = [[SPBlurFilter dualBlurProgramForUpsampling:YES output:SPBlurOutputNone] retain];
+
+        if (!_tintedUpsampleProgram)
+            _tintedUpsampleProgram = [[SPBlurFilter dualBlurProgramForUpsampling:YES output:SPBlurOutputTint] retain];
     }
 
     self.vertexPosID = _program.aPosition;
@@ -288,33 +521,88 @@
 
 - (void)activateWithPass:(NSInteger)pass texture:(SPTexture *)texture mvpMatrix:(SPMatrix3D *)matrix
 {
+    if (_blurMode == SPBlurModeDownsampled)
+    {
+        [self activateDualBlurWithPass:pass texture:texture mvpMatrix:matrix];
+        return;
+    }
+
     [self updateParamatersWithPass:pass texWidth:texture.nativeWidth texHeight:texture.nativeHeight];
 
-    BOOL isColorPass = _enableColorUniform && pass == self.numPasses - 1;
-    SPBlurProgram *program = isColorPass ? _tintedProgram : _program;
+    SPBlurOutput output = [self outputForPass:pass];
+    SPBlurProgram *program = _program;
+
+    if (output == SPBlurOutputTint)
+        program = _tintedProgram;
+    else if (output == SPBlurOutputColorMatrix)
+        program = [self colorMatrixProgram];
 
     glUseProgram(program.name);
 
-    glUniformMatrix4fv(program.uMvpMatrix, 1, false, matrix.rawData);
-    glUniform4fv(program.uOffsets, 1, _offsets);
-    glUniform4fv(program.uWeights, 1, _weights);
+    [program setMatrix4:matrix.rawData forUniform:program.uMvpMatrix];
+    [program setVector4:_offsets forUniform:program.uOffsets];
+    [program setVector4:_weights forUniform:program.uWeights];
+
+    if (output == SPBlurOutputTint)
+        [program setVector4:_color forUniform:program.uColor];
+    else if (output == SPBlurOutputColorMatrix)
+        [self uploadColorMatrixToProgram:program matrixUniform:program.uColorMatrix
+                           offsetUniform:program.uColorOffset];
+}
+
+- (BOOL)supportsOutputColorMatrix
+{
+    return YES;
+}
+
+- (BOOL)programsReady
+{
+    // the programs for a color matrix output are only created when they are needed
+    BOOL needsColorMatrix = self.outputColorMatrix != nil;
+
+    if (!_program.isReady || !_tintedProgram.isReady)
+        return NO;
+    else if (_blurMode == SPBlurModeDownsampled)
+        return _downsampleProgram.isReady && _upsampleProgram.isReady && _tintedUpsampleProgram.isReady &&
+               (!needsColorMatrix || [self colorMatrixUpsampleProgram].isReady);
+    else
+        return !needsColorMatrix || [self colorMatrixProgram].isReady;
+}
+
+- (float)resolutionForPass:(NSInteger)pass
+{
+    if (_blurMode == SPBlurModeGaussian) return 1.0f;
 
-    if (isColorPass)
-        glUniform4fv(program.uColor, 1, _color);
+    // the first half of the passes walks down the pyramid, the second half up again
+    NSInteger level = pass < _numLevels ? pass : 2 * _numLevels - pass;
+    return 1.0f / (1 << level);
 }
 
 #pragma mark Properties
 
+- (void)setBlurMode:(SPBlurMode)blurMode
+{
+    if (blurMode != _blurMode)
+    {
+        _blurMode = blurMode;
+        [self createPrograms];
+        [self updateMarginsAndPasses];
+        [self setRequiresRedraw];
+    }
+}
+
 - (void)setBlurX:(float)blurX
 {
     _blurX = blurX;
     [self updateMarginsAndPasses];
+    [self setRequiresRedraw];
 }
 
 - (void)setBlurY:(float)blurY
 {
     _blurY = blurY;
     [self updateMarginsAndPasses];
+    [self setRequiresRedraw];
 }
 
 #pragma mark Private
@@ -389,14 +677,150 @@
     }
 }
 
+- (void)activateDualBlurWithPass:(NSInteger)pass texture:(SPTexture *)texture mvpMatrix:(SPMatrix3D *)matrix
+{
+    // Dual filter blur, as described by Marius Bjorge ("Bandwidth-Efficient Rendering",
+    // SIGGRAPH 2015): each downsampling pass halves the texture size, each upsampling pass
+    // doubles it again. The offsets are given in pixels of the input texture.
+
+    BOOL isUpsampling = pass >= _numLevels;
+    SPBlurOutput output = [self outputForPass:pass];
+    float offsetFactor = isUpsampling ? 0.5f : 1.0f;
+    float offset[2];
+
+    SPDualBlurProgram *program = isUpsampling ? _upsampleProgram : _downsampleProgram;
+
+    if (output == SPBlurOutputTint)
+        program = _tintedUpsampleProgram;
+    else if (output == SPBlurOutputColorMatrix)
+        program = [self colorMatrixUpsampleProgram];
+
+    offset[0] = offsetFactor * _levelOffsetX / texture.nativeWidth;
+    offset[1] = offsetFactor * _levelOffsetY / texture.nativeHeight;
+
+    glUseProgram(program.name);
+
+    [program setMatrix4:matrix.rawData forUniform:program.uMvpMatrix];
+    [program setVector2:offset forUniform:program.uOffset];
+
+    if (output == SPBlurOutputTint)
+        [program setVector4:_color forUniform:program.uColor];
+    else if (output == SPBlurOutputColorMatrix)
+        [self uploadColorMatrixToProgram:program matrixUniform:program.uColorMatrix
+                           offsetUniform:program.uColorOffset];
+}
+
+- (SPBlurOutput)outputForPass:(NSInteger)pass
+{
+    if (pass != self.numPasses - 1)   return SPBlurOutputNone;
+    else if (self.outputColorMatrix)  return SPBlurOutputColorMatrix;
+    else if (_enableColorUniform)     return SPBlurOutputTint;
+    else                              return SPBlurOutputNone;
+}
+
+- (void)uploadColorMatrixToProgram:(SPProgram *)program matrixUniform:(int)matrixUniform
+                      offsetUniform:(int)offsetUniform
+{
+    GLKMatrix4 shaderMatrix;
+    GLKVector4 shaderOffset;
+
+    if (!_shaderColorMatrix)
+        _shaderColorMatrix = [[SPColorMatrix alloc] init];
+
+    if (_enableColorUniform)
+    {
+        // the uniform color is applied before the output matrix: it replaces the RGB values
+        // and multiplies the alpha value.
+        float tint[20] = {
+            0, 0, 0, 0,         _color[0] * 255.0f,
+            0, 0, 0, 0,         _color[1] * 255.0f,
+            0, 0, 0, 0,         _color[2] * 255.0f,
+            0, 0, 0, _color[3], 0
+        };
+
+        memcpy(_shaderColorMatrix.values, tint, sizeof(tint));
+    }
+    else [_shaderColorMatrix identity];
+
+    [_shaderColorMatrix concatColorMatrix:self.outputColorMatrix];
+    [_shaderColorMatrix getShaderMatrix:&shaderMatrix offset:&shaderOffset];
+
+    [program setMatrix4:shaderMatrix.m forUniform:matrixUniform];
+    [program setVector4:shaderOffset.v forUniform:offsetUniform];
+}
+
+- (SPBlurProgram *)colorMatrixProgram
+{
+    if (!_colorMatrixProgram)
+        _colorMatrixProgram = [[SPBlurFilter blurProgramWithOutput:SPBlurOutputColorMatrix] retain];
+
+    return _colorMatrixProgram;
+}
+
+- (SPDualBlurProgram *)colorMatrixUpsampleProgram
+{
+    if (!_colorMatrixUpsampleProgram)
+        _colorMatrixUpsampleProgram =
+            [[SPBlurFilter dualBlurProgramForUpsampling:YES output:SPBlurOutputColorMatrix] retain];
+
+    return _colorMatrixUpsampleProgram;
+}
+
++ (SPBlurProgram *)blurProgramWithOutput:(SPBlurOutput)output
+{
+    NSString *programName = [SPBlurProgram programNameForOutput:output];
+    SPViewController *controller = [Sparrow currentController];
+    SPBlurProgram *program = (SPBlurProgram *)[controller programByName:programName];
+
+    if (!program)
+    {
+        program = [[[SPBlurProgram alloc] initWithOutput:output
+                                            asynchronous:controller.compilesProgramsAsynchronously] autorelease];
+        [controller registerProgram:program name:programName];
+    }
+
+    return program;
+}
+
++ (SPDualBlurProgram *)dualBlurProgramForUpsampling:(BOOL)upsampling output:(SPBlurOutput)output
+{
+    NSString *programName = [SPDualBlurProgram programNameForUpsampling:upsampling output:output];
+    SPViewController *controller = [Sparrow currentController];
+    SPDualBlurProgram *program = (SPDualBlurProgram *)[controller programByName:programName];
+
+    if (!program)
+    {
+        program = [[[SPDualBlurProgram alloc] initWithUpsampling:upsampling output:output
+                                                    asynchronous:controller.compilesProgramsAsynchronously] autorelease];
+        [controller registerProgram:program name:programName];
+    }
+
+    return program;
+}
+
 - (void)updateMarginsAndPasses
 {
     if (_blurX == 0 && _blurY == 0)
         _blurX = 0.001;
 
-    self.numPasses = ceilf(_blurX) + ceilf(_blurY);
-    self.marginX = (3.0f + ceilf(_blurX)) / self.resolution;
-    self.marginY = (3.0f + ceilf(_blurY)) / self.resolution;
+    if (_blurMode == SPBlurModeDownsampled)
+    {
+        // every level doubles the blur radius; the offsets cover the range in between.
+        float blur = MAX(_blurX, _blurY);
+        _numLevels = MIN(MAX_NUM_LEVELS, 1 + (NSInteger)floorf(log2f(MAX(1.0f, blur))));
+        _levelOffsetX = _blurX / (1 << (_numLevels - 1));
+        _levelOffsetY = _blurY / (1 << (_numLevels - 1));
+
+        self.numPasses = 2 * _numLevels;
+        self.marginX = (3.0f + ceilf((2.0f * _levelOffsetX + 1.0f) * (1 << _numLevels))) / self.resolution;
+        self.marginY = (3.0f + ceilf((2.0f * _levelOffsetY + 1.0f) * (1 << _numLevels))) / self.resolution;
+    }
+    else
+    {
+        self.numPasses = ceilf(_blurX) + ceilf(_blurY);
+        self.marginX = (3.0f + ceilf(_blurX)) / self.resolution;
+        self.marginY = (3.0f + ceilf(_blurY)) / self.resolution;
+    }
 }
 
 #pragma mark Drop Shadow
@@ -115,6 +115,7 @@
     _indexData.numIndices = 0;
     [_polygons removeAllObjects];
     [self destroyBuffers];
+    [self setRequiresRedraw];
 }
 
 #pragma mark SPDisplayObject
@@ -139,8 +140,8 @@
         int aColor     = [_program attributeByName:@"aColor"];
         
         glUseProgram(_program.name);
-        glUniformMatrix4fv(uMvpMatrix, 1, 0, support.mvpMatrix3D.rawData);
-        glUniform1f(uAlpha, support.alpha * self.alpha);
+        [_program setMatrix4:support.mvpMatrix3D.rawData forUniform:uMvpMatrix];
+        [_program setFloat:support.alpha * self.alpha forUniform:uAlpha];
         
         glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferName);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferName);
@@ -212,6 +213,7 @@
     
     [_polygons addObject:polygon];
     _syncRequired = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)registerPrograms
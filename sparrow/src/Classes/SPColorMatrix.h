@@ -67,6 +67,10 @@ NS_ASSUME_NONNULL_BEGIN
 /// Concatenates the receiving color matrix with another one.
 - (void)concatColorMatrix:(SPColorMatrix *)colorMatrix;
 
+/// Converts the matrix into the layout expected by shaders: a 4x4 matrix that is multiplied with
+/// the (non-premultiplied) color, and an offset in the range [0, 1] that is added afterwards.
+- (void)getShaderMatrix:(GLKMatrix4 *)matrix offset:(GLKVector4 *)offset;
+
 /// ----------------
 /// @name Properties
 /// ----------------
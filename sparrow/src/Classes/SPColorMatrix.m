@@ -189,6 +189,23 @@ static void concatMatrix(SPColorMatrix *self, Matrix4x5 mtx)
     concatMatrix(self, colorMatrix->_m);
 }
 
+- (void)getShaderMatrix:(GLKMatrix4 *)matrix offset:(GLKVector4 *)offset
+{
+    // the shader needs the matrix components in a different order,
+    // and it needs the offsets in the range 0-1.
+
+    *matrix = (GLKMatrix4){{
+        _m[ 0], _m[ 1], _m[ 2], _m[ 3],
+        _m[ 5], _m[ 6], _m[ 7], _m[ 8],
+        _m[10], _m[11], _m[12], _m[13],
+        _m[15], _m[16], _m[17], _m[18]
+    }};
+
+    *offset = (GLKVector4){{
+        _m[4] / 255.0f, _m[9] / 255.0f, _m[14] / 255.0f, _m[19] / 255.0f
+    }};
+}
+
 #pragma mark NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone
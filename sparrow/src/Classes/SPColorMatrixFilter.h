@@ -35,6 +35,13 @@ NS_ASSUME_NONNULL_BEGIN
  If you want to gradually animate one of the predefined color adjustments, either reset the matrix 
  after each step, or use an identical adjustment value for each step; the changes will add up.
 
+ Since the matrix only works on one pixel at a time, the filter doesn't always need a render
+ texture: quads, quad batches and containers made up of them are drawn directly, with the matrix
+ applied by their shader. That happens if the filter is neither cached nor offset and uses
+ 'SPFragmentFilterModeReplace', and if the matrix leaves the alpha values alone (true for all the
+ adjustments above). Containers with special blend modes or nested filters, and matrices that
+ modify alpha, fall back to the render texture.
+
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPColorMatrixFilter : SPFragmentFilter
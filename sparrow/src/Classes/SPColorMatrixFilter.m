@@ -11,15 +11,47 @@
 
 #import "SparrowClass.h"
 #import "SPColorMatrix.h"
+#import "SPBlendMode.h"
 #import "SPColorMatrixFilter.h"
+#import "SPDisplayObjectContainer.h"
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPNSExtensions.h"
 #import "SPOpenGL.h"
 #import "SPProgram.h"
+#import "SPQuad.h"
+#import "SPQuadBatch.h"
+#import "SPRenderSupport.h"
 
 static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
 
+// --- c functions ---------------------------------------------------------------------------------
+
+static BOOL isComposableBlendMode(uint blendMode)
+{
+    return blendMode == SPBlendModeAuto || blendMode == SPBlendModeNormal || blendMode == SPBlendModeNone;
+}
+
+static BOOL isComposableObject(SPDisplayObject *object, SPFragmentFilter *filter)
+{
+    // Objects that are composed of quads (in normal blend mode) produce the same output whether
+    // the color matrix is applied to the composed texture or to the individual quads -- as long
+    // as the matrix leaves alpha alone. Filters and custom objects might sample other pixels.
+
+    if ((object.filter && object.filter != filter) || !isComposableBlendMode(object.blendMode))
+        return NO;
+    else if ([object isKindOfClass:[SPQuad class]] || [object isKindOfClass:[SPQuadBatch class]])
+        return YES;
+    else if ([object isKindOfClass:[SPDisplayObjectContainer class]])
+    {
+        for (SPDisplayObject *child in (SPDisplayObjectContainer *)object)
+            if (!isComposableObject(child, nil)) return NO;
+
+        return YES;
+    }
+    else return NO;
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPColorMatrixFilter
@@ -32,6 +64,11 @@ static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
     int _uMvpMatrix;
     int _uColorMatrix;
     int _uColorOffset;
+
+    // the last object that was tested for composability; not retained
+    SPDisplayObject *_composableObject;
+    NSUInteger _composableObjectVersion;
+    BOOL _isComposable;
 }
 
 #pragma mark Initialization
@@ -73,48 +110,70 @@ static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
 {
     [_colorMatrix invert];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)adjustSaturation:(float)saturation
 {
     [_colorMatrix adjustSaturation:saturation];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)adjustContrast:(float)contrast
 {
     [_colorMatrix adjustContrast:contrast];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)adjustBrightness:(float)brightness
 {
     [_colorMatrix adjustBrightness:brightness];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)adjustHue:(float)hue
 {
     [_colorMatrix adjustHue:hue];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)reset
 {
     [_colorMatrix identity];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)concatColorMatrix:(SPColorMatrix *)colorMatrix
 {
     [_colorMatrix concatColorMatrix:colorMatrix];
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
 }
 
 - (void)setColorMatrix:(SPColorMatrix *)colorMatrix
 {
     SP_RELEASE_AND_COPY(_colorMatrix, colorMatrix);
     _colorMatrixDirty = YES;
+    [self setRequiresRedraw];
+}
+
+#pragma mark SPFragmentFilter
+
+- (void)renderObject:(SPDisplayObject *)object support:(SPRenderSupport *)support
+{
+    if ([self canRenderDirectly:object support:support])
+    {
+        // the matrix is applied by the base effect while the object's own quads are drawn
+        support.colorMatrix = _colorMatrix;
+        [object render:support];
+        support.colorMatrix = nil;
+    }
+    else [super renderObject:object support:support];
 }
 
 #pragma mark SPFragmentFilter (Subclasses)
@@ -123,23 +182,30 @@ static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
 {
     if (!_shaderProgram)
     {
-        _shaderProgram = [[[Sparrow currentController] programByName:SPColorMatrixProgram] retain];
+        SPViewController *controller = [Sparrow currentController];
+        _shaderProgram = [[controller programByName:SPColorMatrixProgram] retain];
 
         if (!_shaderProgram)
         {
             _shaderProgram = [[SPProgram alloc] initWithVertexShader:[SPFragmentFilter standardVertexShader]
-                                                      fragmentShader:[self fragmentShader]];
+                                                      fragmentShader:[self fragmentShader]
+                                                        asynchronous:controller.compilesProgramsAsynchronously];
 
-            [[Sparrow currentController] registerProgram:_shaderProgram name:SPColorMatrixProgram];
+            [controller registerProgram:_shaderProgram name:SPColorMatrixProgram];
         }
+    }
 
-        self.vertexPosID = [_shaderProgram attributeByName:@"aPosition"];
-        self.texCoordsID = [_shaderProgram attributeByName:@"aTexCoords"];
+    self.vertexPosID = [_shaderProgram attributeByName:@"aPosition"];
+    self.texCoordsID = [_shaderProgram attributeByName:@"aTexCoords"];
 
-        _uColorMatrix   = [_shaderProgram uniformByName:@"uColorMatrix"];
-        _uColorOffset   = [_shaderProgram uniformByName:@"uColorOffset"];
-        _uMvpMatrix     = [_shaderProgram uniformByName:@"uMvpMatrix"];
-    }
+    _uColorMatrix   = [_shaderProgram uniformByName:@"uColorMatrix"];
+    _uColorOffset   = [_shaderProgram uniformByName:@"uColorOffset"];
+    _uMvpMatrix     = [_shaderProgram uniformByName:@"uMvpMatrix"];
+}
+
+- (BOOL)programsReady
+{
+    return _shaderProgram.isReady;
 }
 
 - (void)activateWithPass:(NSInteger)pass texture:(SPTexture *)texture mvpMatrix:(SPMatrix3D *)matrix
@@ -149,13 +215,49 @@ static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
 
     glUseProgram(_shaderProgram.name);
 
-    glUniformMatrix4fv(_uMvpMatrix, 1, false, matrix.rawData);
-    glUniformMatrix4fv(_uColorMatrix, 1, false, _shaderMatrix.m);
-    glUniform4fv(_uColorOffset, 1, _shaderOffset.v);
+    [_shaderProgram setMatrix4:matrix.rawData forUniform:_uMvpMatrix];
+    [_shaderProgram setMatrix4:_shaderMatrix.m forUniform:_uColorMatrix];
+    [_shaderProgram setVector4:_shaderOffset.v forUniform:_uColorOffset];
 }
 
 #pragma mark Private
 
+- (BOOL)canRenderDirectly:(SPDisplayObject *)object support:(SPRenderSupport *)support
+{
+    const float *m = _colorMatrix.values;
+
+    if (self.isCached || self.mode != SPFragmentFilterModeReplace || support.colorMatrix ||
+        self.offsetX != 0.0f || self.offsetY != 0.0f)
+        return NO;
+
+    // empty pixels of the filter texture must stay empty; an alpha offset would fill them
+    if (m[19] != 0.0f)
+        return NO;
+
+    // a single quad never overlaps with itself
+    if ([object isKindOfClass:[SPQuad class]])
+        return YES;
+
+    // otherwise, the alpha values must not be changed, and RGB must not depend on alpha
+    BOOL keepsAlpha = m[3] == 0.0f && m[8] == 0.0f && m[13] == 0.0f &&
+                      m[15] == 0.0f && m[16] == 0.0f && m[17] == 0.0f && m[18] == 1.0f;
+
+    if (!keepsAlpha) return NO;
+
+    // walking the tree each frame is expensive; the result can only change with the object's
+    // version. New objects all start with version 0, so that one can't be told apart.
+    NSUInteger changeVersion = object.changeVersion;
+
+    if (object != _composableObject || changeVersion != _composableObjectVersion || !changeVersion)
+    {
+        _composableObject = object;
+        _composableObjectVersion = changeVersion;
+        _isComposable = isComposableObject(object, self);
+    }
+
+    return _isComposable;
+}
+
 - (NSString *)fragmentShader
 {
     NSMutableString *source = [NSMutableString string];
@@ -185,22 +287,7 @@ static NSString *const SPColorMatrixProgram = @"SPColorMatrixProgram";
 
 - (void)updateShaderMatrix
 {
-    // the shader needs the matrix components in a different order,
-    // and it needs the offsets in the range 0-1.
-
-    const float *matrix = _colorMatrix.values;
-
-    _shaderMatrix = (GLKMatrix4){{
-        matrix[ 0], matrix[ 1], matrix[ 2], matrix[ 3],
-        matrix[ 5], matrix[ 6], matrix[ 7], matrix[ 8],
-        matrix[10], matrix[11], matrix[12], matrix[13],
-        matrix[15], matrix[16], matrix[17], matrix[18]
-    }};
-
-    _shaderOffset = (GLKVector4){{
-        matrix[4] / 255.0f, matrix[9] / 255.0f, matrix[14] / 255.0f, matrix[19] / 255.0f
-    }};
-
+    [_colorMatrix getShaderMatrix:&_shaderMatrix offset:&_shaderOffset];
     _colorMatrixDirty = NO;
 }
 
@@ -105,6 +105,31 @@ typedef NS_ENUM(NSInteger, SPRenderingAPI)
 /// Makes the receiver the current current rendering context.
 - (BOOL)makeCurrentContext;
 
+/// Returns a render target with the given size (in pixels) from the context's pool of unused
+/// render targets, or creates a new one if there is none with that size. Its contents are
+/// undefined. Hand it back via `returnRenderTarget:` as soon as you don't need it any longer;
+/// typically, that's within the same frame.
+- (SPGLTexture *)borrowRenderTargetWithNativeWidth:(NSInteger)width nativeHeight:(NSInteger)height
+                                             scale:(float)scale premultipliedAlpha:(BOOL)pma;
+
+/// Moves a render target that was acquired via `borrowRenderTargetWithNativeWidth:...` back into
+/// the pool, where other objects can reuse it.
+- (void)returnRenderTarget:(SPGLTexture *)renderTarget;
+
+/// Disposes all render targets of the pool that have not been borrowed during the last
+/// `maxIdleRenderTargetFrames` frames. Each call counts as one frame; `SPViewController` calls it
+/// once after presenting each frame.
+- (void)evictIdleRenderTargets;
+
+/// Disposes all render targets that are currently in the pool.
+- (void)purgeRenderTargetPool;
+
+/// Returns the size (in pixels) of a render target that can hold the given number of pixels:
+/// the next power of two if the context doesn't support other sizes, otherwise the size rounded
+/// up to a multiple of `alignment`. Rounding up lets slightly different sizes share pooled
+/// render targets.
+- (NSInteger)renderTargetSizeForNativeSize:(NSInteger)size alignment:(NSInteger)alignment;
+
 /// Returns the current rendering context for the calling thread.
 + (nullable SPContext *)currentContext;
 
@@ -134,6 +159,18 @@ typedef NS_ENUM(NSInteger, SPRenderingAPI)
 /// depend on the lifetime of the context.
 @property (nonatomic, readonly) SP_GENERIC(NSMutableDictionary, id, id) *data;
 
+/// The number of frames an unused render target is kept in the pool before it is disposed.
+/// (Default: 60)
+@property (nonatomic, assign) NSInteger maxIdleRenderTargetFrames;
+
+/// The number of render targets that are currently in the pool, waiting to be borrowed.
+@property (nonatomic, readonly) NSInteger numPooledRenderTargets;
+
+/// Indicates if render targets may have sizes that are not powers of two. That's the case with
+/// OpenGL ES 3 and on practically all OpenGL ES 2 devices; the context must be current when this
+/// property is first accessed.
+@property (nonatomic, readonly) BOOL supportsNonPowerOfTwoRenderTargets;
+
 /// YES if OpenGL ES should defers work to another thread (default: NO).
 /// WARNING: Do not use, currently there is a bug in Apple's code that causes a leak. This is for
 /// internal use only.
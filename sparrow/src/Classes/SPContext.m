@@ -21,6 +21,7 @@
 #import "SPRenderTexture.h"
 #import "SPSubTexture.h"
 #import "SPTexture.h"
+#import "SPUtils.h"
 
 #import <objc/runtime.h>
 #import <GLKit/GLKit.h>
@@ -44,6 +45,33 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     SPRenderingAPIOpenGLES3,
 };
 
+#define DEFAULT_MAX_IDLE_RENDER_TARGET_FRAMES 60
+
+// --- pooled render target ------------------------------------------------------------------------
+
+@interface SPPooledRenderTarget : NSObject
+@end
+
+@implementation SPPooledRenderTarget
+{
+  @package
+    SPGLTexture *_texture;
+    NSInteger _returnFrame;
+}
+
+- (void)dealloc
+{
+    [_texture release];
+    [super dealloc];
+}
+
+@end
+
+SP_INLINE NSNumber *renderTargetBucket(NSInteger width, NSInteger height)
+{
+    return @(((uint64_t)width << 32) | (uint32_t)height);
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPContext
@@ -57,6 +85,14 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     SP_GENERIC(NSMapTable, SPTexture*, SPFrameBuffer*) *_frameBuffers;
     SPFrameBuffer *_backBuffer;
     CGRect _prevDrawableRect;
+    
+    SP_GENERIC(NSMutableDictionary, NSNumber*, NSMutableArray*) *_renderTargetPool;
+    NSInteger _numPooledRenderTargets;
+    NSInteger _maxIdleRenderTargetFrames;
+    NSInteger _frameID;
+    
+    BOOL _npotSupportChecked;
+    BOOL _supportsNonPowerOfTwoRenderTargets;
 }
 
 + (void)initialize
@@ -104,6 +140,8 @@ static SPRenderingAPI toSPRenderingAPI[] = {
         NSPointerFunctionsOptions keyOptions = NSMapTableWeakMemory | NSMapTableObjectPointerPersonality;
         _frameBuffers = [[NSMapTable alloc] initWithKeyOptions:keyOptions valueOptions:NSMapTableStrongMemory capacity:8];
         _data = [[NSMutableDictionary alloc] init];
+        _renderTargetPool = [[NSMutableDictionary alloc] init];
+        _maxIdleRenderTargetFrames = DEFAULT_MAX_IDLE_RENDER_TARGET_FRAMES;
     }
     
     return self;
@@ -139,6 +177,7 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     [_frameBuffers release];
     [_nativeContext release];
     [_renderTexture release];
+    [_renderTargetPool release];
     [_data release];
     
     [super dealloc];
@@ -318,6 +357,103 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     }
 }
 
+#pragma mark Render Target Pool
+
+- (SPGLTexture *)borrowRenderTargetWithNativeWidth:(NSInteger)width nativeHeight:(NSInteger)height
+                                             scale:(float)scale premultipliedAlpha:(BOOL)pma
+{
+    NSMutableArray *bucket = _renderTargetPool[renderTargetBucket(width, height)];
+    
+    // the most recently returned target is the most likely to still be in the GPU's caches
+    for (NSInteger i=bucket.count-1; i>=0; --i)
+    {
+        SPPooledRenderTarget *entry = bucket[i];
+        SPGLTexture *texture = entry->_texture;
+        
+        if (texture.premultipliedAlpha == pma && SPIsFloatEqual(texture.scale, scale))
+        {
+            [[texture retain] autorelease];
+            [bucket removeObjectAtIndex:i];
+            --_numPooledRenderTargets;
+            return texture;
+        }
+    }
+    
+    SPTextureProperties properties = {
+        .format = SPTextureFormatRGBA,
+        .scale  = scale,
+        .width  = width,
+        .height = height,
+        .numMipmaps = 0,
+        .generateMipmaps = NO,
+        .premultipliedAlpha = pma
+    };
+    
+    return [[[SPGLTexture alloc] initWithData:NULL properties:properties] autorelease];
+}
+
+- (void)returnRenderTarget:(SPGLTexture *)renderTarget
+{
+    if (!renderTarget) return;
+    
+    NSNumber *key = renderTargetBucket(renderTarget.nativeWidth, renderTarget.nativeHeight);
+    NSMutableArray *bucket = _renderTargetPool[key];
+    
+    if (!bucket)
+    {
+        bucket = [NSMutableArray array];
+        _renderTargetPool[key] = bucket;
+    }
+    
+    SPPooledRenderTarget *entry = [[SPPooledRenderTarget alloc] init];
+    entry->_texture = [renderTarget retain];
+    entry->_returnFrame = _frameID;
+    
+    [bucket addObject:entry];
+    [entry release];
+    
+    ++_numPooledRenderTargets;
+}
+
+- (void)evictIdleRenderTargets
+{
+    ++_frameID;
+    
+    if (_numPooledRenderTargets == 0) return;
+    
+    for (NSMutableArray *bucket in _renderTargetPool.allValues)
+    {
+        // entries are sorted by return frame, so the idle ones are at the beginning
+        NSInteger numIdle = 0;
+        for (SPPooledRenderTarget *entry in bucket)
+        {
+            if (_frameID - entry->_returnFrame > _maxIdleRenderTargetFrames) ++numIdle;
+            else break;
+        }
+        
+        if (numIdle)
+        {
+            [bucket removeObjectsInRange:NSMakeRange(0, numIdle)];
+            _numPooledRenderTargets -= numIdle;
+        }
+    }
+}
+
+- (void)purgeRenderTargetPool
+{
+    [_renderTargetPool removeAllObjects];
+    _numPooledRenderTargets = 0;
+}
+
+- (NSInteger)renderTargetSizeForNativeSize:(NSInteger)size alignment:(NSInteger)alignment
+{
+    size = MAX(1, size);
+    
+    if (!self.supportsNonPowerOfTwoRenderTargets) return [SPUtils nextPowerOfTwo:size];
+    else if (alignment > 1) return ((size + alignment - 1) / alignment) * alignment;
+    else return size;
+}
+
 #pragma mark EAGLContext
 
 - (BOOL)makeCurrentContext
@@ -370,6 +506,28 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     return _backBuffer.height;
 }
 
+- (BOOL)supportsNonPowerOfTwoRenderTargets
+{
+    if (!_npotSupportChecked)
+    {
+        // ES 3 supports them in general; on ES 2, they are restricted to textures without
+        // mipmaps that don't repeat -- which is just what a render target needs.
+        if (_API == SPRenderingAPIOpenGLES3)
+            _supportsNonPowerOfTwoRenderTargets = YES;
+        else
+        {
+            const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+            _supportsNonPowerOfTwoRenderTargets = extensions &&
+                (strstr(extensions, "GL_APPLE_texture_2D_limited_npot") ||
+                 strstr(extensions, "GL_OES_texture_npot"));
+        }
+        
+        _npotSupportChecked = YES;
+    }
+    
+    return _supportsNonPowerOfTwoRenderTargets;
+}
+
 - (BOOL)multiThreaded
 {
     if ([_nativeContext respondsToSelector:@selector(multiThreaded)])
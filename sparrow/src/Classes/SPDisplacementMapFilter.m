@@ -11,6 +11,7 @@
 
 #import "SparrowClass.h"
 #import "SPDisplacementMapFilter.h"
+#import "SPMacros.h"
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPNSExtensions.h"
@@ -93,26 +94,33 @@ static NSString *const SPDisplacementMapFilterProgram = @"SPDisplacementMapFilte
 {
     if (!_shaderProgram)
     {
-        _shaderProgram = [[[Sparrow currentController] programByName:SPDisplacementMapFilterProgram] retain];
+        SPViewController *controller = [Sparrow currentController];
+        _shaderProgram = [[controller programByName:SPDisplacementMapFilterProgram] retain];
 
         if (!_shaderProgram)
         {
             NSString *vertexShader = [self vertexShader];
             NSString *fragmentShader = [self fragmentShader];
 
-            _shaderProgram = [[SPProgram alloc] initWithVertexShader:vertexShader fragmentShader:fragmentShader];
-            [[Sparrow currentController] registerProgram:_shaderProgram name:SPDisplacementMapFilterProgram];
+            _shaderProgram = [[SPProgram alloc] initWithVertexShader:vertexShader fragmentShader:fragmentShader
+                                                        asynchronous:controller.compilesProgramsAsynchronously];
+            [controller registerProgram:_shaderProgram name:SPDisplacementMapFilterProgram];
         }
+    }
 
-        self.vertexPosID = [_shaderProgram attributeByName:@"aPosition"];
-        self.texCoordsID = [_shaderProgram attributeByName:@"aTexCoords"];
-        _aMapTexCoords   = [_shaderProgram attributeByName:@"aMapTexCoords"];
+    self.vertexPosID = [_shaderProgram attributeByName:@"aPosition"];
+    self.texCoordsID = [_shaderProgram attributeByName:@"aTexCoords"];
+    _aMapTexCoords   = [_shaderProgram attributeByName:@"aMapTexCoords"];
 
-        _uTexture       = [_shaderProgram uniformByName:@"uTexture"];
-        _uMapTexture    = [_shaderProgram uniformByName:@"uMapTexture"];
-        _uMvpMatrix     = [_shaderProgram uniformByName:@"uMvpMatrix"];
-        _uMapMatrix     = [_shaderProgram uniformByName:@"uMapMatrix"];
-    }
+    _uTexture       = [_shaderProgram uniformByName:@"uTexture"];
+    _uMapTexture    = [_shaderProgram uniformByName:@"uMapTexture"];
+    _uMvpMatrix     = [_shaderProgram uniformByName:@"uMvpMatrix"];
+    _uMapMatrix     = [_shaderProgram uniformByName:@"uMapMatrix"];
+}
+
+- (BOOL)programsReady
+{
+    return _shaderProgram.isReady;
 }
 
 - (void)activateWithPass:(NSInteger)pass texture:(SPTexture *)texture mvpMatrix:(SPMatrix3D *)matrix
@@ -131,10 +139,10 @@ static NSString *const SPDisplacementMapFilterProgram = @"SPDisplacementMapFilte
     glVertexAttribPointer(_aMapTexCoords, 2, GL_FLOAT, false, 0, 0);
 
     glUseProgram(_shaderProgram.name);
-    glUniform1i(_uTexture, 0);
-    glUniform1i(_uMapTexture, 1);
-    glUniformMatrix4fv(_uMvpMatrix, 1, false, matrix.rawData);
-    glUniformMatrix4fv(_uMapMatrix, 1, false, _mapMatrix.m);
+    [_shaderProgram setInt:0 forUniform:_uTexture];
+    [_shaderProgram setInt:1 forUniform:_uMapTexture];
+    [_shaderProgram setMatrix4:matrix.rawData forUniform:_uMvpMatrix];
+    [_shaderProgram setMatrix4:_mapMatrix.m forUniform:_uMapMatrix];
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, _mapTexture.name);
@@ -160,6 +168,47 @@ static NSString *const SPDisplacementMapFilterProgram = @"SPDisplacementMapFilte
 {
     if (mapPoint) [_mapPoint copyFromPoint:mapPoint];
     else          [_mapPoint setX:0 y:0];
+
+    [self setRequiresRedraw];
+}
+
+- (void)setMapTexture:(SPTexture *)mapTexture
+{
+    if (mapTexture != _mapTexture)
+    {
+        SP_RELEASE_AND_RETAIN(_mapTexture, mapTexture);
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setComponentX:(SPColorChannel)componentX
+{
+    _componentX = componentX;
+    [self setRequiresRedraw];
+}
+
+- (void)setComponentY:(SPColorChannel)componentY
+{
+    _componentY = componentY;
+    [self setRequiresRedraw];
+}
+
+- (void)setScaleX:(float)scaleX
+{
+    _scaleX = scaleX;
+    [self setRequiresRedraw];
+}
+
+- (void)setScaleY:(float)scaleY
+{
+    _scaleY = scaleY;
+    [self setRequiresRedraw];
+}
+
+- (void)setRepeat:(BOOL)repeat
+{
+    _repeat = repeat;
+    [self setRequiresRedraw];
 }
 
 #pragma mark Private
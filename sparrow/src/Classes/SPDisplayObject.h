@@ -144,6 +144,13 @@ NS_ASSUME_NONNULL_BEGIN
 /// Creates an event and dispatches it on all children (recursively).
 - (void)broadcastEventWithType:(NSString *)type;
 
+/// Marks the object (and thus its parents) as changed, so that filters that cache their output
+/// (see `SPFragmentFilter autoCache`) draw it again. Sparrow calls this method whenever you modify
+/// a property that affects the object's appearance; call it manually only if you change it in a
+/// way Sparrow can't notice, e.g. by modifying the contents of a texture the object displays.
+/// (Images showing a render texture are notified automatically when it is drawn into.)
+- (void)setRequiresRedraw;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -197,6 +204,11 @@ NS_ASSUME_NONNULL_BEGIN
 /// The bounds of the object relative to the local coordinates of the parent.
 @property (nonatomic, readonly) SPRectangle *bounds;
 
+/// A number that changes whenever the appearance of the object or one of its children changes.
+/// Changing the object's own transformation (e.g. its position) doesn't change its version, but
+/// that of its parent. Changes of a mask change the version of the object it was assigned to.
+@property (nonatomic, readonly) NSUInteger changeVersion;
+
 /// The display object container that contains this display object.
 @property (weak, nonatomic, readonly, nullable) SPDisplayObjectContainer *parent;
 
@@ -43,6 +43,7 @@
     BOOL _touchable;
     BOOL _orientationChanged;
     BOOL _is3D;
+    NSUInteger _changeVersion;
     
     SPDisplayObjectContainer *__weak _parent;
     SPMatrix *_transformationMatrix;
@@ -51,11 +52,14 @@
     id _physicsBody;
     
     SPDisplayObject *_mask;
+    SPDisplayObject *_maskOwner; // the object this one was assigned to as mask (not retained)
     BOOL _isMask;
 }
 
 // --- helpers -------------------------------------------------------------------------------------
 
+static NSUInteger currentChangeVersion = 0;
+
 static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObject *object2)
 {
     // This method is used very often during touch testing, so we optimized the code.
@@ -119,6 +123,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     [_filter release];
     [_physicsBody release];
     [_transformationMatrix release];
+    if (_mask && _mask->_maskOwner == self) _mask->_maskOwner = nil;
     [_mask release];
     [super dealloc];
 }
@@ -135,6 +140,13 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     [_parent removeChild:self];
 }
 
+- (void)setRequiresRedraw
+{
+    // the new version is unique, so filters that compare it can't miss a change; text fields
+    // create their contents in a background queue, so it's incremented atomically.
+    [self updateChangeVersion:__sync_add_and_fetch(&currentChangeVersion, 1)];
+}
+
 - (void)alignPivotToCenter
 {
     [self alignPivotX:SPHAlignCenter pivotY:SPVAlignCenter];
@@ -144,6 +156,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     SPRectangle* bounds = [self boundsInSpace:self];
     _orientationChanged = YES;
+    [self transformationDidChange];
 
     switch (hAlign)
     {
@@ -420,6 +433,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     object.name = self.name;
     object.filter = self.filter;
     object.mask = self.mask;
+    if (_mask) _mask->_maskOwner = self; // the copy must not take over the mask's notifications
     object.blendMode = self.blendMode;
     object.physicsBody = self.physicsBody;
     
@@ -481,6 +495,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _x = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -490,6 +505,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _y = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -507,6 +523,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _scaleX = _scaleY = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -516,6 +533,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _scaleX = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -525,6 +543,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _scaleY = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -534,6 +553,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _skewX = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -543,6 +563,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _skewY = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -552,6 +573,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _pivotX = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -561,6 +583,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     {
         _pivotY = value;
         _orientationChanged = YES;
+        [self transformationDidChange];
     }
 }
 
@@ -602,11 +625,45 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     
     _rotation = value;
     _orientationChanged = YES;
+    [self transformationDidChange];
 }
 
 - (void)setAlpha:(float)value
 {
-    _alpha = SP_CLAMP(value, 0.0f, 1.0f);
+    value = SP_CLAMP(value, 0.0f, 1.0f);
+    
+    if (value != _alpha)
+    {
+        _alpha = value;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setVisible:(BOOL)value
+{
+    if (value != _visible)
+    {
+        _visible = value;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setBlendMode:(uint)value
+{
+    if (value != _blendMode)
+    {
+        _blendMode = value;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setFilter:(SPFragmentFilter *)value
+{
+    if (value != _filter)
+    {
+        SP_RELEASE_AND_RETAIN(_filter, value);
+        [self setRequiresRedraw];
+    }
 }
 
 - (SPRectangle *)bounds
@@ -704,6 +761,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 
     _orientationChanged = NO;
     [_transformationMatrix copyFromMatrix:matrix];
+    [self transformationDidChange];
     
     _pivotX = 0.0f;
     _pivotY = 0.0f;
@@ -736,10 +794,20 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (_mask != value)
     {
-        if (_mask) _mask->_isMask = NO;
-        if (value) value->_isMask = YES;
+        if (_mask)
+        {
+            _mask->_isMask = NO;
+            if (_mask->_maskOwner == self) _mask->_maskOwner = nil;
+        }
+        
+        if (value)
+        {
+            value->_isMask = YES;
+            value->_maskOwner = self;
+        }
         
         SP_RELEASE_AND_RETAIN(_mask, value);
+        [self setRequiresRedraw];
     }
 }
 
@@ -748,6 +816,31 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     return _alpha != 0.0f && _visible && _scaleX != 0.0f && _scaleY != 0.0f;
 }
 
+#pragma mark Private
+
+- (void)updateChangeVersion:(NSUInteger)changeVersion
+{
+    for (SPDisplayObject *currentObject = self; currentObject; currentObject = currentObject->_parent)
+    {
+        currentObject->_changeVersion = changeVersion;
+        
+        // a mask (which is usually not part of the display list) changes the object it masks
+        [currentObject->_maskOwner updateChangeVersion:changeVersion];
+    }
+}
+
+- (void)transformationDidChange
+{
+    // the object's own version is not affected by its transformation, only those of its parent
+    // and of the object it masks
+    if (_parent || _maskOwner)
+    {
+        NSUInteger changeVersion = __sync_add_and_fetch(&currentChangeVersion, 1);
+        [_parent updateChangeVersion:changeVersion];
+        [_maskOwner updateChangeVersion:changeVersion];
+    }
+}
+
 @end
 
 // -------------------------------------------------------------------------------------------------
@@ -764,7 +857,11 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
         [NSException raise:SPExceptionInvalidOperation 
                     format:@"An object cannot be added as a child to itself or one of its children"];
     else
+    {
+        [_parent setRequiresRedraw];
         _parent = parent; // only assigned, not retained (to avoid a circular reference).
+        [_parent setRequiresRedraw];
+    }
 }
 
 - (void)setIs3D:(BOOL)is3D
@@ -772,4 +869,9 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     _is3D = is3D;
 }
 
+- (BOOL)isMask
+{
+    return _isMask;
+}
+
 @end
@@ -142,6 +142,7 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
         [_children removeObjectAtIndex:oldIndex];
         [_children insertObject:child atIndex:MIN(_children.count, index)];
         [child release];
+        [self setRequiresRedraw];
     }
 }
 
@@ -183,12 +184,16 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
         [NSException raise:SPExceptionInvalidOperation format:@"invalid child indices"];
     
     [_children exchangeObjectAtIndex:index1 withObjectAtIndex:index2];
+    [self setRequiresRedraw];
 }
 
 - (void)sortChildren:(NSComparator)comparator
 {
     if ([_children respondsToSelector:@selector(sortWithOptions:usingComparator:)])
+    {
         [_children sortWithOptions:NSSortStable usingComparator:comparator];
+        [self setRequiresRedraw];
+    }
     else
         [NSException raise:SPExceptionInvalidOperation 
                     format:@"sortChildren is only available in iOS 4 and above"];
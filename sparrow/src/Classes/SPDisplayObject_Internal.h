@@ -17,6 +17,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)setParent:(nullable SPDisplayObjectContainer *)parent;
 - (void)setIs3D:(BOOL)is3D;
+- (BOOL)isMask;
 
 @end
 
@@ -0,0 +1,90 @@
+//
+//  SPDistanceFieldStyle.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPDistanceFieldStyle describes how a texture that contains a signed distance field is rendered.
+
+ Instead of colors, each texel of such a texture stores the distance to the nearest edge of a
+ shape: values above the threshold (typically 0.5) are inside, values below are outside. Since
+ the distances are interpolated when the texture is scaled, the edges stay sharp at any scale;
+ that's why a single distance field font can be used for all font sizes.
+
+ Single-channel distance fields store the distance in the alpha channel. Multi-channel distance
+ fields (MSDF) use the red, green and blue channels, which preserves sharp corners even at low
+ texture resolutions; set `multiChannel` for those.
+
+ The style can add an outline and a drop shadow to the shapes; both are rendered in the same
+ pass as the shape itself. Assign the style to an SPQuadBatch (or use it with a distance field
+ bitmap font) -- batches with equal styles can still be combined.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPDistanceFieldStyle : NSObject <NSCopying>
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a style without outline and shadow. _Designated Initializer_.
+- (instancetype)init;
+
+/// Factory method.
++ (instancetype)style;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Indicates if both styles have the same settings.
+- (BOOL)isEqualToStyle:(nullable SPDistanceFieldStyle *)style;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// Indicates if the distance is stored in the RGB channels (MSDF) instead of the alpha channel.
+/// Default: NO
+@property (nonatomic, assign) BOOL multiChannel;
+
+/// The distance value that marks the edge of the shape, between 0 and 1. Default: 0.5
+@property (nonatomic, assign) float threshold;
+
+/// The width of the anti-aliased edge, in pixels on the screen. Default: 1
+@property (nonatomic, assign) float softness;
+
+/// The color of the outline. Default: black
+@property (nonatomic, assign) uint outlineColor;
+
+/// The width of the outline, in the units of the distance field (i.e. it's limited by the spread
+/// the field was created with; a value of 0.5 reaches to the border of the field). Zero disables
+/// the outline. Default: 0
+@property (nonatomic, assign) float outlineWidth;
+
+/// The color of the drop shadow. Default: black
+@property (nonatomic, assign) uint shadowColor;
+
+/// The opacity of the drop shadow. Zero disables the shadow. Default: 0
+@property (nonatomic, assign) float shadowAlpha;
+
+/// The horizontal offset of the drop shadow, in points of the texture. Default: 2
+@property (nonatomic, assign) float shadowOffsetX;
+
+/// The vertical offset of the drop shadow, in points of the texture. Default: 2
+@property (nonatomic, assign) float shadowOffsetY;
+
+@end
+
+NS_ASSUME_NONNULL_END
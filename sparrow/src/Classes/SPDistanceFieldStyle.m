@@ -0,0 +1,89 @@
+//
+//  SPDistanceFieldStyle.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPDistanceFieldStyle.h"
+
+@implementation SPDistanceFieldStyle
+
+#pragma mark Initialization
+
+- (instancetype)init
+{
+    if ((self = [super init]))
+    {
+        _threshold = 0.5f;
+        _softness = 1.0f;
+        _shadowOffsetX = 2.0f;
+        _shadowOffsetY = 2.0f;
+    }
+    return self;
+}
+
++ (instancetype)style
+{
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark Methods
+
+- (BOOL)isEqualToStyle:(SPDistanceFieldStyle *)style
+{
+    if (style == self) return YES;
+    else if (!style) return NO;
+    else
+    {
+        return _multiChannel == style->_multiChannel &&
+               _threshold == style->_threshold && _softness == style->_softness &&
+               _outlineColor == style->_outlineColor && _outlineWidth == style->_outlineWidth &&
+               _shadowColor == style->_shadowColor && _shadowAlpha == style->_shadowAlpha &&
+               _shadowOffsetX == style->_shadowOffsetX && _shadowOffsetY == style->_shadowOffsetY;
+    }
+}
+
+#pragma mark NSObject
+
+- (BOOL)isEqual:(id)object
+{
+    if (!object) return NO;
+    else if (object == self) return YES;
+    else if (![object isKindOfClass:[SPDistanceFieldStyle class]]) return NO;
+    else return [self isEqualToStyle:object];
+}
+
+- (NSUInteger)hash
+{
+    return _multiChannel ^ _outlineColor ^ _shadowColor ^ (NSUInteger)(_outlineWidth * 1000.0f);
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"[SPDistanceFieldStyle: multiChannel=%d, threshold=%f, "
+            "outlineWidth=%f, shadowAlpha=%f]", _multiChannel, _threshold, _outlineWidth, _shadowAlpha];
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+    SPDistanceFieldStyle *style = [[[self class] allocWithZone:zone] init];
+    style->_multiChannel = _multiChannel;
+    style->_threshold = _threshold;
+    style->_softness = _softness;
+    style->_outlineColor = _outlineColor;
+    style->_outlineWidth = _outlineWidth;
+    style->_shadowColor = _shadowColor;
+    style->_shadowAlpha = _shadowAlpha;
+    style->_shadowOffsetX = _shadowOffsetX;
+    style->_shadowOffsetY = _shadowOffsetY;
+    return style;
+}
+
+@end
@@ -0,0 +1,116 @@
+//
+//  SPDynamicAtlas.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPSubTexture;
+@class SPTexture;
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPDynamicAtlas combines textures that are created at runtime on a few shared pages, just like
+ a texture atlas does it for textures that are known in advance.
+
+ Each texture that is loaded on its own (or each render texture) has a GL texture of its own;
+ whenever images with different textures are rendered one after the other, the batching is
+ interrupted. Copy such textures into a dynamic atlas, and images that display them can be
+ batched together -- e.g. user avatars or downloaded icons:
+
+	[SPTexture loadFromURL:avatarURL onComplete:^(SPTexture *texture, NSError *error)
+	 {
+	     if (texture) avatar.texture = [atlas addTexture:texture name:userID];
+	 }];
+
+ The original texture is not needed afterwards; the atlas draws it onto one of its pages (render
+ textures with the content scale factor of the stage) and returns a subtexture of that page. The
+ space on the pages is distributed by an SPRectanglePacker; when no page has enough room left,
+ a new one is added.
+
+ When a texture is removed, its area can be reused by other textures. If many textures come and
+ go, the free space fragments; call `defragment` to pack the remaining textures anew. That
+ creates new pages and subtextures: images that still display an old subtexture keep their
+ (old) page alive, so assign them the new textures from `textureByName:` afterwards. Pages on
+ which no texture moved are kept as they are, along with their subtextures.
+
+ Textures that need to be repeated or need mipmaps are not suited for an atlas; neither are
+ textures that are bigger than a page.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPDynamicAtlas : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes an empty atlas with the size of its pages (in points). _Designated Initializer_.
+- (instancetype)initWithPageWidth:(float)width height:(float)height;
+
+/// Initializes an empty atlas with pages of 512x512 points.
+- (instancetype)init;
+
+/// Factory method.
++ (instancetype)atlasWithPageWidth:(float)width height:(float)height;
+
+/// Factory method.
++ (instancetype)atlas;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Draws a texture onto a page of the atlas and returns the subtexture that represents it. A
+/// texture that was added with the same name before is removed, and its area can be used by the
+/// new one; passing the subtexture that is already stored under that name returns it unchanged.
+/// Raises an exception if the texture is bigger than a page.
+- (SPSubTexture *)addTexture:(SPTexture *)texture name:(NSString *)name;
+
+/// Returns the subtexture with a certain name, or `nil` if it's not part of the atlas.
+- (nullable SPSubTexture *)textureByName:(NSString *)name;
+
+/// Removes a texture from the atlas, freeing its area on the page.
+- (void)removeTextureByName:(NSString *)name;
+
+/// Removes all textures and pages.
+- (void)removeAllTextures;
+
+/// Packs all textures anew, largest first, onto as few pages as possible. Afterwards,
+/// `textureByName:` returns new subtextures for all textures on pages that had to be redrawn.
+- (void)defragment;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The width of each page, in points.
+@property (nonatomic, readonly) float pageWidth;
+
+/// The height of each page, in points.
+@property (nonatomic, readonly) float pageHeight;
+
+/// The number of pages the textures are distributed on.
+@property (nonatomic, readonly) NSInteger numPages;
+
+/// The number of textures in the atlas.
+@property (nonatomic, readonly) NSInteger numTextures;
+
+/// The names of all textures in the atlas, sorted alphabetically.
+@property (nonatomic, readonly) SP_GENERIC(NSArray, NSString*) *names;
+
+/// The ratio of the area used by textures to the area of all pages, between 0 and 1.
+/// A low value indicates that `defragment` could save memory.
+@property (nonatomic, readonly) float occupancy;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,330 @@
+//
+//  SPDynamicAtlas.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBlendMode.h"
+#import "SPDynamicAtlas.h"
+#import "SPImage.h"
+#import "SPMacros.h"
+#import "SPQuad.h"
+#import "SPRectangle.h"
+#import "SPRectanglePacker.h"
+#import "SPRenderTexture.h"
+#import "SPSubTexture.h"
+
+#define DEFAULT_PAGE_SIZE 512.0f
+
+// the empty border right and below each texture, so that neighbours don't bleed into each other
+// when the textures are filtered.
+#define PADDING 1.0f
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static float getSlotSize(float textureSize, float pageSize)
+{
+    return MIN(ceilf(textureSize) + PADDING, pageSize);
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPDynamicAtlas
+{
+    float _pageWidth;
+    float _pageHeight;
+    SP_GENERIC(NSMutableArray, SPRenderTexture*) *_pages;
+    SP_GENERIC(NSMutableArray, SPRectanglePacker*) *_packers;
+    SP_GENERIC(NSMutableDictionary, NSString*, SPSubTexture*) *_textures;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithPageWidth:(float)width height:(float)height
+{
+    if ((self = [super init]))
+    {
+        _pageWidth = width;
+        _pageHeight = height;
+        _pages = [[NSMutableArray alloc] init];
+        _packers = [[NSMutableArray alloc] init];
+        _textures = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithPageWidth:DEFAULT_PAGE_SIZE height:DEFAULT_PAGE_SIZE];
+}
+
+- (void)dealloc
+{
+    [_pages release];
+    [_packers release];
+    [_textures release];
+    [super dealloc];
+}
+
++ (instancetype)atlasWithPageWidth:(float)width height:(float)height
+{
+    return [[[self alloc] initWithPageWidth:width height:height] autorelease];
+}
+
++ (instancetype)atlas
+{
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark Methods
+
+- (SPSubTexture *)addTexture:(SPTexture *)texture name:(NSString *)name
+{
+    if (texture.width > _pageWidth || texture.height > _pageHeight)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"Texture '%@' is bigger than the pages of the atlas", name];
+
+    SPSubTexture *oldTexture = _textures[name];
+    if (oldTexture == texture) return oldTexture;
+
+    // the area of a previous texture with that name can be reused right away -- unless the new
+    // texture is on one of the pages, too; then it might just be copied from that very area.
+    BOOL isOnPage = [self isTextureOnPage:texture];
+    if (oldTexture && !isOnPage) [self removeTextureByName:name];
+
+    NSInteger pageIndex = 0;
+    SPRectangle *slot = [self allocateSlotWithWidth:getSlotSize(texture.width, _pageWidth)
+                                             height:getSlotSize(texture.height, _pageHeight)
+                                          inPackers:_packers pageIndex:&pageIndex];
+
+    if (pageIndex == _pages.count)
+        [_pages addObject:[self createPage]];
+
+    SPRenderTexture *page = _pages[pageIndex];
+    SPImage *image = [SPImage imageWithTexture:texture];
+    image.x = slot.x;
+    image.y = slot.y;
+    [page drawObject:image];
+
+    if (oldTexture && isOnPage) [self removeTextureByName:name];
+
+    SPRectangle *region = [SPRectangle rectangleWithX:slot.x y:slot.y
+                                                width:texture.width height:texture.height];
+    SPSubTexture *subTexture = [SPSubTexture textureWithRegion:region ofTexture:page];
+    _textures[name] = subTexture;
+
+    return subTexture;
+}
+
+- (SPSubTexture *)textureByName:(NSString *)name
+{
+    return _textures[name];
+}
+
+- (void)removeTextureByName:(NSString *)name
+{
+    SPSubTexture *subTexture = _textures[name];
+    if (!subTexture) return;
+
+    NSInteger pageIndex = [_pages indexOfObjectIdenticalTo:subTexture.parent];
+    if (pageIndex != NSNotFound)
+    {
+        SPRectangle *slot = [self slotOfTexture:subTexture];
+        [_packers[pageIndex] freeRectangle:slot];
+
+        // the next texture in this area must not show any remains at its transparent pixels
+        SPQuad *eraser = [SPQuad quadWithWidth:slot.width height:slot.height];
+        eraser.x = slot.x;
+        eraser.y = slot.y;
+        eraser.blendMode = SPBlendModeErase;
+        [_pages[pageIndex] drawObject:eraser];
+    }
+
+    [_textures removeObjectForKey:name];
+}
+
+- (void)removeAllTextures
+{
+    [_textures removeAllObjects];
+    [_pages removeAllObjects];
+    [_packers removeAllObjects];
+}
+
+- (void)defragment
+{
+    SP_GENERIC(NSDictionary, NSString*, SPSubTexture*) *oldTextures = [[_textures copy] autorelease];
+    SP_GENERIC(NSArray, SPRenderTexture*) *oldPages = [[_pages copy] autorelease];
+    SP_GENERIC(NSMutableArray, SPRectanglePacker*) *packers = [NSMutableArray array];
+    SP_GENERIC(NSMutableArray, NSMutableArray*) *namesPerPage = [NSMutableArray array];
+    SP_GENERIC(NSMutableDictionary, NSString*, SPRectangle*) *slots = [NSMutableDictionary dictionary];
+
+    // MaxRects packs best if the biggest rectangles come first
+    NSArray *names = [oldTextures keysSortedByValueUsingComparator:^NSComparisonResult(SPTexture *t1, SPTexture *t2)
+    {
+        if      (t1.height > t2.height) return NSOrderedAscending;
+        else if (t1.height < t2.height) return NSOrderedDescending;
+        else if (t1.width  > t2.width)  return NSOrderedAscending;
+        else if (t1.width  < t2.width)  return NSOrderedDescending;
+        else return NSOrderedSame;
+    }];
+
+    for (NSString *name in names)
+    {
+        SPSubTexture *oldTexture = oldTextures[name];
+        NSInteger pageIndex = 0;
+        slots[name] = [self allocateSlotWithWidth:getSlotSize(oldTexture.width, _pageWidth)
+                                           height:getSlotSize(oldTexture.height, _pageHeight)
+                                        inPackers:packers pageIndex:&pageIndex];
+
+        if (pageIndex == namesPerPage.count)
+            [namesPerPage addObject:[NSMutableArray array]];
+
+        [namesPerPage[pageIndex] addObject:name];
+    }
+
+    [_pages removeAllObjects];
+    [_packers setArray:packers];
+
+    [namesPerPage enumerateObjectsUsingBlock:^(NSArray *pageNames, NSUInteger i, BOOL *stop)
+    {
+        if ([self canKeepPage:i ofPages:oldPages textures:oldTextures names:pageNames slots:slots])
+        {
+            // nothing moved on this page, so the page and its subtextures stay the same
+            [_pages addObject:oldPages[i]];
+            return;
+        }
+
+        SPRenderTexture *page = [self createPage];
+        [_pages addObject:page];
+
+        [page drawBundled:^
+         {
+             for (NSString *name in pageNames)
+             {
+                 SPRectangle *slot = slots[name];
+                 SPImage *image = [SPImage imageWithTexture:oldTextures[name]];
+                 image.x = slot.x;
+                 image.y = slot.y;
+                 [page drawObject:image];
+             }
+         }];
+
+        for (NSString *name in pageNames)
+        {
+            SPSubTexture *oldTexture = oldTextures[name];
+            SPRectangle *slot = slots[name];
+            SPRectangle *region = [SPRectangle rectangleWithX:slot.x y:slot.y
+                                                        width:oldTexture.width height:oldTexture.height];
+            _textures[name] = [SPSubTexture textureWithRegion:region ofTexture:page];
+        }
+    }];
+}
+
+#pragma mark Properties
+
+- (NSInteger)numPages
+{
+    return _pages.count;
+}
+
+- (NSInteger)numTextures
+{
+    return _textures.count;
+}
+
+- (NSArray *)names
+{
+    return [_textures.allKeys sortedArrayUsingSelector:@selector(compare:)];
+}
+
+- (float)occupancy
+{
+    // all pages have the same size
+    float occupancy = 0.0f;
+
+    for (SPRectanglePacker *packer in _packers)
+        occupancy += packer.occupancy;
+
+    return _packers.count ? occupancy / _packers.count : 0.0f;
+}
+
+#pragma mark Private
+
+- (SPRectangle *)allocateSlotWithWidth:(float)width height:(float)height
+                             inPackers:(NSMutableArray *)packers pageIndex:(NSInteger *)pageIndex
+{
+    // if no page has enough room, a packer for a new page is added; the caller creates the page.
+
+    for (NSInteger i=0; i<packers.count; ++i)
+    {
+        SPRectangle *slot = [packers[i] allocateRectangleWithWidth:width height:height];
+        if (slot)
+        {
+            *pageIndex = i;
+            return slot;
+        }
+    }
+
+    SPRectanglePacker *packer = [[SPRectanglePacker alloc] initWithWidth:_pageWidth height:_pageHeight];
+    [packers addObject:packer];
+    [packer release];
+
+    *pageIndex = packers.count - 1;
+    return [packer allocateRectangleWithWidth:width height:height];
+}
+
+- (SPRenderTexture *)createPage
+{
+    return [[[SPRenderTexture alloc] initWithWidth:_pageWidth height:_pageHeight] autorelease];
+}
+
+- (BOOL)isTextureOnPage:(SPTexture *)texture
+{
+    for (SPRenderTexture *page in _pages)
+        if (page.root == texture.root) return YES;
+
+    return NO;
+}
+
+- (BOOL)canKeepPage:(NSInteger)pageIndex ofPages:(NSArray *)oldPages textures:(NSDictionary *)oldTextures
+              names:(NSArray *)names slots:(NSDictionary *)slots
+{
+    // an old page can be kept if it contains exactly the given textures, at their new slots.
+
+    if (pageIndex >= oldPages.count) return NO;
+
+    SPRenderTexture *oldPage = oldPages[pageIndex];
+    NSInteger numTexturesOnPage = 0;
+
+    for (SPSubTexture *oldTexture in oldTextures.objectEnumerator)
+        if (oldTexture.parent == oldPage) ++numTexturesOnPage;
+
+    if (numTexturesOnPage != names.count) return NO;
+
+    for (NSString *name in names)
+    {
+        SPSubTexture *oldTexture = oldTextures[name];
+        SPRectangle *slot = slots[name];
+
+        if (oldTexture.parent != oldPage || oldTexture.region.x != slot.x ||
+            oldTexture.region.y != slot.y)
+            return NO;
+    }
+
+    return YES;
+}
+
+- (SPRectangle *)slotOfTexture:(SPSubTexture *)texture
+{
+    SPRectangle *region = texture.region;
+    return [SPRectangle rectangleWithX:region.x y:region.y
+                                 width:getSlotSize(region.width, _pageWidth)
+                                height:getSlotSize(region.height, _pageHeight)];
+}
+
+@end
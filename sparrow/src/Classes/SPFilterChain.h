@@ -0,0 +1,92 @@
+//
+//  SPFilterChain.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 18.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPFragmentFilter.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPFilterChain applies several filters to an object, one after the other, within a single
+ filter run: the output of one filter's final pass is the input of the next filter's first pass.
+ Compared to nesting sprites with one filter each, that saves the render-to-texture step of the
+ object for each filter but the first.
+
+    SPFilterChain *chain = [SPFilterChain filterChain];
+    [chain addFilter:[SPBlurFilter blurFilterWithBlur:2.0f]];
+    [chain addFilter:grayscaleFilter]; // an SPColorMatrixFilter
+    sprite.filter = chain;
+
+ Color matrix filters only change each pixel on its own; so they don't need a pass of their own.
+ Subsequent color matrix filters are combined into one matrix, and a color matrix that follows a
+ filter that supports an output color matrix (like the blur filter) is applied by that filter's
+ final pass. The example above thus needs just the passes of the blur filter. (The only
+ difference to separate passes is that intermediate colors are not clamped to the range [0, 1].)
+ All other filters execute their own passes.
+
+ The chain uses its own resolution, mode, offsets and caching; those of the contained filters are
+ ignored. Changes to the contained filters are picked up in the next frame, just like for a single
+ filter; that includes an auto-cached chain.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPFilterChain : SPFragmentFilter
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a filter chain with the given filters. _Designated Initializer_.
+- (instancetype)initWithFilters:(nullable SP_GENERIC(NSArray, SPFragmentFilter*) *)filters;
+
+/// Initializes an empty filter chain.
+- (instancetype)init;
+
+/// Factory method.
++ (instancetype)filterChainWithFilters:(nullable SP_GENERIC(NSArray, SPFragmentFilter*) *)filters;
+
+/// Factory method.
++ (instancetype)filterChain;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Adds a filter to the end of the chain. A filter can be part of the chain only once; adding it
+/// again raises an exception.
+- (void)addFilter:(SPFragmentFilter *)filter;
+
+/// Inserts a filter at a certain position of the chain. A filter can be part of the chain only once.
+- (void)addFilter:(SPFragmentFilter *)filter atIndex:(NSInteger)index;
+
+/// Removes a filter from the chain. If the filter is not part of the chain, nothing happens.
+- (void)removeFilter:(SPFragmentFilter *)filter;
+
+/// Removes all filters from the chain.
+- (void)removeAllFilters;
+
+/// Returns the filter at a certain position of the chain.
+- (SPFragmentFilter *)filterAtIndex:(NSInteger)index;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The filters of the chain, in the order they are applied.
+@property (nonatomic, readonly) SP_GENERIC(NSArray, SPFragmentFilter*) *filters;
+
+/// The number of filters in the chain.
+@property (nonatomic, readonly) NSInteger numFilters;
+
+@end
+
+NS_ASSUME_NONNULL_END
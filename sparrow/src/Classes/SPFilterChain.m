@@ -0,0 +1,377 @@
+//
+//  SPFilterChain.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 18.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPColorMatrix.h"
+#import "SPColorMatrixFilter.h"
+#import "SPDisplayObject.h"
+#import "SPFilterChain.h"
+#import "SPFragmentFilter_Internal.h"
+#import "SPMacros.h"
+#import "SPMatrix3D.h"
+#import "SPTexture.h"
+
+// --- private class -------------------------------------------------------------------------------
+
+// A stage is a filter that executes passes, plus the color matrix filters that were merged into
+// its final pass. A sequence of color matrix filters at the start of the chain (or after a filter
+// that doesn't support an output color matrix) is executed by a color matrix filter of its own.
+
+@interface SPFilterStage : NSObject
+{
+  @package
+    SPFragmentFilter *_filter;
+    BOOL _ownsFilter;
+    NSMutableArray *_colorMatrixFilters;
+    SPColorMatrix *_colorMatrix;
+    NSInteger _firstPass;
+}
+
+- (instancetype)initWithFilter:(SPFragmentFilter *)filter ownsFilter:(BOOL)ownsFilter;
+- (void)update;
+- (void)reset;
+
+@end
+
+@implementation SPFilterStage
+
+- (instancetype)initWithFilter:(SPFragmentFilter *)filter ownsFilter:(BOOL)ownsFilter
+{
+    if ((self = [super init]))
+    {
+        _filter = [filter retain];
+        _ownsFilter = ownsFilter;
+        _colorMatrixFilters = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_filter release];
+    [_colorMatrixFilters release];
+    [_colorMatrix release];
+    [super dealloc];
+}
+
+- (void)update
+{
+    if (_colorMatrixFilters.count == 0) return;
+
+    if (_ownsFilter)
+    {
+        SPColorMatrixFilter *filter = (SPColorMatrixFilter *)_filter;
+        [filter reset];
+
+        for (SPColorMatrixFilter *colorMatrixFilter in _colorMatrixFilters)
+            [filter concatColorMatrix:colorMatrixFilter.colorMatrix];
+    }
+    else
+    {
+        if (!_colorMatrix) _colorMatrix = [[SPColorMatrix alloc] init];
+        else [_colorMatrix identity];
+
+        for (SPColorMatrixFilter *colorMatrixFilter in _colorMatrixFilters)
+            [_colorMatrix concatColorMatrix:colorMatrixFilter.colorMatrix];
+
+        _filter.outputColorMatrix = _colorMatrix;
+    }
+}
+
+- (void)reset
+{
+    // the filter belongs to the user; don't leave the merged matrix behind
+    if (!_ownsFilter && _colorMatrixFilters.count)
+        _filter.outputColorMatrix = nil;
+}
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPFilterChain
+{
+    SP_GENERIC(NSMutableArray, SPFragmentFilter*) *_filters;
+    SP_GENERIC(NSMutableArray, SPFilterStage*) *_stages;
+    NSInteger *_passStages;
+    NSInteger _passStagesCapacity;
+    NSUInteger _removedChangeVersions;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithFilters:(NSArray *)filters
+{
+    if ((self = [super initWithNumPasses:1 resolution:1.0f]))
+    {
+        _filters = [[NSMutableArray alloc] initWithCapacity:filters.count];
+
+        for (SPFragmentFilter *filter in filters)
+            [self addFilter:filter];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithFilters:nil];
+}
+
+- (void)dealloc
+{
+    [_filters release];
+    [_stages release];
+    free(_passStages);
+    [super dealloc];
+}
+
++ (instancetype)filterChainWithFilters:(NSArray *)filters
+{
+    return [[[self alloc] initWithFilters:filters] autorelease];
+}
+
++ (instancetype)filterChain
+{
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark Methods
+
+- (void)addFilter:(SPFragmentFilter *)filter
+{
+    [self addFilter:filter atIndex:_filters.count];
+}
+
+- (void)addFilter:(SPFragmentFilter *)filter atIndex:(NSInteger)index
+{
+    if (index < 0 || index > _filters.count)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid filter index"];
+
+    if (filter == self)
+        [NSException raise:SPExceptionInvalidOperation format:@"A filter chain cannot contain itself"];
+
+    if ([_filters indexOfObjectIdenticalTo:filter] != NSNotFound)
+        [NSException raise:SPExceptionInvalidOperation format:@"A filter can be added only once"];
+
+    [_filters insertObject:filter atIndex:index];
+    SP_RELEASE_AND_NIL(_stages);
+    [self setRequiresRedraw];
+}
+
+- (void)removeFilter:(SPFragmentFilter *)filter
+{
+    NSInteger index = [_filters indexOfObjectIdenticalTo:filter];
+    if (index != NSNotFound)
+    {
+        _removedChangeVersions += filter.changeVersion;
+        [_filters removeObjectAtIndex:index];
+        SP_RELEASE_AND_NIL(_stages);
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)removeAllFilters
+{
+    for (SPFragmentFilter *filter in _filters)
+        _removedChangeVersions += filter.changeVersion;
+
+    [_filters removeAllObjects];
+    SP_RELEASE_AND_NIL(_stages);
+    [self setRequiresRedraw];
+}
+
+- (SPFragmentFilter *)filterAtIndex:(NSInteger)index
+{
+    if (index < 0 || index >= _filters.count)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid filter index"];
+
+    return _filters[index];
+}
+
+- (void)renderObject:(SPDisplayObject *)object support:(SPRenderSupport *)support
+{
+    if (_filters.count == 0)
+    {
+        [object render:support];
+        return;
+    }
+
+    [self updateStages];
+    [super renderObject:object support:support];
+    [self resetStages];
+}
+
+#pragma mark SPFragmentFilter (Subclasses)
+
+- (void)createPrograms
+{
+    // the contained filters create their own programs
+}
+
+- (void)activateWithPass:(NSInteger)pass texture:(SPTexture *)texture mvpMatrix:(SPMatrix3D *)matrix
+{
+    SPFilterStage *stage = [self stageForPass:pass];
+    [stage->_filter activateWithPass:pass - stage->_firstPass texture:texture mvpMatrix:matrix];
+}
+
+- (void)deactivateWithPass:(NSInteger)pass texture:(SPTexture *)texture
+{
+    SPFilterStage *stage = [self stageForPass:pass];
+    [stage->_filter deactivateWithPass:pass - stage->_firstPass texture:texture];
+}
+
+- (float)resolutionForPass:(NSInteger)pass
+{
+    SPFilterStage *stage = [self stageForPass:pass];
+    return [stage->_filter resolutionForPass:pass - stage->_firstPass];
+}
+
+- (BOOL)programsReady
+{
+    for (SPFilterStage *stage in _stages)
+        if (!stage->_filter.programsReady) return NO;
+
+    return YES;
+}
+
+#pragma mark Properties
+
+- (NSUInteger)changeVersion
+{
+    // the versions only ever grow, so their sum changes whenever one of the filters changes.
+    // The versions of removed filters stay part of the sum, so that it never shrinks.
+    NSUInteger changeVersion = [super changeVersion] + _removedChangeVersions;
+
+    for (SPFragmentFilter *filter in _filters)
+        changeVersion += filter.changeVersion;
+
+    return changeVersion;
+}
+
+- (NSArray *)filters
+{
+    return [[_filters copy] autorelease];
+}
+
+- (NSInteger)numFilters
+{
+    return _filters.count;
+}
+
+#pragma mark Private
+
+- (void)createStages
+{
+    _stages = [[NSMutableArray alloc] initWithCapacity:_filters.count];
+
+    for (SPFragmentFilter *filter in _filters)
+    {
+        SPFilterStage *previousStage = _stages.lastObject;
+
+        if ([filter isKindOfClass:[SPColorMatrixFilter class]])
+        {
+            // color matrix filters don't get passes of their own if that can be avoided
+            if (!previousStage || !(previousStage->_ownsFilter ||
+                                    previousStage->_filter.supportsOutputColorMatrix))
+            {
+                previousStage = [[SPFilterStage alloc] initWithFilter:[SPColorMatrixFilter colorMatrixFilter]
+                                                           ownsFilter:YES];
+                [_stages addObject:previousStage];
+                [previousStage release];
+            }
+
+            [previousStage->_colorMatrixFilters addObject:filter];
+        }
+        else
+        {
+            SPFilterStage *stage = [[SPFilterStage alloc] initWithFilter:filter ownsFilter:NO];
+            [_stages addObject:stage];
+            [stage release];
+        }
+    }
+}
+
+- (void)updateStages
+{
+    if (!_stages) [self createStages];
+
+    NSInteger numPasses = 0;
+    float marginX = 0.0f;
+    float marginY = 0.0f;
+
+    if (_stages.count == 0)
+    {
+        // only happens for an empty, nested chain; it must not execute any passes
+        self.numPasses = 0;
+        self.marginX = self.marginY = 0.0f;
+        return;
+    }
+
+    for (SPFilterStage *stage in _stages)
+    {
+        // the filters are not rendered on their own, so they must be prepared here
+        if ([stage->_filter isKindOfClass:[SPFilterChain class]])
+            [(SPFilterChain *)stage->_filter updateStages];
+
+        [stage->_filter preparePrograms];
+        [stage update];
+
+        stage->_firstPass = numPasses;
+        numPasses += stage->_filter.numPasses;
+        marginX += stage->_filter.marginX;
+        marginY += stage->_filter.marginY;
+    }
+
+    // the stage of each pass is looked up in a table, since it's needed several times per pass
+    if (numPasses > _passStagesCapacity)
+    {
+        _passStagesCapacity = numPasses;
+        _passStages = realloc(_passStages, sizeof(NSInteger) * _passStagesCapacity);
+    }
+
+    NSInteger stageIndex = 0;
+    NSInteger pass = 0;
+
+    for (SPFilterStage *stage in _stages)
+    {
+        for (NSInteger i=0; i<stage->_filter.numPasses; ++i)
+            _passStages[pass++] = stageIndex;
+
+        ++stageIndex;
+    }
+
+    // all passes share the vertex buffer; SPProgram binds 'aPosition' and 'aTexCoords' to the
+    // same locations in the programs of all filters.
+    SPFragmentFilter *firstFilter = _stages[0]->_filter;
+    self.vertexPosID = firstFilter.vertexPosID;
+    self.texCoordsID = firstFilter.texCoordsID;
+
+    self.numPasses = numPasses;
+    self.marginX = marginX;
+    self.marginY = marginY;
+}
+
+- (void)resetStages
+{
+    for (SPFilterStage *stage in _stages)
+    {
+        [stage reset];
+
+        if ([stage->_filter isKindOfClass:[SPFilterChain class]])
+            [(SPFilterChain *)stage->_filter resetStages];
+    }
+}
+
+- (SPFilterStage *)stageForPass:(NSInteger)pass
+{
+    return _stages[_passStages[pass]];
+}
+
+@end
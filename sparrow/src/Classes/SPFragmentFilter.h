@@ -13,6 +13,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPColorMatrix;
 @class SPDisplayObject;
 @class SPMatrix3D;
 @class SPRenderSupport;
@@ -41,6 +42,9 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
     * The output of each pass is used as the input for the next pass; if it's the final pass, it will
         be rendered directly to the back buffer.
 
+ The textures used by the passes are borrowed from the render target pool of the current SPContext
+ and handed back as soon as a pass is done with them; thus, filters of the same size share them.
+
  All of this is set up by the abstract SPFragmentFilter class. Concrete subclasses just need to 
  override the protected methods 'createPrograms', 'activateWithPass' and (optionally) 
  'deactivateWithPass' to create and execute its custom shader code. Each filter can be configured to 
@@ -84,6 +88,11 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
 /// once per frame again.
 - (void)clearCache;
 
+/// Marks the filter output as outdated, so that an auto-cached filter executes its passes again.
+/// The filters of Sparrow call this method whenever one of their settings changes; subclasses
+/// must call it for settings of their own.
+- (void)setRequiresRedraw;
+
 /// Applies the filter on a certain display object, rendering the output into the current render
 /// target. This method is called automatically by Sparrow's rendering system for the object the
 /// filter is attached to.
@@ -96,6 +105,16 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
 /// Indicates if the filter is cached (via the "cache" method).
 @property (nonatomic, readonly) BOOL isCached;
 
+/// Indicates if the filter caches its output automatically. If enabled, the filter compares the
+/// filtered object and its own settings with those of the previous frame; as long as they don't
+/// change, it draws its last output instead of executing its passes again (moving the object
+/// doesn't count as a change, either). Thus, a static object with a glow costs just one quad.
+///
+/// Changes are detected via the `changeVersion` of the object; if you modify the object in a
+/// way Sparrow can't notice, call `setRequiresRedraw` on it. Objects that are drawn with an
+/// alpha value below one or in 3D space are not cached. @default NO
+@property (nonatomic, assign) BOOL autoCache;
+
 /// The resolution of the filter texture. "1" means stage resolution, "0.5" half the stage
 /// resolution. A lower resolution saves memory and execution time(depending on the GPU), but
 /// results in a lower output quality. Values greater than 1 are allowed; such values might make
@@ -123,6 +142,8 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
 /// -------------
 
 /// Subclasses must override this method and use it to create their fragment and vertex shaders.
+/// If the programs are compiled asynchronously, the method is called again once they are ready,
+/// so that the subclass can look up its uniform and attribute locations.
 - (void)createPrograms;
 
 /// Subclasses must override this method and use it to activate their shader program.
@@ -133,6 +154,11 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
 /// If you need to clean up any resources, you can do so in this method.
 - (void)deactivateWithPass:(NSInteger)pass texture:(SPTexture *)texture;
 
+/// The size of the texture that is passed to the given pass, relative to the filter's resolution.
+/// Override this method to let passes work on downsampled textures (e.g. `0.5f` for half the
+/// size); the input of pass 0 is the object itself. @default 1
+- (float)resolutionForPass:(NSInteger)pass;
+
 /// The standard vertex shader code. It will be used automatically if you don't create a custom
 /// vertex shader yourself.
 + (NSString *)standardVertexShader;
@@ -156,12 +182,30 @@ typedef NS_ENUM(NSInteger, SPFragmentFilterMode)
 /// called that often.
 @property (nonatomic, assign) NSInteger numPasses;
 
+/// A number that changes whenever 'setRequiresRedraw' is called, i.e. whenever a setting that
+/// affects the filter output changes.
+@property (nonatomic, readonly) NSUInteger changeVersion;
+
 /// The ID of the vertex buffer attribute that stores the vertex position.
 @property (nonatomic, assign) int vertexPosID;
 
 /// The ID of the vertex buffer attribute that stores the SPTexture coordinates.
 @property (nonatomic, assign) int texCoordsID;
 
+/// Indicates if the filter applies the 'outputColorMatrix' in its final pass. Subclasses that
+/// support it return YES; a filter chain then merges subsequent color matrix filters into that
+/// pass instead of adding a new one. @default NO
+@property (nonatomic, readonly) BOOL supportsOutputColorMatrix;
+
+/// A color matrix that is applied to the output of the final pass, if the filter supports it.
+/// Set up by the filter chain. @default nil
+@property (nonatomic, copy, nullable) SPColorMatrix *outputColorMatrix;
+
+/// Indicates if the shader programs needed for the next run are ready. Subclasses that compile
+/// their programs asynchronously override this property; as long as it returns `NO`, the filter
+/// output is skipped. @default YES
+@property (nonatomic, readonly) BOOL programsReady;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,6 +11,7 @@
 
 #import "SparrowClass.h"
 #import "SPBlendMode.h"
+#import "SPColorMatrix.h"
 #import "SPContext.h"
 #import "SPDisplayObject.h"
 #import "SPImage.h"
@@ -22,13 +23,14 @@
 #import "SPRenderSupport.h"
 #import "SPRenderTexture.h"
 #import "SPFragmentFilter.h"
+#import "SPFragmentFilter_Internal.h"
 #import "SPStage.h"
 #import "SPGLTexture.h"
 #import "SPTexture.h"
-#import "SPUtils.h"
 #import "SPVertexData.h"
 
 #define MIN_TEXTURE_SIZE 64
+#define TEXTURE_SIZE_ALIGNMENT 16
 
 // --- private interface ---------------------------------------------------------------------------
 
@@ -39,6 +41,7 @@
 @property (nonatomic, assign) NSInteger numPasses;
 @property (nonatomic, assign) int vertexPosID;
 @property (nonatomic, assign) int texCoordsID;
+@property (nonatomic, copy) SPColorMatrix *outputColorMatrix;
 
 @end
 
@@ -55,9 +58,17 @@
     float _offsetX;
     float _offsetY;
 
-    SP_GENERIC(NSMutableArray, SPTexture*) *_passTextures;
     SPQuadBatch *_cache;
     BOOL _cacheRequested;
+    BOOL _autoCache;
+    BOOL _programsPending;
+    NSUInteger _changeVersion;
+
+    SPDisplayObject *__weak _autoCacheObject;
+    NSUInteger _autoCacheObjectVersion;
+    NSUInteger _autoCacheFilterVersion;
+    float _autoCacheMatrix[4];
+    SPColorMatrix *_outputColorMatrix;
 
     SPVertexData *_vertexData;
     ushort _indexData[6];
@@ -77,7 +88,6 @@
         _resolution = resolution;
         _premultipliedAlpha = YES;
         _mode = SPFragmentFilterModeReplace;
-        _passTextures = [[NSMutableArray alloc] initWithCapacity:numPasses];
 
         _vertexData = [[SPVertexData alloc] initWithSize:4 premultipliedAlpha:true];
         _vertexData.vertices[1].texCoords.x = 1.0f;
@@ -93,6 +103,7 @@
         _indexData[5] = 2;
 
         [self createPrograms];
+        _programsPending = !self.programsReady;
     }
     return self;
 }
@@ -113,7 +124,7 @@
     glDeleteBuffers(1, &_indexBufferName);
 
     [_vertexData release];
-    [_passTextures release];
+    [_outputColorMatrix release];
     [_cache release];
     [super dealloc];
 }
@@ -137,30 +148,54 @@
     return _cacheRequested || _cache;
 }
 
+- (void)setRequiresRedraw
+{
+    ++_changeVersion;
+}
+
 - (void)renderObject:(SPDisplayObject *)object support:(SPRenderSupport *)support
 {
     SPExecuteWithDebugMarker("FragmentFilter")
     {
+        if (_autoCache)
+        {
+            // the passes are only executed once the output stays the same for two frames;
+            // that way, an object that changes in every frame doesn't create a texture each time.
+            if (![self isAutoCacheValidWithObject:object support:support])
+            {
+                _cacheRequested = NO;
+                [self disposeCache];
+            }
+            else if (!_cache) _cacheRequested = YES;
+        }
+
         // bottom layer
         if (_mode == SPFragmentFilterModeAbove)
             [object render:support];
         
-        // center layer
-        if (_cacheRequested)
+        // center layer (skipped while the programs are still being compiled)
+        if (_cacheRequested && [self preparePrograms])
         {
             _cacheRequested = false;
             _cache = [[self renderPassesWithObject:object support:support intoCache:YES] retain];
-            [self disposePassTextures];
         }
         
         if (_cache)
             [_cache render:support];
-        else
+        else if ([self preparePrograms])
             [self renderPassesWithObject:object support:support intoCache:NO];
         
         // top layer
         if (_mode == SPFragmentFilterModeBelow)
             [object render:support];
+
+        // objects may change while they are rendered (e.g. a text field that is redrawn);
+        // that's why the versions are saved afterwards.
+        if (_autoCache)
+        {
+            _autoCacheObjectVersion = object.changeVersion;
+            _autoCacheFilterVersion = self.changeVersion;
+        }
     }
 }
 
@@ -181,6 +216,21 @@
     // override in subclass
 }
 
+- (float)resolutionForPass:(NSInteger)pass
+{
+    return 1.0f;
+}
+
+- (BOOL)supportsOutputColorMatrix
+{
+    return NO;
+}
+
+- (BOOL)programsReady
+{
+    return YES;
+}
+
 + (NSString *)standardVertexShader
 {
     return
@@ -204,14 +254,93 @@
     @"} \n";
 }
 
+#pragma mark Properties
+
+- (NSUInteger)changeVersion
+{
+    return _changeVersion;
+}
+
+- (void)setAutoCache:(BOOL)autoCache
+{
+    if (autoCache != _autoCache)
+    {
+        _autoCache = autoCache;
+        _autoCacheObject = nil;
+        [self clearCache];
+    }
+}
+
+- (void)setResolution:(float)resolution
+{
+    if (resolution != _resolution)
+    {
+        _resolution = resolution;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setOffsetX:(float)offsetX
+{
+    if (offsetX != _offsetX)
+    {
+        _offsetX = offsetX;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setOffsetY:(float)offsetY
+{
+    if (offsetY != _offsetY)
+    {
+        _offsetY = offsetY;
+        [self setRequiresRedraw];
+    }
+}
+
+#pragma mark Internal
+
+- (BOOL)preparePrograms
+{
+    // asynchronously compiled programs only provide their locations once they are ready
+    BOOL ready = self.programsReady;
+    if (ready && _programsPending) [self createPrograms];
+    
+    _programsPending = !ready;
+    return ready;
+}
+
 #pragma mark Private
 
+- (BOOL)isAutoCacheValidWithObject:(SPDisplayObject *)object support:(SPRenderSupport *)support
+{
+    // The cache is stored in object coordinates, so it survives a translation of the object;
+    // any other transformation changes the stage bounds (and thus the rasterization) of the output.
+    // The cache image is drawn with the current alpha value, which is already part of the
+    // output -- thus, only opaque objects are cached.
+
+    SPMatrix *matrix = [object transformationMatrixToSpace:object.stage];
+    BOOL isValid = object == _autoCacheObject && !object.is3D && support.alpha == 1.0f &&
+                   object.changeVersion == _autoCacheObjectVersion &&
+                   self.changeVersion == _autoCacheFilterVersion &&
+                   matrix.a == _autoCacheMatrix[0] && matrix.b == _autoCacheMatrix[1] &&
+                   matrix.c == _autoCacheMatrix[2] && matrix.d == _autoCacheMatrix[3];
+
+    _autoCacheObject = object;
+    _autoCacheMatrix[0] = matrix.a;
+    _autoCacheMatrix[1] = matrix.b;
+    _autoCacheMatrix[2] = matrix.c;
+    _autoCacheMatrix[3] = matrix.d;
+
+    return isValid;
+}
+
 - (void)calcBoundsWithObject:(SPDisplayObject *)object
                  targetSpace:(SPDisplayObject *)targetSpace
                        scale:(float)scale
                    intersect:(BOOL)intersectWithStage
                   intoBounds:(SPRectangle *)bounds
-               intoBoundsPOT:(SPRectangle *)boundsPOT
+           intoTextureBounds:(SPRectangle *)textureBounds
 {
     SPStage *stage = nil;
     float marginX = _marginX;
@@ -249,14 +378,18 @@
         // and with an optional margin.
         [bounds inflateXBy:marginX yBy:marginY];
         
-        // To fit into a POT-texture, we extend it towards the right and bottom.
+        // To fit into a legal texture size, we extend it towards the right and bottom. That's the
+        // next power of two only if the context doesn't support other sizes.
+        SPContext *context = SPContext.currentContext;
         int minSize = MIN_TEXTURE_SIZE / scale;
         float minWidth  = bounds.width  > minSize ? bounds.width  : minSize;
         float minHeight = bounds.height > minSize ? bounds.height : minSize;
         
-        [boundsPOT setX:bounds.x y:bounds.y
-                  width:[SPUtils nextPowerOfTwo:minWidth  * scale] / scale
-                 height:[SPUtils nextPowerOfTwo:minHeight * scale] / scale];
+        [textureBounds setX:bounds.x y:bounds.y
+                      width:[context renderTargetSizeForNativeSize:ceilf(minWidth  * scale)
+                                                         alignment:TEXTURE_SIZE_ALIGNMENT] / scale
+                     height:[context renderTargetSizeForNativeSize:ceilf(minHeight * scale)
+                                                         alignment:TEXTURE_SIZE_ALIGNMENT] / scale];
     }
 }
 
@@ -284,29 +417,21 @@
     SP_RELEASE_AND_NIL(_cache);
 }
 
-- (void)disposePassTextures
-{
-    [_passTextures removeAllObjects];
-}
-
-- (SPTexture *)passTextureForPass:(NSInteger)pass
-{
-    return _passTextures[pass % 2];
-}
-
 - (SPQuadBatch *)renderPassesWithObject:(SPDisplayObject *)object
                                 support:(SPRenderSupport *)support
                               intoCache:(BOOL)intoCache
 {
-    SPTexture *passTexture = nil;
+    SPGLTexture *passTexture = nil;
+    SPGLTexture *outputTexture = nil;
     SPTexture *cacheTexture = nil;
+    SPContext *context = SPContext.currentContext;
     SPDisplayObject *targetSpace = object.stage;
     SPStage *stage = Sparrow.stage;
     float scale = Sparrow.contentScaleFactor;
     SPMatrix *projMatrix = [SPMatrix matrixWithIdentity];
     SPMatrix3D *projMatrix3D = [SPMatrix3D matrix3DWithIdentity];
     SPRectangle *bounds = [SPRectangle rectangle];
-    SPRectangle *boundsPot = [SPRectangle rectangle];
+    SPRectangle *textureBounds = [SPRectangle rectangle];
     uint previousStencilRefValue = 0;
     SPTexture *previousRenderTarget = nil;
     BOOL intersectWithStage;
@@ -315,22 +440,18 @@
     // (or, if the object is not connected to the stage, in its base object's coordinates)
     intersectWithStage = !intoCache && _offsetX == 0 && _offsetY == 0;
     [self calcBoundsWithObject:object targetSpace:targetSpace scale:_resolution * scale intersect:intersectWithStage
-                    intoBounds:bounds intoBoundsPOT:boundsPot];
+                    intoBounds:bounds intoTextureBounds:textureBounds];
     
     if (bounds.isEmpty)
-    {
-        [self disposePassTextures];
         return intoCache ? [SPQuadBatch quadBatch] : nil;
-    }
     
-    [self updateBuffers:boundsPot];
-    [self updatePassTexturesWithWidth:boundsPot.width height:boundsPot.height scale:_resolution * scale];
+    [self updateBuffers:textureBounds];
     
     [support finishQuadBatch];
     [support addDrawCalls:_numPasses];
     [support pushStateWithMatrix:[SPMatrix matrixWithIdentity] alpha:1.0f blendMode:SPBlendModeAuto];
     [support pushMatrix3D];
-    [support pushClipRect:boundsPot intersectWithCurrent:NO];
+    [support pushClipRect:textureBounds intersectWithCurrent:NO];
     
     // save original state (projection matrix, render target, stencil reference value)
     [projMatrix copyFromMatrix:support.projectionMatrix];
@@ -340,14 +461,16 @@
     
     // use cache?
     if (intoCache)
-        cacheTexture = [self texureWithWidth:boundsPot.width height:boundsPot.height scale:_resolution * scale];
+        cacheTexture = [self texureWithWidth:textureBounds.width height:textureBounds.height scale:_resolution * scale];
     
     // draw the original object into a texture
-    [support setRenderTarget:_passTextures[0]];
+    passTexture = [self borrowPassTextureForPass:0 width:textureBounds.width height:textureBounds.height
+                                           scale:_resolution * scale];
+    [support setRenderTarget:passTexture];
     [support clear];
     [support setBlendMode:SPBlendModeNormal];
     [support setStencilReferenceValue:0];
-    [support setProjectionMatrixWithX:bounds.x y:boundsPot.bottom width:boundsPot.width height:-boundsPot.height
+    [support setProjectionMatrixWithX:bounds.x y:textureBounds.bottom width:textureBounds.width height:-textureBounds.height
                            stageWidth:stage.width stageHeight:stage.height cameraPos:stage.cameraPosition];
     [object render:support];
     [support finishQuadBatch];
@@ -375,12 +498,16 @@
         {
             // draw into pass texture
             SPPushDebugMarker("Pass");
-            [support setRenderTarget:[self passTextureForPass:i+1]];
+            outputTexture = [self borrowPassTextureForPass:i+1 width:textureBounds.width
+                                                    height:textureBounds.height scale:_resolution * scale];
+            [support setRenderTarget:outputTexture];
             [support clear];
         }
         else // final pass
         {
             SPPushDebugMarker("Final");
+            outputTexture = nil;
+            
             if (intoCache)
             {
                 // draw into cache texture
@@ -401,7 +528,6 @@
             }
         }
 
-        passTexture = [self passTextureForPass:i];
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, passTexture.name);
 
@@ -409,6 +535,10 @@
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
         [self deactivateWithPass:i texture:passTexture];
         
+        // the input of this pass is not needed any longer; other passes or filters may reuse it
+        [context returnRenderTarget:passTexture];
+        passTexture = outputTexture;
+        
         SPPopDebugMarker();
     }
 
@@ -473,20 +603,16 @@
     glBufferData(GL_ARRAY_BUFFER, vertexSize, _vertexData.vertices, GL_STATIC_DRAW);
 }
 
-- (void)updatePassTexturesWithWidth:(float)width height:(float)height scale:(float)scale
+- (SPGLTexture *)borrowPassTextureForPass:(NSInteger)pass width:(float)width height:(float)height
+                                    scale:(float)scale
 {
-    NSInteger numPassTextures = _numPasses > 1 ? 2 : 1;
-    BOOL needsUpdate = _passTextures.count != numPassTextures ||
-        !SPIsFloatEqual([_passTextures[0] nativeWidth], width * scale) ||
-        !SPIsFloatEqual([_passTextures[0] nativeHeight], height * scale);
-
-    if (needsUpdate)
-    {
-        [_passTextures removeAllObjects];
-
-        for (NSInteger i=0; i<numPassTextures; ++i)
-            [_passTextures addObject:[self texureWithWidth:width height:height scale:scale]];
-    }
+    // passes may work on downsampled textures; the size in points stays the same.
+    float passScale = scale * [self resolutionForPass:pass];
+    
+    return [SPContext.currentContext borrowRenderTargetWithNativeWidth:MAX(1, (NSInteger)(width  * passScale))
+                                                          nativeHeight:MAX(1, (NSInteger)(height * passScale))
+                                                                 scale:passScale
+                                                    premultipliedAlpha:_premultipliedAlpha];
 }
 
 - (SPTexture *)texureWithWidth:(float)width height:(float)height scale:(float)scale
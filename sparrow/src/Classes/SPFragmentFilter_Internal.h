@@ -0,0 +1,25 @@
+//
+//  SPFragmentFilter_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import "SPFragmentFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SPFragmentFilter (Internal)
+
+/// Returns `programsReady`; when the programs have just become ready, `createPrograms` is called
+/// again, so that the filter can look up their locations.
+- (BOOL)preparePrograms;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -11,6 +11,7 @@
 
 #import "SparrowClass.h"
 #import "SPContext_Internal.h"
+#import "SPDisplayObject.h"
 #import "SPGLTexture_Internal.h"
 #import "SPMacros.h"
 #import "SPOpenGL.h"
@@ -29,6 +30,7 @@
     BOOL _premultipliedAlpha;
     BOOL _mipmaps;
     BOOL _usedAsRenderTexture;
+    NSHashTable *_displayingObjects;
 }
 
 @synthesize name = _name;
@@ -210,6 +212,7 @@
         [SPContext clearFrameBuffersForTexture:self];
     
     glDeleteTextures(1, &_name);
+    [_displayingObjects release];
     [super dealloc];
 }
 
@@ -295,4 +298,25 @@
     _usedAsRenderTexture = usedAsRenderTexture;
 }
 
+- (void)addDisplayingObject:(SPDisplayObject *)object
+{
+    // the objects are not retained; they remove themselves before they are deallocated
+    if (!_displayingObjects)
+        _displayingObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsOpaqueMemory |
+                                                                  NSPointerFunctionsOpaquePersonality
+                                                         capacity:4];
+    [_displayingObjects addObject:object];
+}
+
+- (void)removeDisplayingObject:(SPDisplayObject *)object
+{
+    [_displayingObjects removeObject:object];
+}
+
+- (void)contentsDidChange
+{
+    for (SPDisplayObject *object in _displayingObjects)
+        [object setRequiresRedraw];
+}
+
 @end
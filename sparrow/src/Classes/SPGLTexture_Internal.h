@@ -12,8 +12,20 @@
 #import <Sparrow/SparrowBase.h>
 #import "SPGLTexture.h"
 
+@class SPDisplayObject;
+
 @interface SPGLTexture (Internal)
 
 @property (nonatomic, assign) BOOL usedAsRenderTexture;
 
+/// Registers an object that displays the texture (or a part of it), without retaining it. Only
+/// needed for render textures: their contents change after the objects were drawn.
+- (void)addDisplayingObject:(SPDisplayObject *)object;
+
+/// Removes an object that was registered with `addDisplayingObject:`.
+- (void)removeDisplayingObject:(SPDisplayObject *)object;
+
+/// Marks all displaying objects as changed (see `SPDisplayObject setRequiresRedraw`).
+- (void)contentsDidChange;
+
 @end
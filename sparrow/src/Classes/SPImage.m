@@ -12,6 +12,7 @@
 #import "SparrowClass.h"
 #import "SPContext.h"
 #import "SPGLTexture.h"
+#import "SPGLTexture_Internal.h"
 #import "SPImage.h"
 #import "SPMacros.h"
 #import "SPPoint.h"
@@ -48,6 +49,7 @@
         _vertexData.vertices[3].texCoords.y = 1.0f;
         
         _texture = [texture retain];
+        [self observeTexture:YES];
         _vertexDataCache = [[SPVertexData alloc] initWithSize:4 premultipliedAlpha:pma];
         _vertexDataCacheInvalid = YES;
     }
@@ -76,6 +78,7 @@
 
 - (void)dealloc
 {
+    [self observeTexture:NO];
     [_texture release];
     [_vertexDataCache release];
     [super dealloc];
@@ -140,6 +143,7 @@
 
 - (void)vertexDataDidChange
 {
+    [super vertexDataDidChange];
     _vertexDataCacheInvalid = YES;
 }
 
@@ -164,11 +168,25 @@
     }
     else if (value != _texture)
     {
+        [self observeTexture:NO];
         SP_RELEASE_AND_RETAIN(_texture, value);
+        [self observeTexture:YES];
         [_vertexData setPremultipliedAlpha:_texture.premultipliedAlpha updateVertices:YES];
         [_vertexDataCache setPremultipliedAlpha:_texture.premultipliedAlpha updateVertices:NO];
         [self vertexDataDidChange];
     }
 }
 
+#pragma mark Private
+
+- (void)observeTexture:(BOOL)observe
+{
+    // the contents of render textures change independently of the image
+    SPGLTexture *root = _texture.root;
+    if (!root.usedAsRenderTexture) return;
+
+    if (observe) [root addDisplayingObject:self];
+    else         [root removeDisplayingObject:self];
+}
+
 @end
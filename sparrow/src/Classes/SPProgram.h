@@ -21,6 +21,17 @@ NS_ASSUME_NONNULL_BEGIN
  Use the `uniformByName:` and `attributeByName:` properties to query the index of the respective
  variables.
  
+ Compiling and linking a program may take a while. To keep that off the main thread, create the
+ program asynchronously: it is then compiled in the resource queue of the view controller (see
+ `executeInResourceQueue:`), and the instance you get back acts as a placeholder until it is done.
+ Poll `isReady` before using it; until then, its name is zero and all locations are -1.
+ 
+ To upload uniform values, use the typed setters like `setMatrix4:forUniform:`. The program keeps
+ a copy of the last value it uploaded to each uniform and skips uploads that wouldn't change
+ anything -- which is the normal case for the MVP matrix and alpha of consecutive draw calls.
+ Like `glUniform`, the setters act on the program that is currently in use; so call them after
+ activating the program with `glUseProgram`.
+ 
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPProgram : NSObject
@@ -29,8 +40,14 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Initialization
 /// --------------------
 
-/// Initializes a GLSL program by compiling vertex and fragment shaders from source. In debug
-/// mode, compilation erros are logged into the console. _Designated Initializer_.
+/// Initializes a GLSL program by compiling vertex and fragment shaders from source, either right
+/// away or in the resource queue. In debug mode, compilation erros are logged into the console.
+/// If the program cache of the current view controller contains a binary of the program, it is
+/// loaded instead. _Designated Initializer_.
+- (instancetype)initWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader
+                        asynchronous:(BOOL)async;
+
+/// Initializes a GLSL program by compiling vertex and fragment shaders synchronously.
 - (instancetype)initWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader;
 
 /// -------------
@@ -40,16 +57,42 @@ NS_ASSUME_NONNULL_BEGIN
 /// Returns the index of a uniform with a certain name.
 - (int)uniformByName:(NSString *)name;
 
-/// Returns the index of an attribute with a certain name.
+/// Returns the index of an attribute with a certain name. The attributes `aPosition`, `aColor` and
+/// `aTexCoords` are always bound to the locations 0, 1 and 2 (if the program uses them).
 - (int)attributeByName:(NSString *)name;
 
+/// Uploads a 4x4 matrix (16 floats, column major) to a uniform, unless it already has that value.
+- (void)setMatrix4:(const float *)matrix forUniform:(int)location;
+
+/// Uploads a four-component vector to a uniform, unless it already has that value.
+- (void)setVector4:(const float *)vector forUniform:(int)location;
+
+/// Uploads a two-component vector to a uniform, unless it already has that value.
+- (void)setVector2:(const float *)vector forUniform:(int)location;
+
+/// Uploads a float to a uniform, unless it already has that value.
+- (void)setFloat:(float)value forUniform:(int)location;
+
+/// Uploads an integer (e.g. a texture unit) to a uniform, unless it already has that value.
+- (void)setInt:(int)value forUniform:(int)location;
+
 /// ----------------
 /// @name Properties
 /// ----------------
 
-/// The handle of the program object needed.
+/// The handle of the program object needed. Zero as long as the program is not ready.
 @property (nonatomic, readonly) uint name;
 
+/// Indicates if the program has been linked and can be used. Always `YES` for a program that was
+/// compiled synchronously; an asynchronous one becomes ready on the main thread.
+@property (nonatomic, readonly) BOOL isReady;
+
+/// The number of uniform uploads the setters have passed on to OpenGL.
+@property (nonatomic, readonly) NSInteger numUniformUploads;
+
+/// The number of uniform uploads the setters have skipped because the value was unchanged.
+@property (nonatomic, readonly) NSInteger numSkippedUniformUploads;
+
 /// The source code of the vertex shader.
 @property (nonatomic, readonly) NSString *vertexShader;
 
@@ -58,4 +101,15 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+
+/** SPProgram subclass category. */
+@interface SPProgram (Subclasses)
+
+/// Called as soon as the program is ready, i.e. within the initializer of a synchronous program,
+/// or later on the main thread. Subclasses can override it to look up their uniform and
+/// attribute locations; always call super.
+- (void)didBecomeReady;
+
+@end
+
 NS_ASSUME_NONNULL_END
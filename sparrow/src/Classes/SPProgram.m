@@ -9,9 +9,26 @@
 //  it under the terms of the Simplified BSD License.
 //
 
+#import "SparrowClass.h"
 #import "SPMacros.h"
 #import "SPOpenGL.h"
 #import "SPProgram.h"
+#import "SPProgramCache.h"
+
+// --- private types -------------------------------------------------------------------------------
+
+#define MAX_UNIFORM_SIZE 16
+
+typedef struct
+{
+    float values[MAX_UNIFORM_SIZE];
+    int size;
+} SPUniformValue;
+
+// the attributes that are shared by most programs, with the locations they are bound to
+static const char *const SPFixedAttributes[] = { "aPosition", "aColor", "aTexCoords" };
+
+// --- class implementation ------------------------------------------------------------------------
 
 @implementation SPProgram
 {
@@ -20,28 +37,66 @@
     NSString *_fragmentShader;
     NSMutableDictionary *_uniforms;
     NSMutableDictionary *_attributes;
+    SPUniformValue *_uniformValues;
+    int _numUniformValues;
+    NSInteger _numUniformUploads;
+    NSInteger _numSkippedUniformUploads;
+    BOOL _ready;
 }
 
 #pragma mark Initialization
 
 - (instancetype)initWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader
+                        asynchronous:(BOOL)async
 {
     if ((self = [super init]))
     {
+        SPViewController *controller = Sparrow.currentController;
+        SPProgramCache *cache = controller.programCache;
+        
         _vertexShader = [vertexShader copy];
         _fragmentShader = [fragmentShader copy];
         
-        [self compile];
-        [self updateUniforms];
-        [self updateAttributes];
+        if (async && controller)
+        {
+            [controller executeInResourceQueue:^
+             {
+                 [self compileWithCache:cache];
+                 [self updateUniforms];
+                 [self updateAttributes];
+                 
+                 // the other contexts of the sharegroup only see the program after a flush
+                 glFlush();
+                 
+                 dispatch_async(dispatch_get_main_queue(), ^
+                  {
+                      _ready = YES;
+                      [self didBecomeReady];
+                  });
+             }];
+        }
+        else
+        {
+            [self compileWithCache:cache];
+            [self updateUniforms];
+            [self updateAttributes];
+            
+            _ready = YES;
+            [self didBecomeReady];
+        }
     }
     
     return self;
 }
 
+- (instancetype)initWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader
+{
+    return [self initWithVertexShader:vertexShader fragmentShader:fragmentShader asynchronous:NO];
+}
+
 - (instancetype)init
 {
-    SP_USE_DESIGNATED_INITIALIZER(initWithVertexShader:fragmentShader:);
+    SP_USE_DESIGNATED_INITIALIZER(initWithVertexShader:fragmentShader:asynchronous:);
     return nil;
 }
 
@@ -53,6 +108,7 @@
     [_fragmentShader release];
     [_uniforms release];
     [_attributes release];
+    free(_uniformValues);
     [super dealloc];
 }
 
@@ -60,12 +116,71 @@
 
 - (int)uniformByName:(NSString *)name
 {
-    return [_uniforms[name] intValue];
+    return _ready ? [_uniforms[name] intValue] : -1;
 }
 
 - (int)attributeByName:(NSString *)name
 {
-    return [_attributes[name] intValue];
+    return _ready ? [_attributes[name] intValue] : -1;
+}
+
+- (void)setMatrix4:(const float *)matrix forUniform:(int)location
+{
+    if ([self updateUniform:location values:matrix size:16])
+        glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+}
+
+- (void)setVector4:(const float *)vector forUniform:(int)location
+{
+    if ([self updateUniform:location values:vector size:4])
+        glUniform4fv(location, 1, vector);
+}
+
+- (void)setVector2:(const float *)vector forUniform:(int)location
+{
+    if ([self updateUniform:location values:vector size:2])
+        glUniform2fv(location, 1, vector);
+}
+
+- (void)setFloat:(float)value forUniform:(int)location
+{
+    if ([self updateUniform:location values:&value size:1])
+        glUniform1f(location, value);
+}
+
+- (void)setInt:(int)value forUniform:(int)location
+{
+    if ([self updateUniform:location values:&value size:1])
+        glUniform1i(location, value);
+}
+
+#pragma mark Subclasses
+
+- (void)didBecomeReady
+{
+    // override in subclasses
+}
+
+#pragma mark Properties
+
+- (uint)name
+{
+    return _ready ? _name : 0;
+}
+
+- (BOOL)isReady
+{
+    return _ready;
+}
+
+- (NSInteger)numUniformUploads
+{
+    return _numUniformUploads;
+}
+
+- (NSInteger)numSkippedUniformUploads
+{
+    return _numSkippedUniformUploads;
 }
 
 #pragma mark NSObject
@@ -79,15 +194,29 @@
 
 #pragma mark Private
 
-- (void)compile
+- (void)compileWithCache:(SPProgramCache *)cache
 {
-    uint program = glCreateProgram();
+    uint program = [cache createProgramWithVertexShader:_vertexShader fragmentShader:_fragmentShader];
+    
+    if (program)
+    {
+        _name = program;
+        return;
+    }
+    
+    program = glCreateProgram();
     uint vertexShader   = [self compileShader:_vertexShader type:GL_VERTEX_SHADER];
     uint fragmentShader = [self compileShader:_fragmentShader type:GL_FRAGMENT_SHADER];
     
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
     
+    // fixed locations allow vertex data that was set up for one program to be used with another
+    // one, e.g. in consecutive passes of a filter
+    for (uint i=0; i<sizeof(SPFixedAttributes) / sizeof(SPFixedAttributes[0]); ++i)
+        glBindAttribLocation(program, i, SPFixedAttributes[i]);
+    
+    [cache prepareProgramForStorage:program];
     glLinkProgram(program);
     
   #if DEBUG
@@ -117,6 +246,7 @@
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
     
+    [cache storeProgram:program vertexShader:_vertexShader fragmentShader:_fragmentShader];
     _name = program;
 }
 
@@ -163,6 +293,7 @@
 {
     const int MAX_NAME_LENGTH = 64;
     char rawName[MAX_NAME_LENGTH];
+    int maxLocation = -1;
     
     int numUniforms = 0;
     glGetProgramiv(_name, GL_ACTIVE_UNIFORMS, &numUniforms);
@@ -174,9 +305,40 @@
     {
         glGetActiveUniform(_name, i, MAX_NAME_LENGTH, NULL, NULL, NULL, rawName);
         NSString *name = [[NSString alloc] initWithCString:rawName encoding:NSUTF8StringEncoding];
-        _uniforms[name] = @(glGetUniformLocation(_name, rawName));
+        int location = glGetUniformLocation(_name, rawName);
+        _uniforms[name] = @(location);
+        maxLocation = MAX(maxLocation, location);
         [name release];
     }
+    
+    // the shadow copies of the uniform values are indexed by location
+    free(_uniformValues);
+    _numUniformValues = maxLocation + 1;
+    _uniformValues = calloc(_numUniformValues, sizeof(SPUniformValue));
+}
+
+- (BOOL)updateUniform:(int)location values:(const void *)values size:(int)size
+{
+    if (location < 0)
+        return NO; // GL would ignore the call anyway
+    
+    if (location < _numUniformValues)
+    {
+        SPUniformValue *uniform = &_uniformValues[location];
+        size_t numBytes = sizeof(float) * size;
+        
+        if (uniform->size == size && memcmp(uniform->values, values, numBytes) == 0)
+        {
+            ++_numSkippedUniformUploads;
+            return NO;
+        }
+        
+        memcpy(uniform->values, values, numBytes);
+        uniform->size = size;
+    }
+    
+    ++_numUniformUploads;
+    return YES;
 }
 
 - (void)updateAttributes
@@ -0,0 +1,80 @@
+//
+//  SPProgramCache.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 19.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPProgramCache stores linked shader programs on disk, so that they don't have to be compiled
+ from source again the next time the app is started.
+
+ The binaries are stored per program, keyed by a hash of the shader sources and of the driver that
+ created them; thus, a system update just leads to new binaries. A binary that can't be loaded any
+ longer is deleted and replaced the next time the program is compiled.
+
+ Program binaries require an OpenGL ES 3 context whose driver supports at least one binary format.
+ On other contexts, the cache has no effect, and programs are compiled from source as usual. Note
+ that the iOS drivers typically report no binary formats at all (`GL_NUM_PROGRAM_BINARY_FORMATS`
+ is 0); check `isSupported` before relying on the cache. `warmUpPrograms` is useful either way,
+ since it moves the compilation in front of the first frame.
+
+ SPViewController uses a program cache by default; SPProgram consults it whenever a program is
+ created. To make sure all of Sparrow's programs are available before the first frame, call
+ `[SPViewController warmUpPrograms]`.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPProgramCache : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a program cache that stores its binaries in the given directory. The directory is
+/// created when the first binary is stored. _Designated Initializer_.
+- (instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+
+/// Initializes a program cache in the 'Caches' directory of the app.
+- (instancetype)init;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Creates a program from the binary that was stored for the given sources. Returns 0 if there
+/// is no such binary, or if it can't be loaded by the current driver.
+- (uint)createProgramWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader;
+
+/// Call this method on a program before linking it, so that the driver keeps its binary around.
+- (void)prepareProgramForStorage:(uint)program;
+
+/// Stores the binary of a linked program under the given sources.
+- (void)storeProgram:(uint)program vertexShader:(NSString *)vertexShader
+      fragmentShader:(NSString *)fragmentShader;
+
+/// Deletes all binaries of the cache.
+- (void)purge;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The directory the binaries are stored in.
+@property (nonatomic, readonly) NSString *path;
+
+/// Indicates if the current context supports program binaries.
+@property (nonatomic, readonly) BOOL isSupported;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,182 @@
+//
+//  SPProgramCache.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 19.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPContext.h"
+#import "SPMacros.h"
+#import "SPOpenGL.h"
+#import "SPProgramCache.h"
+
+#define BINARY_MAGIC 0x53505042 // 'SPPB'
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t format;
+} SPProgramBinaryHeader;
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static uint64_t hashBytes(uint64_t hash, const char *bytes, size_t length)
+{
+    // 64 bit FNV-1a
+    for (size_t i=0; i<length; ++i)
+    {
+        hash ^= (uint8_t)bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t hashString(uint64_t hash, const char *string)
+{
+    // the terminating zero separates subsequent strings
+    return string ? hashBytes(hash, string, strlen(string) + 1) : hash;
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPProgramCache
+{
+    NSString *_path;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithPath:(NSString *)path
+{
+    if ((self = [super init]))
+    {
+        _path = [path copy];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    NSString *cachesPath = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES)[0];
+    return [self initWithPath:[cachesPath stringByAppendingPathComponent:@"Sparrow/Programs"]];
+}
+
+- (void)dealloc
+{
+    [_path release];
+    [super dealloc];
+}
+
+#pragma mark Methods
+
+- (uint)createProgramWithVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader
+{
+    if (!self.isSupported) return 0;
+
+    NSString *binaryPath = [self binaryPathForVertexShader:vertexShader fragmentShader:fragmentShader];
+    NSData *data = [NSData dataWithContentsOfFile:binaryPath options:NSDataReadingMappedIfSafe error:nil];
+    if (data.length <= sizeof(SPProgramBinaryHeader)) return 0;
+
+    const SPProgramBinaryHeader *header = data.bytes;
+    int linked = 0;
+    uint program = 0;
+
+    if (header->magic == BINARY_MAGIC)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header->format, (const char *)data.bytes + sizeof(SPProgramBinaryHeader),
+                        (GLsizei)(data.length - sizeof(SPProgramBinaryHeader)));
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+
+    if (!linked)
+    {
+        // e.g. because the driver changed in a way its version doesn't reflect
+        SPLog(@"Discarding outdated program binary: %@", binaryPath.lastPathComponent);
+        [[NSFileManager defaultManager] removeItemAtPath:binaryPath error:nil];
+
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+- (void)prepareProgramForStorage:(uint)program
+{
+    if (self.isSupported)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+- (void)storeProgram:(uint)program vertexShader:(NSString *)vertexShader
+      fragmentShader:(NSString *)fragmentShader
+{
+    if (!self.isSupported) return;
+
+    int linked = 0;
+    int binaryLength = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (!linked || binaryLength <= 0) return;
+
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(SPProgramBinaryHeader) + binaryLength];
+    SPProgramBinaryHeader *header = data.mutableBytes;
+    GLenum format = 0;
+
+    glGetProgramBinary(program, binaryLength, &binaryLength, &format,
+                       (char *)data.mutableBytes + sizeof(SPProgramBinaryHeader));
+    if (binaryLength <= 0) return;
+
+    header->magic = BINARY_MAGIC;
+    header->format = format;
+    data.length = sizeof(SPProgramBinaryHeader) + binaryLength;
+
+    NSError *error = nil;
+    NSString *binaryPath = [self binaryPathForVertexShader:vertexShader fragmentShader:fragmentShader];
+
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:_path withIntermediateDirectories:YES
+                                                    attributes:nil error:&error] ||
+        ![data writeToFile:binaryPath options:NSDataWritingAtomic error:&error])
+    {
+        SPLog(@"Could not store program binary: %@", error.localizedDescription);
+    }
+}
+
+- (void)purge
+{
+    [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+}
+
+#pragma mark Properties
+
+- (BOOL)isSupported
+{
+    SPContext *context = SPContext.currentContext;
+    if (context.API != SPRenderingAPIOpenGLES3) return NO;
+
+    int numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    return numFormats > 0;
+}
+
+#pragma mark Private
+
+- (NSString *)binaryPathForVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader
+{
+    // a binary is only valid for the driver that created it
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = hashString(hash, (const char *)glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char *)glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char *)glGetString(GL_VERSION));
+    hash = hashString(hash, vertexShader.UTF8String);
+    hash = hashString(hash, fragmentShader.UTF8String);
+
+    NSString *filename = [NSString stringWithFormat:@"%016llx.bin", (unsigned long long)hash];
+    return [_path stringByAppendingPathComponent:filename];
+}
+
+@end
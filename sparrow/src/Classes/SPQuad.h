@@ -110,7 +110,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)copyTransformedVertexDataTo:(SPVertexData *)targetData atIndex:(NSInteger)targetIndex
                              matrix:(nullable SPMatrix *)matrix;
 
-/// Call this method after manually changing the contents of '_vertexData'.
+/// Call this method after manually changing the contents of '_vertexData'. Subclasses that
+/// override it must call the implementation of the superclass.
 - (void)vertexDataDidChange;
 
 /// ----------------
@@ -131,7 +131,7 @@
 
 - (void)vertexDataDidChange
 {
-    // override in subclass
+    [self setRequiresRedraw];
 }
 
 #pragma mark NSCopying
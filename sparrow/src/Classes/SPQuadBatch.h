@@ -14,6 +14,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPColorMatrix;
+@class SPDistanceFieldStyle;
 @class SPImage;
 @class SPQuad;
 @class SPTexture;
@@ -112,9 +114,16 @@ NS_ASSUME_NONNULL_BEGIN
 /// Indicates if specific quads can be added to the batch without causing a state change.
 /// A state change occurs if the quad uses a different base texture, has a different `smoothing`,
 /// `repeat` or 'tinted' setting, or if the batch is full (one batch can contain up to 8192 quads).
+/// The quads must not have a distance field style.
 - (BOOL)isStateChangeWithTinted:(BOOL)tinted texture:(SPTexture *)texture alpha:(float)alpha
              premultipliedAlpha:(BOOL)pma blendMode:(uint)blendMode numQuads:(NSInteger)numQuads;
 
+/// Indicates if specific quads can be added to the batch without causing a state change. In
+/// addition to the checks above, the quads must have an equal distance field style.
+- (BOOL)isStateChangeWithTinted:(BOOL)tinted texture:(SPTexture *)texture alpha:(float)alpha
+             premultipliedAlpha:(BOOL)pma blendMode:(uint)blendMode
+             distanceFieldStyle:(nullable SPDistanceFieldStyle *)style numQuads:(NSInteger)numQuads;
+
 /// Renders the batch with custom alpha and blend mode values, as well as a custom mvp matrix.
 - (void)renderWithMvpMatrix:(SPMatrix *)matrix alpha:(float)alpha blendMode:(uint)blendMode SP_DEPRECATED;
 
@@ -209,6 +218,17 @@ NS_ASSUME_NONNULL_BEGIN
 /// Indicates if the rgb values are stored premultiplied with the alpha value.
 @property (nonatomic, readonly) BOOL premultipliedAlpha;
 
+/// A color matrix that is applied to all quads when the batch is rendered, or `nil` if there is
+/// none. When the batch is drawn through `render:`, the color matrix of the render support is
+/// used. Default: nil
+@property (nonatomic, copy, nullable) SPColorMatrix *colorMatrix;
+
+/// The style with which the texture is rendered if it contains a distance field, or `nil` for
+/// regular textures. An empty batch takes over the style of the first batch that's added to it;
+/// batches with equal styles can be combined. The style is copied; to change it, modify the
+/// returned style and assign it anew. Default: nil
+@property (nonatomic, copy, nullable) SPDistanceFieldStyle *distanceFieldStyle;
+
 /// Indicates if the batch itself should be batched on rendering. This makes sense only
 /// if it contains only a small number of quads (we recommend no more than 16). Otherwise,
 /// the CPU costs will exceed any gains you get from avoiding the additional draw call.
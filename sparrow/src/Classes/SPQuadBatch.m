@@ -11,14 +11,18 @@
 
 #import "SPBaseEffect.h"
 #import "SPBlendMode.h"
+#import "SPColorMatrix.h"
 #import "SPContext.h"
+#import "SPDisplayObject_Internal.h"
 #import "SPDisplayObjectContainer.h"
+#import "SPDistanceFieldStyle.h"
 #import "SPImage.h"
 #import "SPMacros.h"
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPOpenGL.h"
 #import "SPQuadBatch.h"
+#import "SPQuadBatch_Internal.h"
 #import "SPRenderSupport.h"
 #import "SPSprite.h"
 #import "SPSprite3D.h"
@@ -37,6 +41,7 @@
     BOOL _tinted;
     BOOL _forceTinted;
     BOOL _batchable;
+    SPDistanceFieldStyle *_distanceFieldStyle;
     
     SPBaseEffect *_baseEffect;
     uint _vertexBufferName;
@@ -76,6 +81,7 @@
     glDeleteBuffers(1, &_indexBufferName);
 
     [_texture release];
+    [_distanceFieldStyle release];
     [_vertexData release];
     [_baseEffect release];
     [super dealloc];
@@ -90,15 +96,16 @@
 
 - (void)onVertexDataChanged
 {
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (void)reset
 {
     _numQuads = 0;
-    _syncRequired = YES;
+    [self quadsDidChange];
     _baseEffect.texture = nil;
     SP_RELEASE_AND_NIL(_texture);
+    SP_RELEASE_AND_NIL(_distanceFieldStyle);
 }
 
 - (void)addQuad:(SPQuad *)quad
@@ -123,6 +130,7 @@
     if (_numQuads == 0)
     {
         SP_RELEASE_AND_RETAIN(_texture, quad.texture);
+        SP_RELEASE_AND_NIL(_distanceFieldStyle);
         _premultipliedAlpha = quad.premultipliedAlpha;
         self.blendMode = blendMode;
         [_vertexData setPremultipliedAlpha:_premultipliedAlpha updateVertices:NO];
@@ -137,7 +145,7 @@
     if (!_tinted)
         _tinted = _forceTinted || alpha != 1.0f || quad.tinted;
     
-    _syncRequired = YES;
+    [self quadsDidChange];
     _numQuads++;
 }
 
@@ -168,6 +176,7 @@
     if (_numQuads == 0)
     {
         SP_RELEASE_AND_RETAIN(_texture, quadBatch.texture);
+        SP_RELEASE_AND_COPY(_distanceFieldStyle, quadBatch->_distanceFieldStyle);
         _premultipliedAlpha = quadBatch.premultipliedAlpha;
         self.blendMode = blendMode;
         [_vertexData setPremultipliedAlpha:_premultipliedAlpha updateVertices:NO];
@@ -182,15 +191,24 @@
     if (!_tinted)
         _tinted = _forceTinted || alpha != 1.0f || quadBatch.tinted;
     
-    _syncRequired = YES;
+    [self quadsDidChange];
     _numQuads += numQuads;
 }
 
 - (BOOL)isStateChangeWithTinted:(BOOL)tinted texture:(SPTexture *)texture alpha:(float)alpha
              premultipliedAlpha:(BOOL)pma blendMode:(uint)blendMode numQuads:(NSInteger)numQuads
+{
+    return [self isStateChangeWithTinted:tinted texture:texture alpha:alpha premultipliedAlpha:pma
+                               blendMode:blendMode distanceFieldStyle:nil numQuads:numQuads];
+}
+
+- (BOOL)isStateChangeWithTinted:(BOOL)tinted texture:(SPTexture *)texture alpha:(float)alpha
+             premultipliedAlpha:(BOOL)pma blendMode:(uint)blendMode
+             distanceFieldStyle:(SPDistanceFieldStyle *)style numQuads:(NSInteger)numQuads
 {
     if (_numQuads == 0) return NO;
     else if (_numQuads + numQuads > 8192) return YES; // maximum buffer size
+    else if (style != _distanceFieldStyle && ![style isEqualToStyle:_distanceFieldStyle]) return YES;
     else if (!_texture && !texture)
         return _premultipliedAlpha != pma || self.blendMode != blendMode;
     else if (_texture && texture)
@@ -220,6 +238,17 @@
     if (!_numQuads)
         return;
     
+    _baseEffect.texture = _texture;
+    _baseEffect.premultipliedAlpha = _premultipliedAlpha;
+    _baseEffect.mvpMatrix3D = matrix;
+    _baseEffect.useTinting = _tinted || alpha != 1.0f;
+    _baseEffect.alpha = alpha;
+    _baseEffect.distanceFieldStyle = _distanceFieldStyle;
+    
+    // the program might still be compiling
+    if (![_baseEffect prepareToDraw])
+        return;
+    
     SPExecuteWithDebugMarker("QuadBatch")
     {
         if (_syncRequired) [self syncBuffers];
@@ -227,14 +256,6 @@
             [NSException raise:SPExceptionInvalidOperation
                         format:@"cannot render object with blend mode SPBlendModeAuto"];
         
-        _baseEffect.texture = _texture;
-        _baseEffect.premultipliedAlpha = _premultipliedAlpha;
-        _baseEffect.mvpMatrix3D = matrix;
-        _baseEffect.useTinting = _tinted || alpha != 1.0f;
-        _baseEffect.alpha = alpha;
-        
-        [_baseEffect prepareToDraw];
-        
         [SPBlendMode applyBlendFactorsForBlendMode:blendMode premultipliedAlpha:_premultipliedAlpha];
         
         int attribPosition  = _baseEffect.attribPosition;
@@ -272,7 +293,7 @@
 - (void)transformQuadAtIndex:(NSInteger)index withMatrix:(SPMatrix *)matrix
 {
     [_vertexData transformVerticesWithMatrix:matrix atIndex:index * 4 numVertices:4];
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (uint)vertexColorOfQuadAtIndex:(NSInteger)quadID vertexID:(NSInteger)vertexID
@@ -283,7 +304,7 @@
 - (void)setVertexColor:(uint)color atIndex:(NSInteger)quadID vertexID:(NSInteger)vertexID
 {
     [_vertexData setColor:color atIndex:quadID * 4 + vertexID];
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (float)vertexAlphaAtIndex:(NSInteger)quadID vertexID:(NSInteger)vertexID
@@ -294,7 +315,7 @@
 - (void)setVertexAlpha:(float)alpha atIndex:(NSInteger)quadID vertexID:(NSInteger)vertexID
 {
     [_vertexData setAlpha:alpha atIndex:quadID * 4 + vertexID];
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (uint)quadColorAtIndex:(NSInteger)quadID
@@ -307,7 +328,7 @@
     for (NSInteger i=0; i<4; ++i)
         [_vertexData setColor:color atIndex:quadID * 4 + i];
     
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (float)quadAlphaAtIndex:(NSInteger)quadID
@@ -320,7 +341,7 @@
     for (NSInteger i=0; i<4; ++i)
         [_vertexData setAlpha:alpha atIndex:quadID * 4 + i];
     
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (void)setQuad:(SPQuad *)quad atIndex:(NSInteger)quadID
@@ -333,7 +354,7 @@
     [_vertexData transformVerticesWithMatrix:matrix atIndex:vertexID numVertices:4];
     if (alpha != 1.0) [_vertexData scaleAlphaBy:alpha atIndex:vertexID numVertices:4];
     
-    _syncRequired = YES;
+    [self quadsDidChange];
 }
 
 - (SPRectangle *)boundsOfQuadAtIndex:(NSInteger)quadID
@@ -348,6 +369,38 @@
 
 #pragma mark Properties
 
+- (SPColorMatrix *)colorMatrix
+{
+    return _baseEffect.colorMatrix;
+}
+
+- (void)setColorMatrix:(SPColorMatrix *)colorMatrix
+{
+    // flattened sprites assign the matrix of the render support each frame; that must not
+    // invalidate the caches of filters.
+    SPColorMatrix *currentMatrix = _baseEffect.colorMatrix;
+    BOOL isEqual = colorMatrix == currentMatrix || (colorMatrix && currentMatrix &&
+        memcmp(colorMatrix.values, currentMatrix.values, sizeof(float) * colorMatrix.numValues) == 0);
+
+    if (!isEqual)
+    {
+        _baseEffect.colorMatrix = colorMatrix;
+        [self setRequiresRedraw];
+    }
+}
+
+- (void)setDistanceFieldStyle:(SPDistanceFieldStyle *)distanceFieldStyle
+{
+    if (!distanceFieldStyle && !_distanceFieldStyle) return;
+
+    // the current instance might have been changed since it was assigned
+    if (distanceFieldStyle == _distanceFieldStyle || ![distanceFieldStyle isEqualToStyle:_distanceFieldStyle])
+    {
+        SP_RELEASE_AND_COPY(_distanceFieldStyle, distanceFieldStyle);
+        [self setRequiresRedraw];
+    }
+}
+
 - (BOOL)tinted
 {
     return _tinted || _forceTinted;
@@ -396,6 +449,7 @@
     quadBatch->_tinted = _tinted;
     quadBatch->_forceTinted = _forceTinted;
     quadBatch->_texture = [_texture retain];
+    quadBatch->_distanceFieldStyle = [_distanceFieldStyle copy];
     quadBatch->_syncRequired = YES;
     
     [_vertexData copyToVertexData:quadBatch->_vertexData];
@@ -421,6 +475,7 @@
         {
             [support finishQuadBatch];
             [support addDrawCalls:1];
+            self.colorMatrix = support.colorMatrix;
             [self renderWithMvpMatrix3D:support.mvpMatrix3D alpha:support.alpha blendMode:support.blendMode];
         }
     }
@@ -455,7 +510,7 @@
             batch2 = quadBatches[j];
             if (![batch1 isStateChangeWithTinted:batch2.tinted texture:batch2.texture alpha:batch2.alpha
                               premultipliedAlpha:batch2.premultipliedAlpha blendMode:batch2.blendMode
-                                        numQuads:batch2.numQuads])
+                              distanceFieldStyle:batch2.distanceFieldStyle numQuads:batch2.numQuads])
             {
                 [batch1 addQuadBatch:batch2];
                 [quadBatches removeObjectAtIndex:j];
@@ -521,12 +576,14 @@
         SPTexture *texture = (SPTexture *)[(id)object texture];
         BOOL tinted = [(id)object tinted];
         BOOL pma = [(id)object premultipliedAlpha];
+        SPDistanceFieldStyle *style = batch.distanceFieldStyle;
         NSInteger numQuads = batch ? batch.numQuads : 1;
         
         SPQuadBatch *currentBatch = quadBatches[quadBatchID];
         
         if ([currentBatch isStateChangeWithTinted:tinted texture:texture alpha:alpha * objectAlpha
-                               premultipliedAlpha:pma blendMode:blendMode numQuads:numQuads])
+                               premultipliedAlpha:pma blendMode:blendMode
+                               distanceFieldStyle:style numQuads:numQuads])
         {
             quadBatchID++;
             if (quadBatches.count <= quadBatchID) [quadBatches addObject:[SPQuadBatch quadBatch]];
@@ -559,6 +616,16 @@
 
 #pragma mark Private
 
+- (void)quadsDidChange
+{
+    _syncRequired = YES;
+
+    // the batches of the render support are filled every frame, but they are never part of the
+    // display list: nobody is interested in their version.
+    if (self.parent || self.filter || self.isMask)
+        [self setRequiresRedraw];
+}
+
 - (void)expand
 {
     NSInteger oldCapacity = self.capacity;
@@ -618,3 +685,46 @@
 }
 
 @end
+
+@implementation SPQuadBatch (Internal)
+
+- (SPVertex *)appendQuads:(NSInteger)numQuads texture:(SPTexture *)texture tinted:(BOOL)tinted
+{
+    while (_numQuads + numQuads > self.capacity) [self expand];
+    if (_numQuads == 0)
+    {
+        SP_RELEASE_AND_RETAIN(_texture, texture);
+        SP_RELEASE_AND_NIL(_distanceFieldStyle);
+        _premultipliedAlpha = texture.premultipliedAlpha;
+        self.blendMode = SPBlendModeAuto;
+        [_vertexData setPremultipliedAlpha:_premultipliedAlpha updateVertices:NO];
+    }
+
+    if (!_tinted)
+        _tinted = _forceTinted || tinted;
+
+    SPVertex *vertices = _vertexData.vertices + _numQuads * 4;
+
+    [self quadsDidChange];
+    _numQuads += numQuads;
+
+    return vertices;
+}
+
+- (void)truncateToNumQuads:(NSInteger)numQuads
+{
+    if (numQuads >= _numQuads) return;
+
+    _numQuads = MAX(0, numQuads);
+    [self quadsDidChange];
+}
+
+- (void)transformQuadsWithMatrix:(SPMatrix *)matrix atIndex:(NSInteger)index numQuads:(NSInteger)numQuads
+{
+    if (numQuads <= 0) return;
+
+    [_vertexData transformVerticesWithMatrix:matrix atIndex:index * 4 numVertices:numQuads * 4];
+    [self quadsDidChange];
+}
+
+@end
@@ -0,0 +1,34 @@
+//
+//  SPQuadBatch_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import "SPQuadBatch.h"
+#import "SPVertexData.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SPQuadBatch (Internal)
+
+/// Makes room for a number of textured quads and returns a pointer to their vertices, which the
+/// caller has to fill in completely (4 per quad). If the batch is empty, it takes over the state
+/// of the texture (without a distance field style); otherwise, the texture must not cause a state
+/// change.
+- (SPVertex *)appendQuads:(NSInteger)numQuads texture:(SPTexture *)texture tinted:(BOOL)tinted;
+
+/// Removes all quads behind a certain index, keeping the state of the batch.
+- (void)truncateToNumQuads:(NSInteger)numQuads;
+
+/// Transforms the vertices of a range of quads with a certain matrix.
+- (void)transformQuadsWithMatrix:(SPMatrix *)matrix atIndex:(NSInteger)index numQuads:(NSInteger)numQuads;
+
+@end
+
+NS_ASSUME_NONNULL_END
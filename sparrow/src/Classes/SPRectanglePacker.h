@@ -0,0 +1,77 @@
+//
+//  SPRectanglePacker.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPRectangle;
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPRectanglePacker distributes rectangles within a bin of a fixed size, e.g. the images on the
+ pages of an SPDynamicAtlas.
+
+ The packer uses the "MaxRects" algorithm (with the "best short side fit" heuristic), as
+ described by Jukka Jylänki in "A Thousand Ways to Pack the Bin". It keeps track of all maximal
+ free rectangles of the bin; a new rectangle is placed into the free one it fits best.
+
+ Rectangles can be freed again. Adjacent free rectangles are merged, but over time, the free space
+ will fragment; in that case, it's best to reset the packer and insert all rectangles again,
+ largest first.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPRectanglePacker : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes an empty packer with the size of its bin. _Designated Initializer_.
+- (instancetype)initWithWidth:(float)width height:(float)height;
+
+/// Factory method.
++ (instancetype)packerWithWidth:(float)width height:(float)height;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Finds a place for a rectangle of the given size and marks it as used. Returns `nil` if there
+/// is no free area that is big enough.
+- (nullable SPRectangle *)allocateRectangleWithWidth:(float)width height:(float)height;
+
+/// Marks a rectangle that was returned by `allocateRectangleWithWidth:height:` as free again.
+- (void)freeRectangle:(SPRectangle *)rectangle;
+
+/// Marks the complete bin as free.
+- (void)reset;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The width of the bin.
+@property (nonatomic, readonly) float width;
+
+/// The height of the bin.
+@property (nonatomic, readonly) float height;
+
+/// The ratio of the used area to the area of the bin, between 0 and 1.
+@property (nonatomic, readonly) float occupancy;
+
+/// The number of maximal free rectangles; a high number indicates fragmentation.
+@property (nonatomic, readonly) NSInteger numFreeRectangles;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,276 @@
+//
+//  SPRectanglePacker.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPRectangle.h"
+#import "SPRectanglePacker.h"
+
+typedef struct
+{
+    float x, y, width, height;
+} SPPackerRect;
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static SPPackerRect makePackerRect(float x, float y, float width, float height)
+{
+    SPPackerRect rect = { x, y, width, height };
+    return rect;
+}
+
+static BOOL intersects(SPPackerRect a, SPPackerRect b)
+{
+    return a.x < b.x + b.width  && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static BOOL contains(SPPackerRect outer, SPPackerRect inner)
+{
+    return inner.x >= outer.x && inner.x + inner.width  <= outer.x + outer.width &&
+           inner.y >= outer.y && inner.y + inner.height <= outer.y + outer.height;
+}
+
+static BOOL isValid(SPPackerRect rect)
+{
+    // rectangles that are about to be removed are marked with a negative width
+    return rect.width >= 0.0f;
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPRectanglePacker
+{
+    float _width;
+    float _height;
+    float _usedArea;
+    SPPackerRect *_freeRects;
+    NSInteger _numFreeRects;
+    NSInteger _capacity;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithWidth:(float)width height:(float)height
+{
+    if ((self = [super init]))
+    {
+        _width = width;
+        _height = height;
+        [self reset];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithWidth:0.0f height:0.0f];
+}
+
+- (void)dealloc
+{
+    free(_freeRects);
+    [super dealloc];
+}
+
++ (instancetype)packerWithWidth:(float)width height:(float)height
+{
+    return [[[self alloc] initWithWidth:width height:height] autorelease];
+}
+
+#pragma mark Methods
+
+- (SPRectangle *)allocateRectangleWithWidth:(float)width height:(float)height
+{
+    NSInteger bestIndex = -1;
+    float bestShortSide = FLT_MAX;
+    float bestLongSide  = FLT_MAX;
+
+    for (NSInteger i=0; i<_numFreeRects; ++i)
+    {
+        SPPackerRect freeRect = _freeRects[i];
+        if (freeRect.width < width || freeRect.height < height) continue;
+
+        float leftoverX = freeRect.width  - width;
+        float leftoverY = freeRect.height - height;
+        float shortSide = MIN(leftoverX, leftoverY);
+        float longSide  = MAX(leftoverX, leftoverY);
+
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+        {
+            bestIndex = i;
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+        }
+    }
+
+    if (bestIndex < 0) return nil;
+
+    SPPackerRect usedRect = makePackerRect(_freeRects[bestIndex].x, _freeRects[bestIndex].y, width, height);
+    [self splitFreeRectsWithUsedRect:usedRect];
+    [self pruneFreeRects];
+
+    _usedArea += width * height;
+    return [SPRectangle rectangleWithX:usedRect.x y:usedRect.y width:width height:height];
+}
+
+- (void)freeRectangle:(SPRectangle *)rectangle
+{
+    [self addFreeRect:makePackerRect(rectangle.x, rectangle.y, rectangle.width, rectangle.height)];
+    [self mergeFreeRects];
+    [self pruneFreeRects];
+
+    _usedArea = MAX(0.0f, _usedArea - rectangle.width * rectangle.height);
+}
+
+- (void)reset
+{
+    _numFreeRects = 0;
+    _usedArea = 0.0f;
+
+    [self addFreeRect:makePackerRect(0.0f, 0.0f, _width, _height)];
+}
+
+#pragma mark Properties
+
+- (float)occupancy
+{
+    float area = _width * _height;
+    return area > 0.0f ? _usedArea / area : 0.0f;
+}
+
+- (NSInteger)numFreeRectangles
+{
+    return _numFreeRects;
+}
+
+#pragma mark Private
+
+- (void)addFreeRect:(SPPackerRect)rect
+{
+    if (_numFreeRects == _capacity)
+    {
+        _capacity = MAX(16, _capacity * 2);
+        _freeRects = realloc(_freeRects, sizeof(SPPackerRect) * _capacity);
+    }
+
+    _freeRects[_numFreeRects++] = rect;
+}
+
+- (void)splitFreeRectsWithUsedRect:(SPPackerRect)used
+{
+    // every free rectangle that overlaps the used one is replaced by its (up to four) maximal
+    // parts that remain free.
+
+    NSInteger numRects = _numFreeRects;
+
+    for (NSInteger i=0; i<numRects; ++i)
+    {
+        SPPackerRect rect = _freeRects[i];
+        if (!intersects(rect, used)) continue;
+
+        float rectRight = rect.x + rect.width;
+        float rectBottom = rect.y + rect.height;
+        float usedRight = used.x + used.width;
+        float usedBottom = used.y + used.height;
+
+        if (used.x > rect.x)
+            [self addFreeRect:makePackerRect(rect.x, rect.y, used.x - rect.x, rect.height)];
+
+        if (usedRight < rectRight)
+            [self addFreeRect:makePackerRect(usedRight, rect.y, rectRight - usedRight, rect.height)];
+
+        if (used.y > rect.y)
+            [self addFreeRect:makePackerRect(rect.x, rect.y, rect.width, used.y - rect.y)];
+
+        if (usedBottom < rectBottom)
+            [self addFreeRect:makePackerRect(rect.x, usedBottom, rect.width, rectBottom - usedBottom)];
+
+        _freeRects[i].width = -1.0f;
+    }
+
+    [self removeInvalidFreeRects];
+}
+
+- (void)mergeFreeRects
+{
+    // unites free rectangles that share a complete edge
+    BOOL merged = YES;
+
+    while (merged)
+    {
+        merged = NO;
+
+        for (NSInteger i=0; i<_numFreeRects && !merged; ++i)
+        {
+            for (NSInteger j=i+1; j<_numFreeRects && !merged; ++j)
+            {
+                SPPackerRect *a = &_freeRects[i];
+                SPPackerRect b = _freeRects[j];
+
+                if (a->x == b.x && a->width == b.width &&
+                    (a->y + a->height == b.y || b.y + b.height == a->y))
+                {
+                    a->y = MIN(a->y, b.y);
+                    a->height += b.height;
+                    merged = YES;
+                }
+                else if (a->y == b.y && a->height == b.height &&
+                         (a->x + a->width == b.x || b.x + b.width == a->x))
+                {
+                    a->x = MIN(a->x, b.x);
+                    a->width += b.width;
+                    merged = YES;
+                }
+
+                if (merged)
+                {
+                    _freeRects[j].width = -1.0f;
+                    [self removeInvalidFreeRects];
+                }
+            }
+        }
+    }
+}
+
+- (void)pruneFreeRects
+{
+    // removes free rectangles that are contained in others; they are not maximal.
+    for (NSInteger i=0; i<_numFreeRects; ++i)
+    {
+        if (!isValid(_freeRects[i])) continue;
+
+        for (NSInteger j=i+1; j<_numFreeRects; ++j)
+        {
+            if (!isValid(_freeRects[j])) continue;
+
+            if (contains(_freeRects[j], _freeRects[i]))
+            {
+                _freeRects[i].width = -1.0f;
+                break;
+            }
+            else if (contains(_freeRects[i], _freeRects[j]))
+                _freeRects[j].width = -1.0f;
+        }
+    }
+
+    [self removeInvalidFreeRects];
+}
+
+- (void)removeInvalidFreeRects
+{
+    NSInteger numValidRects = 0;
+
+    for (NSInteger i=0; i<_numFreeRects; ++i)
+        if (isValid(_freeRects[i])) _freeRects[numValidRects++] = _freeRects[i];
+
+    _numFreeRects = numValidRects;
+}
+
+@end
@@ -14,6 +14,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPColorMatrix;
 @class SPDisplayObject;
 @class SPMatrix;
 @class SPMatrix3D;
@@ -22,6 +23,19 @@ NS_ASSUME_NONNULL_BEGIN
 @class SPQuadBatch;
 @class SPTexture;
 
+/// The strategies that can be used to remove a stencil mask from the stencil buffer.
+typedef NS_ENUM(NSInteger, SPMaskStrategy)
+{
+    /// Each nesting level uses its own bit of the stencil buffer; popping a mask clears that bit
+    /// within the mask's bounds. Supports up to 8 nested stencil masks; pushing a deeper one raises
+    /// an exception. Clipping rectangles don't count towards that limit.
+    SPMaskStrategyStencilBits,
+    
+    /// The mask is drawn again, decrementing the stencil buffer. Supports up to 255 nested
+    /// stencil masks, but needs one additional draw call per mask.
+    SPMaskStrategyRedraw
+};
+
 /** ------------------------------------------------------------------------------------------------
 
  A class that contains helper methods simplifying OpenGL rendering.
@@ -166,17 +180,23 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Stencil Masks
 /// -------------------
 
-/// Draws a display object into the stencil buffer, incrementing the buffer on each used pixel. The
+/// Draws a display object into the stencil buffer, marking each used pixel (depending on the
+/// `maskStrategy`, by setting the bit of the new nesting level or by incrementing the buffer). The
 /// stencil reference value is incremented as well; thus, any subsequent stencil tests outside of
 /// this area will fail.
 ///
 /// If 'mask' is part of the display list, it will be drawn at its conventional stage coordinates.
 /// Otherwise, it will be drawn with the current modelview matrix.
+///
+/// If the mask is a quad that is aligned with the axes (i.e. neither rotated by anything but a
+/// multiple of 90 degrees nor skewed, and not affected by 3D transformations), it is pushed as a
+/// clipping rectangle instead. In that case, the stencil buffer is not touched at all.
 - (void)pushMask:(SPDisplayObject *)mask;
 
-/// Redraws the most recently pushed mask into the stencil buffer, decrementing the buffer on each
-/// used pixel. This effectively removes the object from the stencil buffer, restoring the previous
-/// state. The stencil reference value will be decremented.
+/// Removes the most recently pushed mask from the stencil buffer, restoring the previous state.
+/// How that is done depends on the `maskStrategy`: either the mask's stencil bit is cleared, or the
+/// mask is redrawn, decrementing the buffer on each used pixel. The stencil reference value will be
+/// decremented. Masks that were pushed as a clipping rectangle simply pop that rectangle.
 - (void)popMask;
 
 /// ----------------
@@ -222,9 +242,29 @@ NS_ASSUME_NONNULL_BEGIN
 /// stencil mask stack. Only change this value if you know what you're doing.
 @property (nonatomic, assign) uint stencilReferenceValue;
 
+/// A color matrix that is applied to all quads that are batched from now on, or `nil` if there is
+/// none. Changing it finishes the current batch, unless the new matrix contains the same values.
+/// That's how `SPColorMatrixFilter` draws simple objects without a render texture.
+@property (nonatomic, strong, nullable) SPColorMatrix *colorMatrix;
+
+/// The strategy that is used to remove stencil masks from the stencil buffer. Must not be changed
+/// while masks are pushed. (Default: `SPMaskStrategyRedraw`)
+///
+/// `SPMaskStrategyStencilBits` saves one draw call per mask, but limits the nesting depth of
+/// stencil masks to 8 levels; choose it only if your content never nests them more deeply.
+@property (nonatomic, assign) SPMaskStrategy maskStrategy;
+
 /// Indicates the number of OpenGL ES draw calls since the last call to `nextFrame`.
 @property (nonatomic, readonly) NSInteger numDrawCalls;
 
+/// Indicates the number of quads that were drawn through the render support's quad batches since
+/// the last call to `nextFrame`.
+@property (nonatomic, readonly) NSInteger numQuads;
+
+/// Indicates the number of vertex bytes that were uploaded to the GPU by the render support's
+/// quad batches since the last call to `nextFrame`.
+@property (nonatomic, readonly) NSInteger numBytesUploaded;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,6 +11,7 @@
 
 #import "SparrowClass.h"
 #import "SPBlendMode.h"
+#import "SPColorMatrix.h"
 #import "SPContext.h"
 #import "SPDisplayObject.h"
 #import "SPMacros.h"
@@ -29,6 +30,7 @@
 #import "SPVertexData.h"
 
 #define RENDER_TARGET_NAME @"Sparrow.renderTarget"
+#define MAX_STENCIL_BITS 8
 
 #pragma mark - SPRenderState
 
@@ -81,6 +83,46 @@
 
 @end
 
+#pragma mark - SPMaskState
+
+@interface SPMaskState : NSObject
+@end
+
+@implementation SPMaskState
+{
+  @package
+    SPDisplayObject *_mask;
+    SPRectangle *_bounds;
+    SPMaskStrategy _strategy;
+    BOOL _isClipRect;
+    BOOL _hasBounds;
+}
+
+#pragma mark Initialization
+
+- (instancetype)init
+{
+    if ((self = [super init]))
+    {
+        _bounds = [[SPRectangle alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_mask release];
+    [_bounds release];
+    [super dealloc];
+}
+
++ (instancetype)maskState
+{
+    return [[[self alloc] init] autorelease];
+}
+
+@end
+
 #pragma mark - SPRenderSupport
 
 @implementation SPRenderSupport
@@ -90,6 +132,8 @@
     SPMatrix3D *_projectionMatrix3D;
     SPMatrix3D *_mvpMatrix3D;
     NSInteger _numDrawCalls;
+    NSInteger _numQuads;
+    NSInteger _numBytesUploaded;
 
     SP_GENERIC(NSMutableArray, SPRenderState*) *_stateStack;
     SPRenderState *_stateStackTop;
@@ -108,9 +152,11 @@
     SP_GENERIC(NSMutableArray, SPRectangle*) *_clipRectStack;
     NSInteger _clipRectStackSize;
     
-    SP_GENERIC(NSMutableArray, SPDisplayObject*) *_maskStack;
+    SP_GENERIC(NSMutableArray, SPMaskState*) *_maskStack;
     NSInteger _maskStackSize;
     uint _stencilReferenceValue;
+    SPMaskStrategy _maskStrategy;
+    SPColorMatrix *_colorMatrix;
 }
 
 #pragma mark Initialization
@@ -143,6 +189,7 @@
         
         _maskStack = [[NSMutableArray alloc] init];
         _maskStackSize = 0;
+        _maskStrategy = SPMaskStrategyRedraw;
 
         [self setProjectionMatrixWithX:0 y:0 width:320 height:480];
     }
@@ -161,6 +208,7 @@
     [_quadBatches release];
     [_clipRectStack release];
     [_maskStack release];
+    [_colorMatrix release];
     [super dealloc];
 }
 
@@ -285,6 +333,8 @@
     _stateStackIndex = 0;
     _quadBatchIndex = 0;
     _numDrawCalls = 0;
+    _numQuads = 0;
+    _numBytesUploaded = 0;
     _quadBatchTop = _quadBatches[0];
     _stateStackTop = _stateStack[0];
 }
@@ -324,7 +374,8 @@
     
     if ([_quadBatchTop isStateChangeWithTinted:quadBatch.tinted texture:quadBatch.texture
                                          alpha:quadBatch.alpha premultipliedAlpha:quadBatch.premultipliedAlpha
-                                     blendMode:quadBatch.blendMode numQuads:quadBatch.numQuads])
+                                     blendMode:quadBatch.blendMode distanceFieldStyle:quadBatch.distanceFieldStyle
+                                      numQuads:quadBatch.numQuads])
     {
         [self finishQuadBatch]; // next batch
     }
@@ -336,6 +387,13 @@
 {
     if (_quadBatchTop.numQuads)
     {
+        // the batch was modified since it was last drawn, so its complete vertex buffer is
+        // uploaded again (see 'SPQuadBatch syncBuffers').
+        _numQuads += _quadBatchTop.numQuads;
+        _numBytesUploaded += _quadBatchTop.capacity * 4 * sizeof(SPVertex);
+        
+        _quadBatchTop.colorMatrix = _colorMatrix;
+        
         if (_matrix3DStackSize == 0)
         {
             [_quadBatchTop renderWithMvpMatrix3D:_projectionMatrix3D];
@@ -540,39 +598,140 @@
 
 - (void)pushMask:(SPDisplayObject *)mask
 {
+    SPMatrix *matrix = [self transformationMatrixForMask:mask];
+    SPRectangle *bounds = matrix ? [[mask boundsInSpace:mask] boundsAfterTransformation:matrix] : nil;
+    BOOL isClipRect = bounds && [mask isKindOfClass:[SPQuad class]] && [self isAxisAlignedMatrix:matrix];
+    
+    // checked before any state is touched, so that the mask stack stays intact
+    if (!isClipRect && _maskStrategy == SPMaskStrategyStencilBits &&
+        _stencilReferenceValue >= MAX_STENCIL_BITS)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"Stencil masks can't be nested more than %d levels deep. "
+                           @"Use 'SPMaskStrategyRedraw' instead.", MAX_STENCIL_BITS];
+    
     SPPushDebugMarker("Mask");
     
-    [_maskStack addObject:mask];
+    if (_maskStack.count < _maskStackSize + 1)
+        [_maskStack addObject:[SPMaskState maskState]];
     
-    [self finishQuadBatch];
+    SPMaskState *maskState = _maskStack[_maskStackSize++];
+    
+    SP_RELEASE_AND_RETAIN(maskState->_mask, mask);
+    maskState->_strategy = _maskStrategy;
+    maskState->_hasBounds = bounds != nil;
+    maskState->_isClipRect = isClipRect;
+    
+    if (bounds) [maskState->_bounds copyFromRectangle:bounds];
     
-    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
-    glStencilFunc(GL_EQUAL, _stencilReferenceValue++, 0xff);
+    if (maskState->_isClipRect)
+    {
+        // an axis-aligned quad covers exactly the same area as a scissor rectangle
+        [self pushClipRect:bounds];
+        return;
+    }
     
-    [self drawMask:mask];
+    [self finishQuadBatch];
     
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-    glStencilFunc(GL_EQUAL, _stencilReferenceValue, 0xff);
+    if (maskState->_strategy == SPMaskStrategyStencilBits)
+    {
+        // each level owns one bit: set it wherever the bits of all parent levels are set
+        uint parentBits = (1 << _stencilReferenceValue) - 1;
+        uint levelBit = 1 << _stencilReferenceValue++;
+        
+        glStencilMask(levelBit);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+        glStencilFunc(GL_EQUAL, parentBits | levelBit, parentBits);
+        
+        [self drawMask:mask];
+        
+        glStencilMask(0xff);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+        glStencilFunc(GL_EQUAL, parentBits | levelBit, parentBits | levelBit);
+    }
+    else
+    {
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+        glStencilFunc(GL_EQUAL, _stencilReferenceValue++, 0xff);
+        
+        [self drawMask:mask];
+        
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+        glStencilFunc(GL_EQUAL, _stencilReferenceValue, 0xff);
+    }
 }
 
 - (void)popMask
 {
-    SPDisplayObject *mask = [[_maskStack lastObject] retain];
-    [_maskStack removeLastObject];
+    if (_maskStackSize == 0)
+        [NSException raise:SPExceptionInvalidOperation format:@"The mask stack must not be empty"];
     
-    [self finishQuadBatch];
+    SPMaskState *maskState = _maskStack[--_maskStackSize];
+    
+    if (maskState->_isClipRect)
+    {
+        [self popClipRect];
+    }
+    else if (maskState->_strategy == SPMaskStrategyStencilBits)
+    {
+        uint levelBit = 1 << --_stencilReferenceValue;
+        uint parentBits = levelBit - 1;
+        
+        // Instead of drawing the mask again, this level's bit is cleared. The bit was only set
+        // inside the mask, so it's enough to clear the (slightly enlarged) mask bounds.
+        if (maskState->_hasBounds)
+        {
+            [maskState->_bounds inflateXBy:1.0f yBy:1.0f];
+            [self pushClipRect:maskState->_bounds];
+        }
+        else [self finishQuadBatch];
+        
+        glStencilMask(levelBit);
+        glClearStencil(0);
+        glClear(GL_STENCIL_BUFFER_BIT);
+        glStencilMask(0xff);
+        glStencilFunc(GL_EQUAL, parentBits, parentBits);
+        
+        if (maskState->_hasBounds)
+            [self popClipRect];
+    }
+    else
+    {
+        [self finishQuadBatch];
+        
+        glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+        glStencilFunc(GL_EQUAL, _stencilReferenceValue--, 0xff);
+        
+        [self drawMask:maskState->_mask];
+        
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+        glStencilFunc(GL_EQUAL, _stencilReferenceValue, 0xff);
+    }
     
-    glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
-    glStencilFunc(GL_EQUAL, _stencilReferenceValue--, 0xff);
+    SP_RELEASE_AND_NIL(maskState->_mask);
     
-    [self drawMask:mask];
+    SPPopDebugMarker();
+}
+
+- (SPMatrix *)transformationMatrixForMask:(SPDisplayObject *)mask
+{
+    // The mask is drawn with the same matrix (see 'drawMask:'). With 3D transformations, the
+    // mask's area can't be described in 2D stage coordinates, so there is no such matrix.
     
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-    glStencilFunc(GL_EQUAL, _stencilReferenceValue, 0xff);
+    if (_matrix3DStackSize != 0) return nil;
     
-    [mask release];
+    SPStage *stage = mask.stage;
+    if (stage) return [mask transformationMatrixToSpace:stage];
     
-    SPPopDebugMarker();
+    SPMatrix *matrix = [[_stateStackTop->_modelViewMatrix copy] autorelease];
+    [matrix prependMatrix:mask.transformationMatrix];
+    return matrix;
+}
+
+- (BOOL)isAxisAlignedMatrix:(SPMatrix *)matrix
+{
+    // neither skewed nor rotated by anything but a multiple of 90 degrees
+    return (SPIsFloatEqual(matrix.b, 0.0f) && SPIsFloatEqual(matrix.c, 0.0f)) ||
+           (SPIsFloatEqual(matrix.a, 0.0f) && SPIsFloatEqual(matrix.d, 0.0f));
 }
 
 - (void)drawMask:(SPDisplayObject *)mask
@@ -677,9 +836,31 @@
         [context setRenderToBackBuffer];
 }
 
+- (void)setColorMatrix:(SPColorMatrix *)colorMatrix
+{
+    // objects with equal matrices (e.g. several disabled buttons) can still be batched
+    BOOL isEqual = colorMatrix == _colorMatrix || (colorMatrix && _colorMatrix &&
+        memcmp(colorMatrix.values, _colorMatrix.values, sizeof(float) * colorMatrix.numValues) == 0);
+    
+    if (!isEqual)
+    {
+        [self finishQuadBatch];
+        SP_RELEASE_AND_RETAIN(_colorMatrix, colorMatrix);
+    }
+}
+
 - (void)setStencilReferenceValue:(uint)stencilReferenceValue
 {
     _stencilReferenceValue = stencilReferenceValue;
 }
 
+- (void)setMaskStrategy:(SPMaskStrategy)maskStrategy
+{
+    if (_maskStackSize != 0)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"The mask strategy must not be changed while masks are pushed"];
+    
+    _maskStrategy = maskStrategy;
+}
+
 @end
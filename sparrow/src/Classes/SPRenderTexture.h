@@ -43,6 +43,10 @@ typedef void (^SPDrawingBlock)();
 	     }             
 	 }];
 
+ Where the context supports it, the texture has exactly the requested size; otherwise, its size
+ is rounded up to the next power of two. Beware that on OpenGL ES 2, such a non-power-of-two
+ texture cannot be repeated.
+
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPRenderTexture : SPSubTexture
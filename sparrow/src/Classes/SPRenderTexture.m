@@ -13,6 +13,7 @@
 #import "SPBlendMode.h"
 #import "SPContext.h"
 #import "SPGLTexture.h"
+#import "SPGLTexture_Internal.h"
 #import "SPFragmentFilter.h"
 #import "SPMacros.h"
 #import "SPMatrix.h"
@@ -34,11 +35,15 @@
 
 - (instancetype)initWithWidth:(float)width height:(float)height fillColor:(uint)argb scale:(float)scale
 {
+    // contexts without support for NPOT render targets need a bigger texture;
+    // the region then exposes just the requested size.
+    SPContext *context = SPContext.currentContext;
+    
     SPTextureProperties properties = {
         .format = SPTextureFormatRGBA,
         .scale  = scale,
-        .width  = width  * scale,
-        .height = height * scale,
+        .width  = [context renderTargetSizeForNativeSize:width  * scale alignment:1],
+        .height = [context renderTargetSizeForNativeSize:height * scale alignment:1],
         .numMipmaps = 0,
         .generateMipmaps = NO,
         .premultipliedAlpha = YES
@@ -46,6 +51,7 @@
     
     SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:width height:height];
     SPGLTexture *glTexture = [[SPGLTexture alloc] initWithData:NULL properties:properties];
+    glTexture.usedAsRenderTexture = YES; // lets images register for content changes right away
 
     if ((self = [super initWithRegion:region ofTexture:glTexture]))
     {
@@ -185,6 +191,7 @@
         [_renderSupport setRenderTarget:previousTarget];
         [_renderSupport popClipRect];
         [previousTarget release];
+        [self.root contentsDidChange];
         
         SPPopDebugMarker();
     }
@@ -148,6 +148,7 @@
         [support addDrawCalls:_flattenedContents.count];
 
         SPMatrix3D *mvpMatrix = support.mvpMatrix3D;
+        SPColorMatrix *colorMatrix = support.colorMatrix;
         float alpha = support.alpha;
         uint supportBlendMode = support.blendMode;
 
@@ -156,6 +157,7 @@
             uint blendMode = quadBatch.blendMode;
             if (blendMode == SPBlendModeAuto) blendMode = supportBlendMode;
 
+            quadBatch.colorMatrix = colorMatrix;
             [quadBatch renderWithMvpMatrix3D:mvpMatrix alpha:alpha blendMode:blendMode];
         }
     }
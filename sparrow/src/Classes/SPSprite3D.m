@@ -230,6 +230,7 @@ SP_INLINE void recursivelySetIs3D(SPDisplayObject *object, BOOL value)
 {
     _z = z;
     _transformationChanged = YES;
+    [self.parent setRequiresRedraw];
 }
 
 - (void)setPivotX:(float)pivotX
@@ -248,6 +249,7 @@ SP_INLINE void recursivelySetIs3D(SPDisplayObject *object, BOOL value)
 {
     _pivotZ = pivotZ;
     _transformationChanged = YES;
+    [self.parent setRequiresRedraw];
 }
 
 - (void)setScaleX:(float)scaleX
@@ -266,6 +268,7 @@ SP_INLINE void recursivelySetIs3D(SPDisplayObject *object, BOOL value)
 {
     _scaleZ = scaleZ;
     _transformationChanged = YES;
+    [self.parent setRequiresRedraw];
 }
 
 - (void)setSkewX:(float)skewX
@@ -288,12 +291,14 @@ SP_INLINE void recursivelySetIs3D(SPDisplayObject *object, BOOL value)
 {
     _rotationX = rotationX;
     _transformationChanged = YES;
+    [self.parent setRequiresRedraw];
 }
 
 - (void)setRotationY:(float)rotationY
 {
     _rotationY = rotationY;
     _transformationChanged = YES;
+    [self.parent setRequiresRedraw];
 }
 
 - (float)rotationZ
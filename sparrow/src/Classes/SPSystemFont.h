@@ -0,0 +1,72 @@
+//
+//  SPSystemFont.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPBitmapFont.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPSystemFont is a bitmap font whose chars are rendered on demand from a standard iOS font.
+
+ Whenever a text contains chars that were not used before, their glyphs are rasterised with UIKit
+ into one bitmap and copied to the glyph cache: a render texture that is shared by all system
+ fonts. Each composed character sequence (e.g. an emoji with a skin tone) forms a single glyph.
+ Afterwards, the text is arranged just like with any other bitmap font. Texts in system fonts can thus be batched
+ together and changed without creating a new texture each time.
+
+ When the glyph cache is full, it is replaced by a new one, and all system fonts start collecting
+ their glyphs anew. Text fields that still display glyphs of the old cache keep it alive until
+ they are redrawn.
+
+ The glyphs are rendered white, so that they can be tinted with any color, and at the size of the
+ font; so if you need a font in several sizes, create one font per size.
+
+ _You don't have to use this class directly in most cases. Set `cachesGlyphs` on an SPTextField
+ that displays a standard iOS font, and it will use a system font internally._
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPSystemFont : SPBitmapFont
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a font with the name and size of a standard iOS font. If that font is not found,
+/// the default font is used. _Designated Initializer_.
+- (instancetype)initWithName:(NSString *)fontName size:(float)size bold:(BOOL)bold italic:(BOOL)italic;
+
+/// Initializes a font with the name and size of a standard iOS font.
+- (instancetype)initWithName:(NSString *)fontName size:(float)size;
+
+/// Factory method.
++ (instancetype)fontWithName:(NSString *)fontName size:(float)size bold:(BOOL)bold italic:(BOOL)italic;
+
+/// Factory method.
++ (instancetype)fontWithName:(NSString *)fontName size:(float)size;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Makes sure that all chars of the string are in the glyph cache. This is done automatically
+/// when a text is arranged; call it in advance to avoid the rasterisation at that time.
+- (void)prepareCharsInString:(NSString *)string;
+
+/// Replaces the glyph cache with an empty one. Fonts will rasterise their chars anew when
+/// they are used next time.
++ (void)purgeGlyphCache;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,396 @@
+//
+//  SPSystemFont.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBitmapChar.h"
+#import "SPBitmapFont_Internal.h"
+#import "SPImage.h"
+#import "SPMacros.h"
+#import "SPRectangle.h"
+#import "SPRectanglePacker.h"
+#import "SPRenderTexture.h"
+#import "SPSubTexture.h"
+#import "SPSystemFont.h"
+#import "SPTextField.h"
+
+#import <UIKit/UIKit.h>
+
+#define GLYPH_CACHE_SIZE 512.0f
+
+// the empty border around each glyph, relative to the font size; it catches the parts of a
+// glyph that reach beyond its advance or line height (e.g. with italic fonts).
+#define GLYPH_MARGIN 0.15f
+
+// the empty space right and below each glyph in the cache, so that neighbours don't bleed into
+// each other when the texture is filtered.
+#define PADDING 1.0f
+
+// composed character sequences that don't consist of a single code point (e.g. an emoji with a
+// skin tone) get IDs above the Unicode range.
+#define FIRST_SEQUENCE_ID 0x110000
+
+// --- glyph cache ---------------------------------------------------------------------------------
+
+static SPRenderTexture *glyphCache = nil;
+static SPRectanglePacker *glyphPacker = nil;
+static NSInteger glyphCacheID = 0;
+
+static SPRenderTexture *getGlyphCache(void)
+{
+    if (!glyphCache)
+    {
+        glyphCache = [[SPRenderTexture alloc] initWithWidth:GLYPH_CACHE_SIZE height:GLYPH_CACHE_SIZE];
+        glyphPacker = [[SPRectanglePacker alloc] initWithWidth:GLYPH_CACHE_SIZE height:GLYPH_CACHE_SIZE];
+    }
+
+    return glyphCache;
+}
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static UIFont *getUIFont(NSString *fontName, float size, BOOL bold, BOOL italic)
+{
+    UIFontDescriptorSymbolicTraits traits = 0;
+    if (bold)   traits |= UIFontDescriptorTraitBold;
+    if (italic) traits |= UIFontDescriptorTraitItalic;
+
+    UIFontDescriptor *fontDescriptor = [[UIFontDescriptor fontDescriptorWithName:fontName size:size]
+                                        fontDescriptorWithSymbolicTraits:traits];
+
+    UIFont *font = [UIFont fontWithDescriptor:fontDescriptor size:size];
+    if (!font)
+    {
+        NSLog(@"Font `%@` not found! Using default font.", fontName);
+
+        fontDescriptor = [[UIFontDescriptor fontDescriptorWithName:SPDefaultFontName size:size]
+                          fontDescriptorWithSymbolicTraits:traits];
+        font = [UIFont fontWithDescriptor:fontDescriptor size:size];
+    }
+
+    return font;
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPSystemFont
+{
+    UIFont *_font;
+    NSDictionary *_glyphAttributes;
+    float _margin;
+    NSInteger _glyphCacheID;
+    NSMutableDictionary *_sequenceIDs;
+    NSMutableArray *_sequences;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithName:(NSString *)fontName size:(float)size bold:(BOOL)bold italic:(BOOL)italic
+{
+    UIFont *font = getUIFont(fontName, size, bold, italic);
+
+    if ((self = [super initWithName:font.fontName texture:getGlyphCache() size:size
+                         lineHeight:font.lineHeight baseline:font.ascender]))
+    {
+        _font = [font retain];
+        _margin = ceilf(size * GLYPH_MARGIN);
+        _glyphCacheID = glyphCacheID;
+        _glyphAttributes = [@{ NSFontAttributeName: font,
+                               NSForegroundColorAttributeName: [UIColor whiteColor] } retain];
+        _sequenceIDs = [[NSMutableDictionary alloc] init];
+        _sequences = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (instancetype)initWithName:(NSString *)fontName size:(float)size
+{
+    return [self initWithName:fontName size:size bold:NO italic:NO];
+}
+
+- (instancetype)init
+{
+    return [self initWithName:SPDefaultFontName size:SPDefaultFontSize];
+}
+
+- (void)dealloc
+{
+    [_font release];
+    [_glyphAttributes release];
+    [_sequenceIDs release];
+    [_sequences release];
+    [super dealloc];
+}
+
++ (instancetype)fontWithName:(NSString *)fontName size:(float)size bold:(BOOL)bold italic:(BOOL)italic
+{
+    return [[[self alloc] initWithName:fontName size:size bold:bold italic:italic] autorelease];
+}
+
++ (instancetype)fontWithName:(NSString *)fontName size:(float)size
+{
+    return [[[self alloc] initWithName:fontName size:size] autorelease];
+}
+
+#pragma mark Methods
+
+- (void)prepareCharsInString:(NSString *)string
+{
+    [self updateGlyphCache];
+
+    NSIndexSet *charIDs = [self missingCharIDsInString:string];
+    if (!charIDs.count) return;
+
+    if (![self addCharsWithIDs:charIDs])
+    {
+        // the cache is full; the complete text moves on to a new one.
+        [SPSystemFont purgeGlyphCache];
+        [self updateGlyphCache];
+
+        if (![self addCharsWithIDs:[self missingCharIDsInString:string]])
+            SPLog(@"Warning: text does not fit into the glyph cache");
+    }
+}
+
++ (void)purgeGlyphCache
+{
+    SP_RELEASE_AND_NIL(glyphCache);
+    SP_RELEASE_AND_NIL(glyphPacker);
+    ++glyphCacheID;
+}
+
+#pragma mark SPBitmapFont
+
+- (BOOL)hasCharsInString:(NSString *)string
+{
+    [self prepareCharsInString:string];
+    return [super hasCharsInString:string];
+}
+
+- (SPSprite *)createSpriteWithWidth:(float)width height:(float)height
+                               text:(NSString *)text fontSize:(float)size color:(uint)color
+                             hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                          autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+                            leading:(float)leading
+{
+    [self prepareCharsInString:text];
+    return [super createSpriteWithWidth:width height:height text:text fontSize:size color:color
+                                 hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning
+                                leading:leading];
+}
+
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
+                 text:(NSString *)text fontSize:(float)size color:(uint)color
+               hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+            autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+              leading:(float)leading
+{
+    [self prepareCharsInString:text];
+    [super fillQuadBatch:quadBatch withWidth:width height:height text:text fontSize:size color:color
+                  hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning leading:leading];
+}
+
+- (NSInteger)fillQuadBatches:(NSMutableArray *)quadBatches
+                   withWidth:(float)width height:(float)height
+                        text:(NSString *)text fontSize:(float)size color:(uint)color
+                      hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                   autoScale:(BOOL)autoScale kerning:(BOOL)kerning
+                     leading:(float)leading
+{
+    [self prepareCharsInString:text];
+    return [super fillQuadBatches:quadBatches withWidth:width height:height text:text fontSize:size
+                            color:color hAlign:hAlign vAlign:vAlign autoScale:autoScale
+                          kerning:kerning leading:leading];
+}
+
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
+                 text:(NSString *)text fontSize:(float)size color:(uint)color
+               hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+              kerning:(BOOL)kerning leading:(float)leading
+                lines:(NSMutableData *)lines numUnchangedChars:(NSInteger)numUnchangedChars
+{
+    [self prepareCharsInString:text];
+    [super fillQuadBatch:quadBatch withWidth:width height:height text:text fontSize:size color:color
+                  hAlign:hAlign vAlign:vAlign kerning:kerning leading:leading
+                   lines:lines numUnchangedChars:numUnchangedChars];
+}
+
+- (void)getCharIDs:(int *)charIDs ofText:(NSString *)text range:(NSRange)range
+{
+    // UIKit draws each composed character sequence as one glyph
+    NSInteger end = NSMaxRange(range);
+
+    for (NSInteger i=range.location; i<end; )
+    {
+        NSRange sequence = [text rangeOfComposedCharacterSequenceAtIndex:i];
+        NSInteger length = MIN(NSMaxRange(sequence), end) - i;
+        int *sequenceIDs = charIDs + (i - range.location);
+        unichar high = [text characterAtIndex:i];
+
+        // "\r\n" is a sequence, too, but the layout needs to see the line break
+        if (high == '\r') length = 1;
+
+        if (length == 1)
+            sequenceIDs[0] = high;
+        else
+        {
+            unichar low = [text characterAtIndex:i + 1];
+
+            if (length == 2 && CFStringIsSurrogateHighCharacter(high) && CFStringIsSurrogateLowCharacter(low))
+                sequenceIDs[0] = (int)CFStringGetLongCharacterForSurrogatePair(high, low);
+            else
+                sequenceIDs[0] = [self idOfSequence:[text substringWithRange:NSMakeRange(i, length)]];
+
+            for (NSInteger j=1; j<length; ++j)
+                sequenceIDs[j] = SPCharIDContinuation;
+        }
+
+        i += length;
+    }
+}
+
+#pragma mark Private
+
+- (int)idOfSequence:(NSString *)sequence
+{
+    // text may be arranged in the resource queue
+    @synchronized (_sequenceIDs)
+    {
+        NSNumber *sequenceID = _sequenceIDs[sequence];
+        if (!sequenceID)
+        {
+            sequenceID = @(FIRST_SEQUENCE_ID + (int)_sequences.count);
+            _sequenceIDs[sequence] = sequenceID;
+            [_sequences addObject:sequence];
+        }
+
+        return sequenceID.intValue;
+    }
+}
+
+- (NSString *)stringWithCharID:(int)charID
+{
+    if (charID >= FIRST_SEQUENCE_ID)
+    {
+        @synchronized (_sequenceIDs)
+        {
+            return [[_sequences[charID - FIRST_SEQUENCE_ID] retain] autorelease];
+        }
+    }
+    else
+    {
+        UTF32Char character = NSSwapHostIntToLittle(charID);
+        return [[[NSString alloc] initWithBytes:&character length:sizeof(UTF32Char)
+                                       encoding:NSUTF32LittleEndianStringEncoding] autorelease];
+    }
+}
+
+- (void)updateGlyphCache
+{
+    SPRenderTexture *cache = getGlyphCache();
+
+    if (_glyphCacheID != glyphCacheID)
+    {
+        // our chars reference a cache that was replaced
+        [self removeAllChars];
+        [self setTexture:cache];
+        _glyphCacheID = glyphCacheID;
+    }
+}
+
+- (NSIndexSet *)missingCharIDsInString:(NSString *)string
+{
+    NSMutableIndexSet *missingCharIDs = [NSMutableIndexSet indexSet];
+    NSInteger length = string.length;
+    int *charIDs = malloc(sizeof(int) * length);
+
+    [self getCharIDs:charIDs ofText:string range:NSMakeRange(0, length)];
+
+    for (NSInteger i=0; i<length; ++i)
+    {
+        int charID = charIDs[i];
+        if (charID != SPCharIDContinuation && ![self charByID:charID])
+            [missingCharIDs addIndex:charID];
+    }
+
+    free(charIDs);
+    return missingCharIDs;
+}
+
+- (BOOL)addCharsWithIDs:(NSIndexSet *)charIDs
+{
+    NSMutableArray *glyphStrings = [NSMutableArray array];
+    NSMutableArray *glyphRegions = [NSMutableArray array];
+    NSMutableArray *bitmapChars = [NSMutableArray array];
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    SPRenderTexture *cache = getGlyphCache();
+    SPRectangle *bounds = nil;
+
+    // all slots are allocated before anything is drawn, so that a full cache is left untouched
+
+    for (NSUInteger charID = charIDs.firstIndex; charID != NSNotFound; charID = [charIDs indexGreaterThanIndex:charID])
+    {
+        NSString *charString = [self stringWithCharID:(int)charID];
+        float xAdvance = [charString sizeWithAttributes:_glyphAttributes].width;
+        SPRectangle *region = [SPRectangle rectangle];
+
+        if (charID >= FIRST_SEQUENCE_ID || ![whitespace longCharacterIsMember:(UTF32Char)charID])
+        {
+            float width  = ceilf(xAdvance) + 2.0f * _margin;
+            float height = ceilf(_font.lineHeight) + 2.0f * _margin;
+
+            SPRectangle *slot = [glyphPacker allocateRectangleWithWidth:width + PADDING
+                                                                 height:height + PADDING];
+            if (!slot) return NO;
+
+            [region setX:slot.x y:slot.y width:width height:height];
+            [glyphStrings addObject:charString];
+            [glyphRegions addObject:region];
+
+            bounds = bounds ? [bounds uniteWithRectangle:region] : region;
+        }
+
+        SPSubTexture *texture = [SPSubTexture textureWithRegion:region ofTexture:cache];
+        SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:(int)charID texture:texture
+                                                            xOffset:-_margin yOffset:-_margin
+                                                           xAdvance:xAdvance];
+        [bitmapChars addObject:bitmapChar];
+        [bitmapChar release];
+    }
+
+    if (bounds)
+    {
+        // All new glyphs are rasterised into one bitmap that covers their slots, so that there's
+        // just one upload. It's transparent elsewhere and won't change the glyphs that are
+        // already in the cache.
+
+        SPTexture *glyphsTexture = [SPTexture textureWithWidth:bounds.width height:bounds.height
+                                                          draw:^(CGContextRef context)
+        {
+            [glyphStrings enumerateObjectsUsingBlock:^(NSString *glyphString, NSUInteger i, BOOL *stop)
+            {
+                SPRectangle *region = glyphRegions[i];
+                CGPoint position = CGPointMake(region.x - bounds.x + _margin, region.y - bounds.y + _margin);
+                [glyphString drawAtPoint:position withAttributes:_glyphAttributes];
+            }];
+        }];
+
+        SPImage *glyphsImage = [SPImage imageWithTexture:glyphsTexture];
+        glyphsImage.x = bounds.x;
+        glyphsImage.y = bounds.y;
+        [cache drawObject:glyphsImage];
+    }
+
+    for (SPBitmapChar *bitmapChar in bitmapChars)
+        [self addBitmapChar:bitmapChar charID:bitmapChar.charID];
+
+    return YES;
+}
+
+@end
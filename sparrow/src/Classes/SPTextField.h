@@ -16,6 +16,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class SPBitmapFont;
+@class SPDistanceFieldStyle;
 @class SPTexture;
 
 SP_EXTERN NSString *const   SPDefaultFontName;
@@ -70,6 +71,20 @@ typedef NS_OPTIONS(NSInteger, SPTextFieldAutoSize)
  from Angel Code, which is a free tool for Windows. Export the font data as an XML 
  file and the texture as a png with white characters on a transparent background (32 bit). 
  
+ Standard iOS fonts can also be displayed the way bitmap fonts are: enable `cachesGlyphs`, and
+ the glyphs are rasterised once and taken from a cache that all text fields share (see
+ SPSystemFont). That is the best choice for text that changes often.
+
+ When a text field with a bitmap font (or with cached glyphs) does not scale automatically,
+ changing its text only rearranges the lines from the first changed char onwards; the quads of
+ the lines in front of it are kept, or just moved if the number of lines changes the vertical
+ alignment. That makes e.g. a growing log or chat view cheap to update. Fonts with several pages
+ are always arranged completely.
+
+ Arranging and especially rasterising text takes time. When a screen with many text fields
+ appears, enable `asynchronous` on them: the work is then done in a background queue, and each
+ text field shows up as soon as its contents are ready.
+
  Here is a sample with a standard font:
  
 	SPTextField *textField = [SPTextField textFieldWithWidth:300 height:100 text:@"Hello world!"];
@@ -205,14 +220,35 @@ typedef NS_OPTIONS(NSInteger, SPTextFieldAutoSize)
 @property (nonatomic, assign) SPTextFieldAutoSize autoSize;
 
 /// Indicates if TextField should be batched on rendering. This works only with bitmap
-/// fonts, and it makes sense only for TextFields with no more than 10-15 characters.
+/// fonts (or with `cachesGlyphs`), and it makes sense only for TextFields with no more than
+/// 10-15 characters.
 /// Otherwise, the CPU costs will exceed any gains you get from avoiding the additional
 /// draw call. Default: NO
 @property (nonatomic, assign) BOOL batchable;
 
+/// Indicates if a standard iOS font is displayed with glyphs from a shared cache, just like a
+/// bitmap font, instead of being rendered into a texture of its own. Text fields in this mode
+/// can be batched, and changing their text does not create a new texture. Underlining is not
+/// supported in this mode. Has no effect on bitmap fonts. Default: NO
+@property (nonatomic, assign) BOOL cachesGlyphs;
+
 /// The amount of vertical space (called 'leading') between lines. Default: 0
 @property (nonatomic, assign) float leading;
 
+/// Overrides the distance field style of the bitmap font, e.g. to give this text field an outline
+/// or a drop shadow. Whether the field is multi-channel is always taken from the font. Has no
+/// effect on fonts without a distance field. Default: nil
+@property (nonatomic, copy, nullable) SPDistanceFieldStyle *distanceFieldStyle;
+
+/// Indicates if the text is arranged (bitmap fonts) or rasterised (iOS fonts) in the resource
+/// queue of the view controller instead of on the main thread. After a change, the text field keeps
+/// displaying its previous contents until the new ones are ready, which is typically a frame later.
+/// Whatever depends on the new contents waits for them, i.e. is created on the main thread:
+/// `textBounds`, flattening, and the bounds (and thus the size) of an auto-sized text field. Text
+/// with `cachesGlyphs` is always drawn on the main thread, because the glyph cache is a render
+/// texture. Default: NO
+@property (nonatomic, assign) BOOL asynchronous;
+
 /// The bounds of the actual characters inside the text field.
 @property (weak, nonatomic, readonly) SPRectangle *textBounds;
 
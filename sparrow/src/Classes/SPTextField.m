@@ -11,15 +11,20 @@
 
 #import "SparrowClass.h"
 #import "SPBitmapFont.h"
+#import "SPBitmapFont_Internal.h"
+#import "SPContext.h"
+#import "SPDistanceFieldStyle.h"
 #import "SPEnterFrameEvent.h"
 #import "SPGLTexture.h"
 #import "SPImage.h"
+#import "SPOpenGL.h"
 #import "SPQuad.h"
 #import "SPQuadBatch.h"
 #import "SPRectangle.h"
 #import "SPStage.h"
 #import "SPSprite.h"
 #import "SPSubTexture.h"
+#import "SPSystemFont.h"
 #import "SPTextField.h"
 #import "SPTexture.h"
 
@@ -36,6 +41,13 @@ const float       SPNativeFontSize    = -1;
 
 static NSMutableDictionary *bitmapFonts = nil;
 
+// --- system font cache ---------------------------------------------------------------------------
+
+// fonts are evicted when memory runs low; their glyphs stay in the glyph cache until it's replaced.
+#define MAX_CACHED_SYSTEM_FONTS 32
+
+static NSCache *systemFonts = nil;
+
 // --- helpers -------------------------------------------------------------------------------------
 
 static NSTextAlignment hAlignToTextAlignment[] = {
@@ -68,7 +80,10 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     SPTextFieldAutoSize _autoSize;
     BOOL _batchable;
     BOOL _kerning;
+    BOOL _cachesGlyphs;
+    BOOL _asynchronous;
     float _leading;
+    SPDistanceFieldStyle *_distanceFieldStyle;
     BOOL _requiresRedraw;
     BOOL _isRenderedText;
     
@@ -77,7 +92,15 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     SPDisplayObjectContainer *_border;
     
     SPImage *_image;
-    SPQuadBatch *_quadBatch;
+    SP_GENERIC(NSMutableArray, SPQuadBatch*) *_quadBatches; // one per page of the font
+
+    // the layout of the text in the first quad batch, for incremental updates
+    SPBitmapFont *_layoutFont;
+    NSMutableData *_lines;
+    NSInteger _numUnchangedChars;
+
+    // a copy of the text field whose contents are created in the resource queue
+    SPTextField *_pendingContents;
 }
 
 #pragma mark Initialization
@@ -134,7 +157,11 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     [_hitArea release];
     [_border release];
     [_image release];
-    [_quadBatch release];
+    [_quadBatches release];
+    [_layoutFont release];
+    [_lines release];
+    [_distanceFieldStyle release];
+    [_pendingContents release];
     [super dealloc];
 }
 
@@ -203,13 +230,16 @@ static NSTextAlignment hAlignToTextAlignment[] = {
 
 - (void)render:(SPRenderSupport *)support
 {
-    if (_requiresRedraw) [self redraw];
+    if (_requiresRedraw) [self updateContents];
     [super render:support];
 }
 
 - (SPRectangle *)boundsInSpace:(SPDisplayObject *)targetSpace
 {
-    if (_requiresRedraw) [self redraw];
+    // the size of an auto-sized text field depends on its contents, so they can't be pending
+    if (_autoSize != SPTextFieldAutoSizeNone && (_requiresRedraw || _pendingContents)) [self redraw];
+    else if (_requiresRedraw) [self updateContents];
+
     SPMatrix *matrix = [self transformationMatrixToSpace:targetSpace];
     return [_hitArea boundsAfterTransformation:matrix];
 }
@@ -221,20 +251,22 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     // keeping the size of the text/font unchanged. (this applies to setHeight:, as well.)
 
     _hitArea.width = width;
-    _requiresRedraw = YES;
+    _numUnchangedChars = 0;
+    [self setRequiresContentsUpdate];
 }
 
 - (void)setHeight:(float)height
 {
     _hitArea.height = height;
-    _requiresRedraw = YES;
+    _numUnchangedChars = 0;
+    [self setRequiresContentsUpdate];
 }
 
 #pragma mark Events
 
 - (void)onFlatten:(SPEvent *)event
 {
-    if (_requiresRedraw) [self redraw];
+    if (_requiresRedraw || _pendingContents) [self redraw];
 }
 
 #pragma mark NSCopying
@@ -258,7 +290,10 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     textField.autoScale = self.autoScale;
     textField.autoSize = self.autoSize;
     textField.batchable = self.batchable;
+    textField.cachesGlyphs = self.cachesGlyphs;
     textField.leading = self.leading;
+    textField.distanceFieldStyle = self.distanceFieldStyle;
+    textField.asynchronous = self.asynchronous;
     
     return textField;
 }
@@ -269,8 +304,18 @@ static NSTextAlignment hAlignToTextAlignment[] = {
 {
     if (![text isEqualToString:_text])
     {
+        NSInteger numCommonChars = 0;
+        NSInteger maxCommonChars = MIN(text.length, _text.length);
+
+        while (numCommonChars < maxCommonChars &&
+               [text characterAtIndex:numCommonChars] == [_text characterAtIndex:numCommonChars])
+            ++numCommonChars;
+
+        // several changes may happen between two redraws
+        _numUnchangedChars = MIN(_numUnchangedChars, numCommonChars);
+
         SP_RELEASE_AND_COPY(_text, text);
-        _requiresRedraw = YES;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -282,7 +327,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
             [SPTextField registerBitmapFont:[[[SPBitmapFont alloc] initWithMiniFont] autorelease]];
 
         SP_RELEASE_AND_COPY(_fontName, fontName);
-        _requiresRedraw = YES;        
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
         _isRenderedText = !bitmapFonts[_fontName];
     }
 }
@@ -292,7 +338,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (fontSize != _fontSize)
     {
         _fontSize = fontSize;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -301,7 +348,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (color != _color)
     {
         _color = color;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
  
@@ -310,7 +358,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (hAlign != _hAlign)
     {
         _hAlign = hAlign;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -319,7 +368,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (vAlign != _vAlign)
     {
         _vAlign = vAlign;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -352,7 +402,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (bold != _bold)
     {
         _bold = bold;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -361,7 +412,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (italic != _italic)
     {
         _italic = italic;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -370,7 +422,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (underline != _underline)
     {
         _underline = underline;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -379,7 +432,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
 	if (kerning != _kerning)
 	{
 		_kerning = kerning;
-		_requiresRedraw = YES;
+		_numUnchangedChars = 0;
+		[self setRequiresContentsUpdate];
 	}
 }
 
@@ -388,7 +442,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (autoScale != _autoScale)
     {
         _autoScale = autoScale;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
@@ -397,14 +452,27 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (autoSize != _autoSize)
     {
         _autoSize = autoSize;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
     }
 }
 
 - (void)setBatchable:(BOOL)batchable
 {
     _batchable = batchable;
-    if (_quadBatch) _quadBatch.batchable = batchable;
+
+    for (SPQuadBatch *quadBatch in _quadBatches)
+        quadBatch.batchable = batchable;
+}
+
+- (void)setCachesGlyphs:(BOOL)cachesGlyphs
+{
+    if (cachesGlyphs != _cachesGlyphs)
+    {
+        _cachesGlyphs = cachesGlyphs;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
+    }
 }
 
 - (void)setLeading:(float)leading
@@ -412,19 +480,37 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     if (leading != _leading)
     {
         _leading = leading;
-        _requiresRedraw = YES;
+        _numUnchangedChars = 0;
+        [self setRequiresContentsUpdate];
+    }
+}
+
+- (void)setDistanceFieldStyle:(SPDistanceFieldStyle *)distanceFieldStyle
+{
+    if (![distanceFieldStyle isEqualToStyle:_distanceFieldStyle])
+    {
+        // the quads are not affected, so all of them can be kept
+        SP_RELEASE_AND_COPY(_distanceFieldStyle, distanceFieldStyle);
+        [self setRequiresContentsUpdate];
     }
 }
 
 - (SPRectangle *)textBounds
 {
-    if (_requiresRedraw) [self redraw];
-    if (!_textBounds) _textBounds = [[_quadBatch boundsInSpace:_quadBatch] retain];
+    if (_requiresRedraw || _pendingContents) [self redraw];
+    if (!_textBounds) _textBounds = [[self quadBatchBounds] retain];
     return [[_textBounds copy] autorelease];
 }
 
 #pragma mark Private
 
+- (void)setRequiresContentsUpdate
+{
+    // the contents are recreated lazily; the version tells observers that they are outdated
+    _requiresRedraw = YES;
+    [self setRequiresRedraw];
+}
+
 - (BOOL)isVerticalAutoSize
 {
     return (_autoSize & SPTextFieldAutoSizeVertical) != 0;
@@ -435,24 +521,154 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     return (_autoSize & SPTextFieldAutoSizeHorizontal) != 0;
 }
 
+- (void)updateContents
+{
+    // the glyph cache of system fonts is a render texture, which can only be drawn to on the
+    // main thread.
+    if (_asynchronous && Sparrow.currentController && !(_isRenderedText && _cachesGlyphs))
+        [self redrawAsynchronously];
+    else
+        [self redraw];
+}
+
 - (void)redraw
 {
+    if (_pendingContents)
+    {
+        // the contents are needed right away; whatever the resource queue creates is ignored
+        SP_RELEASE_AND_NIL(_pendingContents);
+        _requiresRedraw = YES;
+    }
+
     if (_requiresRedraw)
     {
-        if (_isRenderedText) [self createRenderedContents];
-        else                 [self createComposedContents];
+        if (_isRenderedText && !_cachesGlyphs) [self createRenderedContents];
+        else                                   [self createComposedContentsWithFont:[self bitmapFont]];
         
         [self updateBorder];
+        _numUnchangedChars = _text.length;
         _requiresRedraw = NO;
     }
 }
 
+- (void)redrawAsynchronously
+{
+    // only one copy is processed at a time; changes in the meantime are picked up afterwards
+    if (_pendingContents) return;
+
+    SPBitmapFont *bitmapFont = _isRenderedText ? nil : [self bitmapFont];
+    SPTextField *contents = [self contentsCopy];
+
+    _pendingContents = [contents retain];
+    _requiresRedraw = NO;
+
+    [Sparrow.currentController executeInResourceQueue:^
+     {
+         BOOL success = YES;
+         GLsync waitUntilTextureDrawn = nil;
+
+         @try
+         {
+             if (bitmapFont) [contents createComposedContentsWithFont:bitmapFont];
+             else            [contents createRenderedContents];
+
+             if (!bitmapFont && [SPContext currentContext].multiThreaded)
+                 waitUntilTextureDrawn = glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+         }
+         @catch (NSException *exception)
+         {
+             success = NO;
+         }
+
+         if (waitUntilTextureDrawn)
+         {
+             glClientWaitSyncAPPLE(waitUntilTextureDrawn, GL_SYNC_FLUSH_COMMANDS_BIT_APPLE,
+                                   GL_TIMEOUT_IGNORED_APPLE);
+
+             glDeleteSync(waitUntilTextureDrawn);
+             waitUntilTextureDrawn = nil;
+         }
+
+         dispatch_async(dispatch_get_main_queue(), ^
+          {
+              if (contents != _pendingContents) return; // replaced by a synchronous redraw
+
+              if (success) [self adoptContentsOfTextField:contents];
+              else
+              {
+                  // redrawing on the main thread raises the exception where it can be handled
+                  SP_RELEASE_AND_NIL(_pendingContents);
+                  _requiresRedraw = YES;
+                  [self redraw];
+              }
+          });
+     }];
+}
+
+- (SPTextField *)contentsCopy
+{
+    // a bare text field with the same layout settings; other than 'copy', it's not part of any
+    // display tree, so its contents can be created in the resource queue.
+    SPTextField *textField = [[SPTextField alloc] initWithWidth:_hitArea.width height:_hitArea.height
+                                                           text:_text fontName:_fontName
+                                                       fontSize:_fontSize color:_color];
+    textField->_hAlign = _hAlign;
+    textField->_vAlign = _vAlign;
+    textField->_bold = _bold;
+    textField->_italic = _italic;
+    textField->_underline = _underline;
+    textField->_kerning = _kerning;
+    textField->_autoScale = _autoScale;
+    textField->_autoSize = _autoSize;
+    textField->_leading = _leading;
+    textField->_distanceFieldStyle = [_distanceFieldStyle copy];
+
+    return [textField autorelease];
+}
+
+- (void)adoptContentsOfTextField:(SPTextField *)textField
+{
+    SP_RELEASE_AND_NIL(_pendingContents);
+
+    if (_image)
+    {
+        [_image removeFromParent];
+        SP_RELEASE_AND_NIL(_image);
+    }
+
+    for (SPQuadBatch *quadBatch in _quadBatches)
+        [quadBatch removeFromParent];
+
+    SP_RELEASE_AND_NIL(_quadBatches);
+    SP_RELEASE_AND_NIL(_layoutFont); // the next synchronous layout starts from scratch
+
+    _image = [textField->_image retain];
+    _quadBatches = [textField->_quadBatches retain];
+    SP_RELEASE_AND_RETAIN(_textBounds, textField->_textBounds);
+
+    if (_image) [self addChild:_image];
+
+    for (SPQuadBatch *quadBatch in _quadBatches)
+    {
+        quadBatch.batchable = _batchable;
+        [self addChild:quadBatch];
+    }
+
+    if (self.isHorizontalAutoSize) _hitArea.width  = textField->_hitArea.width;
+    if (self.isVerticalAutoSize)   _hitArea.height = textField->_hitArea.height;
+
+    [self updateBorder];
+}
+
 - (void)createRenderedContents
 {
-    if (_quadBatch)
+    if (_quadBatches)
     {
-        [_quadBatch removeFromParent];
-        SP_RELEASE_AND_NIL(_quadBatch);
+        for (SPQuadBatch *quadBatch in _quadBatches)
+            [quadBatch removeFromParent];
+
+        SP_RELEASE_AND_NIL(_quadBatches);
+        SP_RELEASE_AND_NIL(_layoutFont);
     }
     
     float width  = _hitArea.width;
@@ -596,28 +812,18 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     }
 }
 
-- (void)createComposedContents
+- (void)createComposedContentsWithFont:(SPBitmapFont *)bitmapFont
 {
-    SPBitmapFont *bitmapFont = bitmapFonts[_fontName];
-    if (!bitmapFont)
-        [NSException raise:SPExceptionInvalidOperation 
-                    format:@"bitmap font %@ not registered!", _fontName];
-    
     if (_image)
     {
         [_image removeFromParent];
         SP_RELEASE_AND_NIL(_image);
     }
     
-    if (!_quadBatch)
+    if (!_quadBatches)
     {
-        _quadBatch = [[SPQuadBatch alloc] init];
-        _quadBatch.touchable = false;
-        [self addChild:_quadBatch];
-    }
-    else
-    {
-        [_quadBatch reset];
+        _quadBatches = [[NSMutableArray alloc] init];
+        [_quadBatches addObject:[SPQuadBatch quadBatch]];
     }
     
     float width  = _hitArea.width;
@@ -637,15 +843,56 @@ static NSTextAlignment hAlignToTextAlignment[] = {
         vAlign = SPVAlignTop;
     }
     
-    [bitmapFont fillQuadBatch:_quadBatch withWidth:width height:height
-                         text:_text fontSize:_fontSize color:_color hAlign:hAlign vAlign:vAlign
-                    autoScale:_autoScale kerning:_kerning leading:_leading];
+    if (!_autoScale && bitmapFont.textures.count == 1)
+    {
+        // the lines in front of a change keep their layout, so their quads can be kept
+        if (bitmapFont != _layoutFont)
+        {
+            SP_RELEASE_AND_RETAIN(_layoutFont, bitmapFont);
+            _numUnchangedChars = 0;
+        }
+
+        if (!_lines) _lines = [[NSMutableData alloc] init];
+
+        for (NSInteger i=1; i<_quadBatches.count; ++i)
+            [_quadBatches[i] reset];
+
+        [bitmapFont fillQuadBatch:_quadBatches[0] withWidth:width height:height
+                             text:_text fontSize:_fontSize color:_color hAlign:hAlign vAlign:vAlign
+                          kerning:_kerning leading:_leading
+                            lines:_lines numUnchangedChars:_numUnchangedChars];
+    }
+    else
+    {
+        // the chars are grouped by page, so there's one batch per page of the font
+        SP_RELEASE_AND_NIL(_layoutFont);
+        [bitmapFont fillQuadBatches:_quadBatches withWidth:width height:height
+                               text:_text fontSize:_fontSize color:_color hAlign:hAlign vAlign:vAlign
+                          autoScale:_autoScale kerning:_kerning leading:_leading];
+    }
     
-    _quadBatch.batchable = _batchable;
+    SPDistanceFieldStyle *fontStyle = bitmapFont.distanceFieldStyle;
+    if (fontStyle && _distanceFieldStyle)
+        _distanceFieldStyle.multiChannel = fontStyle.multiChannel;
+
+    for (SPQuadBatch *quadBatch in _quadBatches)
+    {
+        quadBatch.batchable = _batchable;
+
+        // incremental updates might not touch the batches' style, so it's always assigned here
+        if (fontStyle)
+            quadBatch.distanceFieldStyle = _distanceFieldStyle ?: fontStyle;
+
+        if (!quadBatch.parent)
+        {
+            quadBatch.touchable = false;
+            [self addChild:quadBatch];
+        }
+    }
     
     if (_autoSize != SPTextFieldAutoSizeNone)
     {
-        _textBounds = [_quadBatch boundsInSpace:_quadBatch];
+        SP_RELEASE_AND_RETAIN(_textBounds, [self quadBatchBounds]);
         
         if (self.isHorizontalAutoSize)
             _hitArea.width  = _textBounds.x + _textBounds.width;
@@ -660,6 +907,51 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     }
 }
 
+- (SPRectangle *)quadBatchBounds
+{
+    SPRectangle *bounds = [_quadBatches[0] boundsInSpace:_quadBatches[0]];
+
+    for (NSInteger i=1; i<_quadBatches.count; ++i)
+    {
+        SPQuadBatch *quadBatch = _quadBatches[i];
+        if (quadBatch.numQuads)
+            bounds = [bounds uniteWithRectangle:[quadBatch boundsInSpace:quadBatch]];
+    }
+
+    return bounds;
+}
+
+- (SPBitmapFont *)bitmapFont
+{
+    SPBitmapFont *bitmapFont = _isRenderedText ? [self systemFont] : bitmapFonts[_fontName];
+    if (!bitmapFont)
+        [NSException raise:SPExceptionInvalidOperation 
+                    format:@"bitmap font %@ not registered!", _fontName];
+
+    return bitmapFont;
+}
+
+- (SPSystemFont *)systemFont
+{
+    float fontSize = _fontSize == SPNativeFontSize ? SPDefaultFontSize : _fontSize;
+    NSString *key = [NSString stringWithFormat:@"%@-%g-%d-%d", _fontName, fontSize, _bold, _italic];
+
+    if (!systemFonts)
+    {
+        systemFonts = [[NSCache alloc] init];
+        systemFonts.countLimit = MAX_CACHED_SYSTEM_FONTS;
+    }
+
+    SPSystemFont *font = [systemFonts objectForKey:key];
+    if (!font)
+    {
+        font = [SPSystemFont fontWithName:_fontName size:fontSize bold:_bold italic:_italic];
+        [systemFonts setObject:font forKey:key];
+    }
+
+    return font;
+}
+
 - (void)updateBorder
 {
     if (!_border) return;
@@ -55,6 +55,17 @@ NS_ASSUME_NONNULL_BEGIN
 	<SubTexture name='trimmed' x='0' y='0' height='10' width='10'
 	            frameX='-10' frameY='-10' frameWidth='30' frameHeight='30'/>
  
+ **Binary atlases**
+ 
+ Parsing XML takes time, especially for atlases with many regions. The `convert_atlas.rb` script
+ in the 'utils' directory converts an atlas XML file to a compact binary format: a table of all
+ regions, sorted by name, followed by the names themselves. Such a file is memory mapped and
+ used as it is; a region is only read when it is accessed. Pass the binary file to the same
+ initializers -- the format is recognized automatically.
+ 
+ In both cases, the texture that is referenced by the file is loaded when it's needed for the
+ first time, i.e. when you access a subtexture or the `texture` property.
+ 
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPTextureAtlas : NSObject
@@ -63,10 +74,12 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Initialization
 /// --------------------
 
-/// Initializes a texture atlas from an XML file and a custom texture. _Designated Initializer_.
+/// Initializes a texture atlas from an XML or binary file and a custom texture.
+/// _Designated Initializer_.
 - (instancetype)initWithContentsOfFile:(nullable NSString *)path texture:(nullable SPTexture *)texture;
 
-/// Initializes a texture atlas from an XML file, loading the texture that is specified in the XML.
+/// Initializes a texture atlas from an XML or binary file; the texture that is specified in the
+/// file is loaded when it's needed.
 - (instancetype)initWithContentsOfFile:(NSString *)path;
 
 /// Initializes a teture atlas from a texture. Add the regions manually with `addName:forRegion:`.
@@ -79,7 +92,8 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Methods
 /// -------------
 
-/// Retrieve a subtexture by name. Returns `nil` if it is not found.
+/// Retrieve a subtexture by name. Returns `nil` if it is not found. The subtexture is created
+/// on first access; later calls return the same instance.
 - (nullable SPTexture *)textureByName:(NSString *)name;
 
 /// The region rectangle associated with a specific name.
@@ -89,7 +103,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable SPRectangle *)frameByName:(NSString *)name;
 
 /// Returns all textures that start with a certain string, sorted alphabetically
-/// (especially useful for `SPMovieClip`).
+/// (especially useful for `SPMovieClip`). The result for a prefix is remembered until regions
+/// are added or removed, so asking for the same sequence again is cheap.
 - (SP_GENERIC(NSArray, SPTexture*) *)texturesStartingWith:(nullable NSString *)prefix;
 
 /// Returns all texture names that start with a certain string, sorted alphabetically.
@@ -122,7 +137,8 @@ NS_ASSUME_NONNULL_BEGIN
 /// All textures of the atlas, sorted alphabetically.
 @property (nonatomic, readonly) SP_GENERIC(NSArray, SPTexture*) *textures;
 
-/// The base texture that makes up the atlas.
+/// The base texture that makes up the atlas. If it's referenced by the atlas file, it is loaded
+/// on first access.
 @property (nonatomic, readonly) SPTexture *texture;
 
 @end
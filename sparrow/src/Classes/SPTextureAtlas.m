@@ -19,6 +19,66 @@
 #import "SPTextureAtlas.h"
 #import "SPUtils.h"
 
+// the binary format: a header, the regions sorted by name (comparing the UTF-8 bytes), and a
+// string table that contains the image path and all names (UTF-8, not null-terminated).
+// Like the devices, the format is little endian.
+#define BINARY_ATLAS_MAGIC      "SPTA"
+#define BINARY_ATLAS_VERSION    1
+
+// the caches for prefix lookups are cleared when they grow beyond this size
+#define MAX_CACHED_PREFIXES     64
+
+// --- helper structs ------------------------------------------------------------------------------
+
+typedef struct __attribute__((packed))
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t numRegions;
+    uint32_t imagePathOffset;
+    uint32_t imagePathLength;
+} SPBinaryAtlasHeader;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    float x;
+    float y;
+    float width;
+    float height;
+    float frameX;
+    float frameY;
+    float frameWidth;  // zero if there is no frame
+    float frameHeight;
+    uint32_t rotated;
+} SPBinaryAtlasRegion;
+
+// --- c functions ---------------------------------------------------------------------------------
+
+static BOOL isBinaryAtlasData(NSData *data)
+{
+    return data.length >= 4 && memcmp(data.bytes, BINARY_ATLAS_MAGIC, 4) == 0;
+}
+
+static int compareNames(const char *name, NSUInteger length, const char *key, NSUInteger keyLength)
+{
+    int result = memcmp(name, key, MIN(length, keyLength));
+    if (result) return result;
+    else return length < keyLength ? -1 : (length > keyLength ? 1 : 0);
+}
+
+static void cacheArray(NSMutableDictionary *cache, NSString *key, NSArray *array)
+{
+    if (cache.count >= MAX_CACHED_PREFIXES) [cache removeAllObjects];
+    cache[key] = array;
+}
+
+static NSComparator compareLiterally = ^(NSString *name1, NSString *name2)
+{
+    return [name1 compare:name2 options:NSLiteralSearch];
+};
+
 // --- helper class --------------------------------------------------------------------------------
 
 @interface SPTextureInfo : NSObject
@@ -26,11 +86,14 @@
     SPRectangle *_region;
     SPRectangle *_frame;
     BOOL _rotated;
+    SPSubTexture *_texture;
 }
 
 - (instancetype)initWithRegion:(SPRectangle *)region frame:(SPRectangle *)frame
                        rotated:(BOOL)rotated;
 
+- (SPSubTexture *)textureOfAtlasTexture:(SPTexture *)atlasTexture;
+
 @property (nonatomic, readonly) SPRectangle *region;
 @property (nonatomic, readonly) SPRectangle *frame;
 @property (nonatomic, readonly) BOOL rotated;
@@ -55,9 +118,19 @@
 {
     [_region release];
     [_frame release];
+    [_texture release];
     [super dealloc];
 }
 
+- (SPSubTexture *)textureOfAtlasTexture:(SPTexture *)atlasTexture
+{
+    // subtextures can't be changed, so all callers can share the same instance
+    if (!_texture)
+        _texture = [[SPSubTexture alloc] initWithRegion:_region frame:_frame
+                                                rotated:_rotated ofTexture:atlasTexture];
+    return _texture;
+}
+
 @end
 
 // --- class implementation ------------------------------------------------------------------------
@@ -65,11 +138,22 @@
 @implementation SPTextureAtlas
 {
     SPTexture *_atlasTexture;
+    NSString *_texturePath; // until the texture is loaded
+    float _textureScale;
     SP_GENERIC(NSMutableDictionary, NSString*, SPTextureInfo*) *_textureInfos;
+    SP_GENERIC(NSArray, NSString*) *_sortedNames; // in literal order, built on demand
+    SP_GENERIC(NSMutableDictionary, NSString*, NSArray*) *_namesByPrefix;
+    SP_GENERIC(NSMutableDictionary, NSString*, NSArray*) *_texturesByPrefix;
+
+    // the regions of a binary atlas are looked up directly in the mapped file; '_textureInfos'
+    // caches those that were accessed.
+    NSData *_binaryData;
+    const SPBinaryAtlasRegion *_binaryRegions;
+    const char *_binaryStrings;
+    NSUInteger _binaryStringsLength;
+    NSInteger _numBinaryRegions;
 }
 
-@synthesize texture = _atlasTexture;
-
 #pragma mark Initialization
 
 - (instancetype)initWithContentsOfFile:(NSString *)path texture:(SPTexture *)texture
@@ -77,8 +161,11 @@
     if ((self = [super init]))
     {
         _textureInfos = [[NSMutableDictionary alloc] init];
+        _namesByPrefix = [[NSMutableDictionary alloc] init];
+        _texturesByPrefix = [[NSMutableDictionary alloc] init];
         _atlasTexture = [texture retain];
-        [self parseAtlasXml:path];
+        _textureScale = texture ? texture.scale : 1.0f;
+        [self parseAtlasFile:path];
     }
     return self;    
 }
@@ -101,7 +188,12 @@
 - (void)dealloc
 {
     [_atlasTexture release];
+    [_texturePath release];
     [_textureInfos release];
+    [_sortedNames release];
+    [_namesByPrefix release];
+    [_texturesByPrefix release];
+    [_binaryData release];
     [super dealloc];
 }
 
@@ -114,56 +206,54 @@
 
 - (SPTexture *)textureByName:(NSString *)name
 {
-    SPTextureInfo *info = _textureInfos[name];
-    SPSubTexture *texture = nil;
-
-    if (info)
-    {
-        texture = [[SPSubTexture alloc] initWithRegion:info.region frame:info.frame
-                                               rotated:info.rotated ofTexture:_atlasTexture];
-        [texture autorelease];
-    }
-
-    return texture;
+    SPTextureInfo *info = [self textureInfoByName:name];
+    return info ? [info textureOfAtlasTexture:self.texture] : nil;
 }
 
 - (SPRectangle *)regionByName:(NSString *)name
 {
-    SPTextureInfo *info = _textureInfos[name];
+    SPTextureInfo *info = [self textureInfoByName:name];
     return info.region;
 }
 
 - (SPRectangle *)frameByName:(NSString *)name
 {
-    SPTextureInfo *info = _textureInfos[name];
+    SPTextureInfo *info = [self textureInfoByName:name];
     return info.frame;
 }
 
 - (NSArray *)texturesStartingWith:(NSString *)prefix
 {
-    NSArray *names = [self namesStartingWith:prefix];
-    
-    SP_GENERIC(NSMutableArray, SPTexture*) *textures = [NSMutableArray arrayWithCapacity:names.count];
-    for (NSString *textureName in names)
-        [textures addObject:[self textureByName:textureName]];
-    
+    NSString *key = prefix ?: @"";
+    NSArray *textures = _texturesByPrefix[key];
+
+    if (!textures)
+    {
+        NSArray *names = [self namesStartingWith:key];
+        SP_GENERIC(NSMutableArray, SPTexture*) *newTextures = [NSMutableArray arrayWithCapacity:names.count];
+
+        for (NSString *textureName in names)
+            [newTextures addObject:[self textureByName:textureName]];
+
+        textures = [[newTextures copy] autorelease];
+        cacheArray(_texturesByPrefix, key, textures);
+    }
+
     return textures;
 }
 
 - (NSArray *)namesStartingWith:(NSString *)prefix
 {
-    SP_GENERIC(NSMutableArray, NSString*) *names = [NSMutableArray array];
-    
-    if (prefix)
+    // movie clips typically ask for the same sequences again and again
+    NSString *key = prefix ?: @"";
+    NSArray *names = _namesByPrefix[key];
+
+    if (!names)
     {
-        for (NSString *name in _textureInfos)
-            if ([name rangeOfString:prefix].location == 0)
-                [names addObject:name];
+        names = [self findNamesStartingWith:key];
+        cacheArray(_namesByPrefix, key, names);
     }
-    else
-        [names addObjectsFromArray:[_textureInfos allKeys]];
-    
-    [names sortUsingSelector:@selector(localizedStandardCompare:)];
+
     return names;
 }
 
@@ -180,6 +270,9 @@
 - (void)addRegion:(SPRectangle *)region withName:(NSString *)name frame:(SPRectangle *)frame
           rotated:(BOOL)rotated
 {
+    [self unpackBinaryRegions];
+    [self invalidateNames];
+
     SPTextureInfo *info = [[SPTextureInfo alloc] initWithRegion:region frame:frame rotated:rotated];
     _textureInfos[name] = info;
     [info release];
@@ -187,6 +280,8 @@
 
 - (void)removeRegion:(NSString *)name
 {
+    [self unpackBinaryRegions];
+    [self invalidateNames];
     [_textureInfos removeObjectForKey:name];
 }
 
@@ -194,7 +289,18 @@
 
 - (NSInteger)numTextures
 {
-    return [_textureInfos count];
+    return _binaryData ? _numBinaryRegions : [_textureInfos count];
+}
+
+- (SPTexture *)texture
+{
+    if (!_atlasTexture && _texturePath)
+    {
+        _atlasTexture = [[SPTexture alloc] initWithContentsOfFile:_texturePath];
+        SP_RELEASE_AND_NIL(_texturePath);
+    }
+
+    return _atlasTexture;
 }
 
 - (SP_GENERIC(NSArray, NSString*) *)names
@@ -209,22 +315,66 @@
 
 #pragma mark Private
 
-- (void)parseAtlasXml:(NSString *)relativePath
+- (void)parseAtlasFile:(NSString *)relativePath
 {
     if (!relativePath) return;
 
     NSString *path = [SPUtils absolutePathToFile:relativePath];
     if (!path) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", relativePath];
 
-    NSData *xmlData = [[NSData alloc] initWithContentsOfFile:path];
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+
+    if (isBinaryAtlasData(data)) [self parseAtlasBinary:data path:path];
+    else                         [self parseAtlasXml:data path:path];
+}
+
+- (void)parseAtlasBinary:(NSData *)data path:(NSString *)path
+{
+    const char *bytes = data.bytes;
+    NSUInteger length = data.length;
+    const SPBinaryAtlasHeader *header = (const SPBinaryAtlasHeader *)bytes;
+
+    if (length < sizeof(SPBinaryAtlasHeader) || header->version != BINARY_ATLAS_VERSION)
+        [NSException raise:SPExceptionFileInvalid format:@"unsupported texture atlas: %@", path];
+
+    NSUInteger stringsOffset = sizeof(SPBinaryAtlasHeader) +
+                               (NSUInteger)header->numRegions * sizeof(SPBinaryAtlasRegion);
+
+    if (stringsOffset > length)
+        [NSException raise:SPExceptionFileInvalid format:@"truncated texture atlas: %@", path];
+
+    const SPBinaryAtlasRegion *regions = (const SPBinaryAtlasRegion *)(bytes + sizeof(SPBinaryAtlasHeader));
+    const char *strings = bytes + stringsOffset;
+    NSUInteger stringsLength = length - stringsOffset;
+
+    // the region names are validated when they are read, so opening an atlas doesn't touch them
+    if ((NSUInteger)header->imagePathOffset + header->imagePathLength > stringsLength)
+        [NSException raise:SPExceptionFileInvalid format:@"truncated texture atlas: %@", path];
+
+    SP_RELEASE_AND_RETAIN(_binaryData, data);
+    _binaryRegions = regions;
+    _binaryStrings = strings;
+    _binaryStringsLength = stringsLength;
+    _numBinaryRegions = header->numRegions;
+
+    if (!_atlasTexture)
+    {
+        NSString *filename = [[[NSString alloc] initWithBytes:strings + header->imagePathOffset
+                                                       length:header->imagePathLength
+                                                     encoding:NSUTF8StringEncoding] autorelease];
+        [self setTexturePath:filename inFolder:[path stringByDeletingLastPathComponent]];
+    }
+}
+
+- (void)parseAtlasXml:(NSData *)xmlData path:(NSString *)path
+{
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:xmlData];
-    [xmlData release];
 
     BOOL success = [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
     {
         if ([elementName isEqualToString:@"SubTexture"])
         {
-            float scale = _atlasTexture.scale;
+            float scale = _textureScale;
 
             NSString *name = attributes[@"name"];
             float x = [attributes[@"x"] floatValue] / scale;
@@ -247,11 +397,8 @@
         }
         else if ([elementName isEqualToString:@"TextureAtlas"] && !_atlasTexture)
         {
-            // load atlas texture
             NSString *filename = [attributes valueForKey:@"imagePath"];
-            NSString *textureFolder = [path stringByDeletingLastPathComponent];
-            NSString *texturePath = [textureFolder stringByAppendingPathComponent:filename];
-            _atlasTexture = [[SPTexture alloc] initWithContentsOfFile:texturePath];
+            [self setTexturePath:filename inFolder:[path stringByDeletingLastPathComponent]];
         }
     }];
     
@@ -262,4 +409,162 @@
          path, parser.parserError.localizedDescription];
 }
 
+- (void)setTexturePath:(NSString *)filename inFolder:(NSString *)folder
+{
+    // the texture is loaded when it's needed for the first time; its scale is already known by
+    // the file it will be loaded from.
+    NSString *texturePath = [folder stringByAppendingPathComponent:filename];
+    NSString *fullPath = [SPUtils absolutePathToFile:texturePath];
+    if (!fullPath) [NSException raise:SPExceptionFileNotFound format:@"File '%@' not found", texturePath];
+
+    SP_RELEASE_AND_COPY(_texturePath, texturePath);
+    _textureScale = [fullPath contentScaleFactor];
+}
+
+- (SPTextureInfo *)textureInfoByName:(NSString *)name
+{
+    if (!name) return nil;
+
+    SPTextureInfo *info = _textureInfos[name];
+    if (info || !_binaryData) return info;
+
+    const char *key = name.UTF8String;
+    NSUInteger keyLength = strlen(key);
+    NSInteger index = [self indexOfFirstBinaryRegionNotBefore:key length:keyLength];
+
+    if (index < _numBinaryRegions)
+    {
+        const SPBinaryAtlasRegion *region = &_binaryRegions[index];
+        if (compareNames([self nameOfBinaryRegion:region], region->nameLength, key, keyLength) == 0)
+        {
+            info = [self textureInfoFromBinaryRegion:region];
+            _textureInfos[name] = info;
+        }
+    }
+
+    return info;
+}
+
+- (NSArray *)findNamesStartingWith:(NSString *)prefix
+{
+    // in literal order, all names with a common prefix follow each other; only that range has
+    // to be sorted for display.
+    SP_GENERIC(NSMutableArray, NSString*) *names = [NSMutableArray array];
+
+    if (_binaryData)
+    {
+        const char *key = prefix.UTF8String;
+        NSUInteger keyLength = strlen(key);
+
+        for (NSInteger i=[self indexOfFirstBinaryRegionNotBefore:key length:keyLength];
+             i<_numBinaryRegions; ++i)
+        {
+            const SPBinaryAtlasRegion *region = &_binaryRegions[i];
+            const char *name = [self nameOfBinaryRegion:region];
+
+            if (region->nameLength < keyLength || memcmp(name, key, keyLength) != 0) break;
+
+            [names addObject:[[[NSString alloc] initWithBytes:name length:region->nameLength
+                                                     encoding:NSUTF8StringEncoding] autorelease]];
+        }
+    }
+    else
+    {
+        if (!_sortedNames)
+            _sortedNames = [[_textureInfos.allKeys sortedArrayUsingComparator:compareLiterally] retain];
+
+        NSUInteger numNames = _sortedNames.count;
+        NSUInteger first = [_sortedNames indexOfObject:prefix inSortedRange:NSMakeRange(0, numNames)
+                                               options:NSBinarySearchingInsertionIndex |
+                                                       NSBinarySearchingFirstEqual
+                                       usingComparator:compareLiterally];
+
+        for (NSUInteger i=first; i<numNames; ++i)
+        {
+            NSString *name = _sortedNames[i];
+            if (prefix.length && ![name hasPrefix:prefix]) break;
+            [names addObject:name];
+        }
+    }
+
+    [names sortUsingSelector:@selector(localizedStandardCompare:)];
+    return [[names copy] autorelease];
+}
+
+- (void)invalidateNames
+{
+    SP_RELEASE_AND_NIL(_sortedNames);
+    [_namesByPrefix removeAllObjects];
+    [_texturesByPrefix removeAllObjects];
+}
+
+- (NSInteger)indexOfFirstBinaryRegionNotBefore:(const char *)key length:(NSUInteger)keyLength
+{
+    NSInteger low = 0;
+    NSInteger high = _numBinaryRegions;
+
+    while (low < high)
+    {
+        NSInteger middle = (low + high) / 2;
+        const SPBinaryAtlasRegion *region = &_binaryRegions[middle];
+
+        if (compareNames([self nameOfBinaryRegion:region], region->nameLength, key, keyLength) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+- (const char *)nameOfBinaryRegion:(const SPBinaryAtlasRegion *)region
+{
+    if ((NSUInteger)region->nameOffset + region->nameLength > _binaryStringsLength)
+        [NSException raise:SPExceptionFileInvalid format:@"region name outside of texture atlas"];
+
+    return _binaryStrings + region->nameOffset;
+}
+
+- (SPTextureInfo *)textureInfoFromBinaryRegion:(const SPBinaryAtlasRegion *)binaryRegion
+{
+    float scale = _textureScale;
+    SPRectangle *region = [SPRectangle rectangleWithX:binaryRegion->x / scale y:binaryRegion->y / scale
+                                                width:binaryRegion->width / scale
+                                               height:binaryRegion->height / scale];
+    SPRectangle *frame = nil;
+
+    if (binaryRegion->frameWidth && binaryRegion->frameHeight)
+        frame = [SPRectangle rectangleWithX:binaryRegion->frameX / scale y:binaryRegion->frameY / scale
+                                      width:binaryRegion->frameWidth / scale
+                                     height:binaryRegion->frameHeight / scale];
+
+    return [[[SPTextureInfo alloc] initWithRegion:region frame:frame
+                                          rotated:binaryRegion->rotated != 0] autorelease];
+}
+
+- (void)unpackBinaryRegions
+{
+    // regions can't be added to or removed from the mapped file, so they move to the dictionary
+    if (!_binaryData) return;
+
+    for (NSInteger i=0; i<_numBinaryRegions; ++i)
+    {
+        const SPBinaryAtlasRegion *region = &_binaryRegions[i];
+        NSString *name = [[NSString alloc] initWithBytes:[self nameOfBinaryRegion:region]
+                                                  length:region->nameLength
+                                                encoding:NSUTF8StringEncoding];
+        // regions that were accessed before keep their info, and thus their subtexture
+        if (!_textureInfos[name])
+            _textureInfos[name] = [self textureInfoFromBinaryRegion:region];
+
+        [name release];
+    }
+
+    SP_RELEASE_AND_NIL(_binaryData);
+    _binaryRegions = NULL;
+    _binaryStrings = NULL;
+    _binaryStringsLength = 0;
+    _numBinaryRegions = 0;
+}
+
 @end
@@ -20,6 +20,7 @@ NS_ASSUME_NONNULL_BEGIN
 @class SPPoint;
 @class SPOverlayView;
 @class SPProgram;
+@class SPProgramCache;
 @class SPRectangle;
 @class SPSprite;
 @class SPStage;
@@ -135,6 +136,13 @@ SP_EXTERN NSString *const SPNotificationRootCreated;
 /// Returns the shader program registered under a certain name.
 - (SPProgram *)programByName:(NSString *)name;
 
+/// Creates the shader programs of Sparrow's effects and filters in all their variants, so that
+/// none of them has to be compiled when it is first needed (which would cause a hiccup in the
+/// middle of the game). Call it while loading, e.g. in the initializer of your root class. With
+/// a program cache, the programs are loaded from disk after the first launch. If programs are
+/// compiled asynchronously, this method returns right away.
+- (void)warmUpPrograms;
+
 /// -------------------
 /// @name Other methods
 /// -------------------
@@ -225,6 +233,17 @@ SP_EXTERN NSString *const SPNotificationRootCreated;
 /// A callback block that will be executed when the root object has been created.
 @property (nonatomic, copy, nullable) SPRootCreatedBlock onRootCreated;
 
+/// The cache that stores the binaries of linked shader programs on disk, so that they don't have
+/// to be compiled again when the app is launched the next time. Assign `nil` to always compile
+/// programs from source. (Default: a cache in the app's 'Caches' directory)
+@property (nonatomic, strong, nullable) SPProgramCache *programCache;
+
+/// Indicates if Sparrow's effects and filters compile their shader programs in the resource queue
+/// instead of blocking the main thread. Until a program is ready, an effect falls back to an
+/// equivalent variant that is, or skips rendering in that frame; a filter skips its output.
+/// (Default: `NO`)
+@property (nonatomic, assign) BOOL compilesProgramsAsynchronously;
+
 @end
 
 
@@ -19,7 +19,12 @@
 #import "SPPoint.h"
 #import "SPPress_Internal.h"
 #import "SPPressEvent.h"
+#import "SPBaseEffect.h"
+#import "SPBlurFilter.h"
+#import "SPCanvas.h"
+#import "SPColorMatrixFilter.h"
 #import "SPProgram.h"
+#import "SPProgramCache.h"
 #import "SPRectangle.h"
 #import "SPRenderSupport.h"
 #import "SPResizeEvent.h"
@@ -54,6 +59,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     SPRootCreatedBlock _onRootCreated;
     SPStatsDisplay *_statsDisplay;
     NSMutableDictionary *_programs;
+    SPProgramCache *_programCache;
     
     SPRectangle *_viewPort;
     SPRectangle *_previousViewPort;
@@ -77,6 +83,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     BOOL _supportHighResolutions;
     BOOL _doubleOnPad;
     BOOL _showStats;
+    BOOL _compilesProgramsAsynchronously;
     BOOL _started;
     BOOL _paused;
     BOOL _rendering;
@@ -126,6 +133,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     [_onRootCreated release];
     [_statsDisplay release];
     [_programs release];
+    [_programCache release];
     [_viewPort release];
     [_previousViewPort release];
     [_overlayView release];
@@ -146,6 +154,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     _juggler = [[SPJuggler alloc] init];
     _touchProcessor = [[SPTouchProcessor alloc] initWithStage:_stage];
     _programs = [[NSMutableDictionary alloc] init];
+    _programCache = [[SPProgramCache alloc] init];
     _support = [[SPRenderSupport alloc] init];
     _viewPort = [[SPRectangle alloc] init];
     _previousViewPort = [[SPRectangle alloc] init];
@@ -384,6 +393,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
             _hasRenderedOnce = YES;
             
             [_context present];
+            [_context evictIdleRenderTargets];
         }
         else SPLog(@"WARNING: Unable to set the current rendering context.");
     }
@@ -451,6 +461,16 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     return _programs[name];
 }
 
+- (void)warmUpPrograms
+{
+    [SPBaseEffect warmUpPrograms];
+    [SPBlurFilter warmUpPrograms];
+    
+    // those create their programs when they are initialized
+    [[[SPColorMatrixFilter alloc] init] release];
+    [[[SPCanvas alloc] init] release];
+}
+
 #pragma mark Other Methods
 
 - (void)executeInResourceQueue:(dispatch_block_t)block
@@ -40,9 +40,12 @@
 #import <Sparrow/SPDisplacementMapFilter.h>
 #import <Sparrow/SPDisplayObject.h>
 #import <Sparrow/SPDisplayObjectContainer.h>
+#import <Sparrow/SPDistanceFieldStyle.h>
+#import <Sparrow/SPDynamicAtlas.h>
 #import <Sparrow/SPEnterFrameEvent.h>
 #import <Sparrow/SPEvent.h>
 #import <Sparrow/SPEventDispatcher.h>
+#import <Sparrow/SPFilterChain.h>
 #import <Sparrow/SPGLTexture.h>
 #import <Sparrow/SPJuggler.h>
 #import <Sparrow/SPImage.h>
@@ -60,10 +63,12 @@
 #import <Sparrow/SPPress.h>
 #import <Sparrow/SPPressEvent.h>
 #import <Sparrow/SPProgram.h>
+#import <Sparrow/SPProgramCache.h>
 #import <Sparrow/SPPVRData.h>
 #import <Sparrow/SPQuad.h>
 #import <Sparrow/SPQuadBatch.h>
 #import <Sparrow/SPRectangle.h>
+#import <Sparrow/SPRectanglePacker.h>
 #import <Sparrow/SPRenderSupport.h>
 #import <Sparrow/SPRenderTexture.h>
 #import <Sparrow/SPResizeEvent.h>
@@ -73,6 +78,7 @@
 #import <Sparrow/SPSprite3D.h>
 #import <Sparrow/SPStage.h>
 #import <Sparrow/SPSubTexture.h>
+#import <Sparrow/SPSystemFont.h>
 #import <Sparrow/SPTextField.h>
 #import <Sparrow/SPTexture.h>
 #import <Sparrow/SPTextureAtlas.h>
@@ -0,0 +1,77 @@
+//
+//  SPMicroBenchmark.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A block that executes the measured operation 'numIterations' times.
+typedef void (^SPMicroBenchmarkBlock)(NSInteger numIterations);
+
+/** ------------------------------------------------------------------------------------------------
+
+ A micro benchmark measures the cost of a single, small operation, like appending a matrix.
+
+ The benchmark block receives the number of iterations it has to execute; that way, the overhead
+ of calling the block is spread over many operations. The iteration count is calibrated so that
+ each sample takes at least the requested minimum duration; the reported time is the median of
+ several samples.
+
+ Besides the time per operation, the benchmark reports the number of Objective-C objects that
+ were allocated per operation (counted through `+alloc`/`+allocWithZone:`, including objects that
+ are recycled by `SPPoolObject`). Objects created by CoreFoundation-backed class clusters that
+ bypass those methods are not included.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPMicroBenchmark : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a benchmark with a name and the block that runs the operation.
+- (instancetype)initWithName:(NSString *)name block:(SPMicroBenchmarkBlock)block;
+
+/// Factory method.
++ (instancetype)benchmarkWithName:(NSString *)name block:(SPMicroBenchmarkBlock)block;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Runs the benchmark and returns a dictionary with the keys 'name', 'iterations', 'nsPerOp'
+/// and 'allocsPerOp'.
+- (NSDictionary *)runWithMinSampleDuration:(double)seconds numSamples:(NSInteger)numSamples;
+
+/// Runs all benchmarks and returns an array with their results.
++ (NSArray *)runBenchmarks:(NSArray *)benchmarks minSampleDuration:(double)seconds
+                numSamples:(NSInteger)numSamples;
+
+/// Returns the current time of a monotonic clock, in nanoseconds.
++ (uint64_t)timestamp;
+
+/// Returns the number of objects that were allocated since the allocation counter was installed.
++ (uint64_t)numAllocations;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The name of the benchmark.
+@property (nonatomic, readonly) NSString *name;
+
+/// The block that runs the operation.
+@property (nonatomic, readonly) SPMicroBenchmarkBlock block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,203 @@
+//
+//  SPMicroBenchmark.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPMicroBenchmark.h"
+
+#import <Sparrow/SPPoolObject.h>
+#import <objc/runtime.h>
+#import <time.h>
+
+#ifdef __APPLE__
+    #import <mach/mach_time.h>
+#endif
+
+// --- allocation counter --------------------------------------------------------------------------
+
+static volatile uint64_t numAllocations = 0;
+
+static IMP originalAllocWithZone = NULL;
+static IMP originalPoolObjectAlloc = NULL;
+
+static id countingAllocWithZone(id self, SEL _cmd, NSZone *zone)
+{
+    __sync_fetch_and_add(&numAllocations, 1);
+    return ((id (*)(id, SEL, NSZone *))originalAllocWithZone)(self, _cmd, zone);
+}
+
+static id countingPoolObjectAlloc(id self, SEL _cmd)
+{
+    __sync_fetch_and_add(&numAllocations, 1);
+    return ((id (*)(id, SEL))originalPoolObjectAlloc)(self, _cmd);
+}
+
+static IMP replaceClassMethod(Class class, SEL selector, IMP implementation)
+{
+    Class metaClass = object_getClass(class);
+    Method method = class_getInstanceMethod(metaClass, selector);
+    Method superMethod = class_getSuperclass(class) ?
+        class_getInstanceMethod(object_getClass(class_getSuperclass(class)), selector) : NULL;
+
+    // only replace methods that are implemented by the class itself, not inherited ones
+    if (!method || method == superMethod) return NULL;
+    else return method_setImplementation(method, implementation);
+}
+
+static void installAllocationCounter(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^
+    {
+        // '+alloc' of NSObject ends up in '+allocWithZone:' once that method is overridden.
+        originalAllocWithZone = replaceClassMethod([NSObject class], @selector(allocWithZone:),
+                                                   (IMP)countingAllocWithZone);
+
+        // pool objects implement their own allocation (and '+allocWithZone:' calls '+alloc').
+        originalPoolObjectAlloc = replaceClassMethod([SPPoolObject class], @selector(alloc),
+                                                     (IMP)countingPoolObjectAlloc);
+    });
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPMicroBenchmark
+{
+    NSString *_name;
+    SPMicroBenchmarkBlock _block;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithName:(NSString *)name block:(SPMicroBenchmarkBlock)block
+{
+    if ((self = [super init]))
+    {
+        _name = [name copy];
+        _block = [block copy];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_name release];
+    [_block release];
+    [super dealloc];
+}
+
++ (instancetype)benchmarkWithName:(NSString *)name block:(SPMicroBenchmarkBlock)block
+{
+    return [[[self alloc] initWithName:name block:block] autorelease];
+}
+
+#pragma mark Methods
+
+- (NSDictionary *)runWithMinSampleDuration:(double)seconds numSamples:(NSInteger)numSamples
+{
+    installAllocationCounter();
+
+    uint64_t minDuration = (uint64_t)(seconds * 1.0e9);
+    NSInteger numIterations = 1;
+
+    // calibrate: double the iteration count until one sample takes long enough
+    while (YES)
+    {
+        uint64_t duration = [self sampleWithIterations:numIterations allocations:NULL];
+        if (duration >= minDuration || numIterations >= (NSInteger)1 << 40) break;
+        else if (duration * 8 < minDuration) numIterations *= 8;
+        else numIterations *= 2;
+    }
+
+    numSamples = MAX(1, numSamples);
+    double *nsPerOp = malloc(sizeof(double) * numSamples);
+    uint64_t allocations = 0;
+
+    for (NSInteger i=0; i<numSamples; ++i)
+    {
+        uint64_t sampleAllocations = 0;
+        uint64_t duration = [self sampleWithIterations:numIterations allocations:&sampleAllocations];
+        nsPerOp[i] = (double)duration / numIterations;
+        allocations += sampleAllocations;
+    }
+
+    // insertion sort -- there are only a handful of samples
+    for (NSInteger i=1; i<numSamples; ++i)
+        for (NSInteger j=i; j>0 && nsPerOp[j-1] > nsPerOp[j]; --j)
+        {
+            double temp = nsPerOp[j]; nsPerOp[j] = nsPerOp[j-1]; nsPerOp[j-1] = temp;
+        }
+
+    NSDictionary *result = @{
+        @"name":        _name,
+        @"iterations":  @(numIterations),
+        @"nsPerOp":     @(nsPerOp[numSamples / 2]),
+        @"allocsPerOp": @((double)allocations / (numIterations * numSamples))
+    };
+
+    free(nsPerOp);
+    return result;
+}
+
++ (NSArray *)runBenchmarks:(NSArray *)benchmarks minSampleDuration:(double)seconds
+                numSamples:(NSInteger)numSamples
+{
+    NSMutableArray *results = [NSMutableArray array];
+
+    for (SPMicroBenchmark *benchmark in benchmarks)
+    {
+        NSDictionary *result = [benchmark runWithMinSampleDuration:seconds numSamples:numSamples];
+        [results addObject:result];
+
+        fprintf(stderr, "%-50s %12.1f ns/op %10.2f allocs/op\n", [benchmark.name UTF8String],
+               [result[@"nsPerOp"] doubleValue], [result[@"allocsPerOp"] doubleValue]);
+    }
+
+    return results;
+}
+
++ (uint64_t)timestamp
+{
+  #ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+  #else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+  #endif
+}
+
++ (uint64_t)numAllocations
+{
+    return numAllocations;
+}
+
+#pragma mark Private
+
+- (uint64_t)sampleWithIterations:(NSInteger)numIterations allocations:(uint64_t *)allocations
+{
+    uint64_t startTime, endTime, startAllocations;
+
+    @autoreleasepool
+    {
+        startAllocations = numAllocations;
+        startTime = [SPMicroBenchmark timestamp];
+
+        _block(numIterations);
+
+        endTime = [SPMicroBenchmark timestamp];
+        if (allocations) *allocations = numAllocations - startAllocations;
+    }
+
+    return endTime - startTime;
+}
+
+@end
@@ -0,0 +1,58 @@
+//
+//  SPMicroBenchmarks.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+@class SPMicroBenchmark;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Set to '1' to include the benchmarks that require the complete engine (tweens, events and
+/// bitmap font layout). That's the default on Apple platforms; the GNUstep build only contains
+/// the math and data classes.
+#ifndef SP_MICROBENCHMARK_FULL_ENGINE
+    #ifdef __APPLE__
+        #define SP_MICROBENCHMARK_FULL_ENGINE 1
+    #else
+        #define SP_MICROBENCHMARK_FULL_ENGINE 0
+    #endif
+#endif
+
+/** ------------------------------------------------------------------------------------------------
+
+ The collection of micro benchmarks for Sparrow's hot paths.
+
+ The core benchmarks cover matrix math, vertex data transformation, bounds calculation, polygon
+ triangulation and the object pool; they don't need a rendering context. The engine benchmarks
+ cover tweens, event dispatching and bitmap font layout; the latter creates a texture, so an
+ `SPContext` must be current when they are executed.
+
+ On Linux, the core benchmarks can be built with GNUstep (see the 'GNUmakefile' in this folder).
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPMicroBenchmarks : NSObject
+
+/// The benchmarks that only depend on the math and data classes.
++ (SP_GENERIC(NSArray, SPMicroBenchmark*) *)coreBenchmarks;
+
+/// The benchmarks that depend on the complete engine. Empty if
+/// 'SP_MICROBENCHMARK_FULL_ENGINE' is disabled.
++ (SP_GENERIC(NSArray, SPMicroBenchmark*) *)engineBenchmarks;
+
+/// Runs the given benchmarks with default settings and writes the results as JSON to the given
+/// path (or to standard output, if the path is nil).
++ (BOOL)runBenchmarks:(SP_GENERIC(NSArray, SPMicroBenchmark*) *)benchmarks
+        writeResultsToFile:(nullable NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
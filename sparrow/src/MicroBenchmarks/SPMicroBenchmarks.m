@@ -0,0 +1,322 @@
+//
+//  SPMicroBenchmarks.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPMicroBenchmark.h"
+#import "SPMicroBenchmarks.h"
+
+#import <Sparrow/SPIndexData.h>
+#import <Sparrow/SPMacros.h>
+#import <Sparrow/SPMatrix.h>
+#import <Sparrow/SPMatrix3D.h>
+#import <Sparrow/SPPoint.h>
+#import <Sparrow/SPPolygon.h>
+#import <Sparrow/SPRectangle.h>
+#import <Sparrow/SPVertexData.h>
+
+#if SP_MICROBENCHMARK_FULL_ENGINE
+    #import <Sparrow/SPBitmapFont.h>
+    #import <Sparrow/SPEvent.h>
+    #import <Sparrow/SPEventDispatcher.h>
+    #import <Sparrow/SPQuadBatch.h>
+    #import <Sparrow/SPSprite.h>
+    #import <Sparrow/SPTransitions.h>
+    #import <Sparrow/SPTween.h>
+#endif
+
+#define MIN_SAMPLE_DURATION 0.05
+#define NUM_SAMPLES         7
+#define NUM_VERTICES        64
+
+// results are written to this variable, so that the compiler can't optimize the work away
+static volatile float sink = 0.0f;
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPMicroBenchmarks
+
+#pragma mark Methods
+
++ (NSArray *)coreBenchmarks
+{
+    NSMutableArray *benchmarks = [NSMutableArray array];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix.appendMatrix"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix *matrix = [SPMatrix matrixWithIdentity];
+        SPMatrix *other = [SPMatrix matrixWithA:1.0f b:0.001f c:-0.001f d:1.0f tx:0.5f ty:0.25f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [matrix appendMatrix:other];
+
+        sink = matrix.tx;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix.prependMatrix"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix *matrix = [SPMatrix matrixWithIdentity];
+        SPMatrix *other = [SPMatrix matrixWithA:1.0f b:0.001f c:-0.001f d:1.0f tx:0.5f ty:0.25f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [matrix prependMatrix:other];
+
+        sink = matrix.tx;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix.invert"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix *matrix = [SPMatrix matrixWithA:2.0f b:0.5f c:-0.5f d:2.0f tx:10.0f ty:20.0f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [matrix invert];
+
+        sink = matrix.tx;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix.transformPointWithX:y:"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix *matrix = [SPMatrix matrixWithRotation:PI / 8.0f];
+        float sum = 0.0f;
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            sum += [matrix transformPointWithX:i y:1.0f].x;
+
+        sink = sum;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix3D.appendMatrix"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix3D *matrix = [SPMatrix3D matrix3DWithIdentity];
+        SPMatrix3D *other = [SPMatrix3D matrix3DWithRotationZ:0.001f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [matrix appendMatrix:other];
+
+        sink = matrix.determinant;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPMatrix3D.invert"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPMatrix3D *matrix = [SPMatrix3D matrix3DWithRotation:0.5f x:1.0f y:1.0f z:0.0f];
+        [matrix appendTranslationX:10.0f y:20.0f z:30.0f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [matrix invert];
+
+        sink = matrix.determinant;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPVertexData.copyTransformedToVertexData (64 vertices)"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPVertexData *source = [self vertexDataWithNumVertices:NUM_VERTICES];
+        SPVertexData *target = [[SPVertexData alloc] initWithSize:NUM_VERTICES];
+        SPMatrix *matrix = [SPMatrix matrixWithRotation:PI / 8.0f];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [source copyTransformedToVertexData:target atIndex:0 matrix:matrix];
+
+        sink = [target vertexAtIndex:NUM_VERTICES-1].position.x;
+        [target release];
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPVertexData.boundsAfterTransformation (64 vertices)"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPVertexData *vertexData = [self vertexDataWithNumVertices:NUM_VERTICES];
+        SPMatrix *matrix = [SPMatrix matrixWithRotation:PI / 8.0f];
+        float sum = 0.0f;
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            sum += [vertexData boundsAfterTransformation:matrix].width;
+
+        sink = sum;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPRectangle.boundsAfterTransformation"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPRectangle *rectangle = [SPRectangle rectangleWithX:10.0f y:20.0f width:100.0f height:50.0f];
+        SPMatrix *matrix = [SPMatrix matrixWithRotation:PI / 8.0f];
+        float sum = 0.0f;
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            sum += [rectangle boundsAfterTransformation:matrix].width;
+
+        sink = sum;
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPPolygon.triangulate (circle)"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPPolygon *polygon = [SPPolygon circleWithX:0.0f y:0.0f radius:100.0f];
+        SPIndexData *indexData = [[SPIndexData alloc] init];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [polygon triangulate:indexData];
+
+        sink = indexData.numIndices;
+        [indexData release];
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPPoint alloc/release (pooled)"
+                                                        block:^(NSInteger numIterations)
+    {
+        float sum = 0.0f;
+
+        for (NSInteger i=0; i<numIterations; ++i)
+        {
+            SPPoint *point = [[SPPoint alloc] initWithX:i y:1.0f];
+            sum += point.x;
+            [point release];
+        }
+
+        sink = sum;
+    }]];
+
+    return benchmarks;
+}
+
++ (NSArray *)engineBenchmarks
+{
+    NSMutableArray *benchmarks = [NSMutableArray array];
+
+  #if SP_MICROBENCHMARK_FULL_ENGINE
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPTween.advanceTime (2 properties)"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPSprite *sprite = [[SPSprite alloc] init];
+        SPTween *tween = [[SPTween alloc] initWithTarget:sprite time:1.0 transition:SPTransitionEaseInOut];
+        [tween moveToX:100.0f y:200.0f];
+        tween.repeatCount = 0;
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [tween advanceTime:1.0 / 60.0];
+
+        sink = sprite.x;
+        [tween release];
+        [sprite release];
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPEventDispatcher.dispatchEventWithType"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPEventDispatcher *dispatcher = [[SPEventDispatcher alloc] init];
+        __block NSInteger numEvents = 0;
+
+        [dispatcher addEventListenerForType:SPEventTypeTriggered block:^(SPEvent *event)
+        {
+            ++numEvents;
+        }];
+
+        for (NSInteger i=0; i<numIterations; ++i)
+            [dispatcher dispatchEventWithType:SPEventTypeTriggered];
+
+        sink = numEvents;
+        [dispatcher release];
+    }]];
+
+    [benchmarks addObject:[SPMicroBenchmark benchmarkWithName:@"SPBitmapFont.fillQuadBatch (64 chars)"
+                                                        block:^(NSInteger numIterations)
+    {
+        SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+        SPQuadBatch *quadBatch = [[SPQuadBatch alloc] init];
+        NSString *text = @"The quick brown fox jumps over the lazy dog. Sphinx of black quartz";
+
+        for (NSInteger i=0; i<numIterations; ++i)
+        {
+            [quadBatch reset];
+            [font fillQuadBatch:quadBatch withWidth:120.0f height:200.0f text:text fontSize:-1
+                          color:0xffffff hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO
+                        kerning:YES leading:0.0f];
+        }
+
+        sink = quadBatch.numQuads;
+        [quadBatch release];
+        [font release];
+    }]];
+
+  #endif
+
+    return benchmarks;
+}
+
++ (BOOL)runBenchmarks:(NSArray *)benchmarks writeResultsToFile:(NSString *)path
+{
+    NSArray *results = [SPMicroBenchmark runBenchmarks:benchmarks
+                                     minSampleDuration:MIN_SAMPLE_DURATION
+                                            numSamples:NUM_SAMPLES];
+
+    NSDictionary *output = @{
+        @"engine":     @"Sparrow",
+        @"platform":   [[NSProcessInfo processInfo] operatingSystemVersionString],
+        @"benchmarks": results
+    };
+
+    NSError *error = nil;
+    NSData *json = [NSJSONSerialization dataWithJSONObject:output
+                                                   options:NSJSONWritingPrettyPrinted error:&error];
+    if (!json)
+    {
+        NSLog(@"Could not serialize micro benchmark results: %@", error);
+        return NO;
+    }
+
+    if (path) return [json writeToFile:path atomically:YES];
+    else
+    {
+        fwrite(json.bytes, 1, json.length, stdout);
+        fputc('\n', stdout);
+        return YES;
+    }
+}
+
+#pragma mark Private
+
++ (SPVertexData *)vertexDataWithNumVertices:(NSInteger)numVertices
+{
+    SPVertexData *vertexData = [[SPVertexData alloc] initWithSize:numVertices];
+
+    for (NSInteger i=0; i<numVertices; ++i)
+    {
+        float angle = TWO_PI * i / numVertices;
+        [vertexData setPositionWithX:cosf(angle) * 100.0f y:sinf(angle) * 50.0f atIndex:i];
+        [vertexData setTexCoordsWithX:0.5f y:0.5f atIndex:i];
+    }
+
+    return [vertexData autorelease];
+}
+
+@end
+
+// --- command line tool ---------------------------------------------------------------------------
+
+#ifdef SP_MICROBENCHMARK_MAIN
+
+int main(int argc, const char *argv[])
+{
+    @autoreleasepool
+    {
+        NSString *path = argc > 1 ? [NSString stringWithUTF8String:argv[1]] : nil;
+        NSMutableArray *benchmarks = [NSMutableArray arrayWithArray:[SPMicroBenchmarks coreBenchmarks]];
+        [benchmarks addObjectsFromArray:[SPMicroBenchmarks engineBenchmarks]];
+
+        return [SPMicroBenchmarks runBenchmarks:benchmarks writeResultsToFile:path] ? 0 : 1;
+    }
+}
+
+#endif
@@ -0,0 +1,14 @@
+//
+//  Availability.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//
+
+#ifndef SP_COMPAT_AVAILABILITY_H
+#define SP_COMPAT_AVAILABILITY_H
+
+#define __IPHONE_OS_VERSION_MIN_ALLOWED 0
+#define __IPHONE_OS_VERSION_MAX_ALLOWED 0
+
+#endif
@@ -0,0 +1,44 @@
+//
+//  CGGeometry.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//
+
+#ifndef SP_COMPAT_CG_GEOMETRY_H
+#define SP_COMPAT_CG_GEOMETRY_H
+
+#ifndef CGFLOAT_DEFINED
+    #if defined(__LP64__) && __LP64__
+        typedef double CGFloat;
+        #define CGFLOAT_IS_DOUBLE 1
+    #else
+        typedef float CGFloat;
+        #define CGFLOAT_IS_DOUBLE 0
+    #endif
+    #define CGFLOAT_DEFINED 1
+#endif
+
+typedef struct CGPoint { CGFloat x, y; } CGPoint;
+typedef struct CGSize  { CGFloat width, height; } CGSize;
+typedef struct CGRect  { CGPoint origin; CGSize size; } CGRect;
+
+static __inline__ CGPoint CGPointMake(CGFloat x, CGFloat y)
+{
+    CGPoint point = { x, y };
+    return point;
+}
+
+static __inline__ CGSize CGSizeMake(CGFloat width, CGFloat height)
+{
+    CGSize size = { width, height };
+    return size;
+}
+
+static __inline__ CGRect CGRectMake(CGFloat x, CGFloat y, CGFloat width, CGFloat height)
+{
+    CGRect rect = { { x, y }, { width, height } };
+    return rect;
+}
+
+#endif
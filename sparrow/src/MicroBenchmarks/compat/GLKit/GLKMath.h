@@ -0,0 +1,85 @@
+//
+//  GLKMath.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//  Only the types and functions that are used by Sparrow's math classes are provided.
+//
+
+#ifndef SP_COMPAT_GLK_MATH_H
+#define SP_COMPAT_GLK_MATH_H
+
+#include <stdbool.h>
+
+typedef union
+{
+    struct { float x, y; };
+    struct { float s, t; };
+    float v[2];
+}
+GLKVector2;
+
+typedef union
+{
+    struct { float x, y, z; };
+    struct { float r, g, b; };
+    float v[3];
+}
+GLKVector3;
+
+typedef union
+{
+    struct { float x, y, z, w; };
+    struct { float r, g, b, a; };
+    float v[4];
+}
+GLKVector4;
+
+typedef union
+{
+    struct
+    {
+        float m00, m01, m02;
+        float m10, m11, m12;
+        float m20, m21, m22;
+    };
+    float m[9];
+}
+GLKMatrix3;
+
+typedef union
+{
+    struct
+    {
+        float m00, m01, m02, m03;
+        float m10, m11, m12, m13;
+        float m20, m21, m22, m23;
+        float m30, m31, m32, m33;
+    };
+    float m[16];
+}
+GLKMatrix4;
+
+static const GLKMatrix4 GLKMatrix4Identity = {{ 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 }};
+
+static __inline__ GLKVector2 GLKVector2Make(float x, float y)
+{
+    GLKVector2 v = {{ x, y }};
+    return v;
+}
+
+static __inline__ GLKVector4 GLKVector4Make(float x, float y, float z, float w)
+{
+    GLKVector4 v = {{ x, y, z, w }};
+    return v;
+}
+
+static __inline__ GLKMatrix3 GLKMatrix3Make(float m00, float m01, float m02,
+                                            float m10, float m11, float m12,
+                                            float m20, float m21, float m22)
+{
+    GLKMatrix3 m = {{ m00, m01, m02,  m10, m11, m12,  m20, m21, m22 }};
+    return m;
+}
+
+#endif
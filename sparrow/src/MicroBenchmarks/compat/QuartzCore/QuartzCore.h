@@ -0,0 +1,6 @@
+//
+//  QuartzCore.h
+//  Sparrow
+//
+//  Empty stand-in for the Apple header; the benchmarked classes don't use QuartzCore.
+//
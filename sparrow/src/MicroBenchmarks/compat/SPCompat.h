@@ -0,0 +1,22 @@
+//
+//  SPCompat.h
+//  Sparrow
+//
+//  Prefix header for building the micro benchmarks with GNUstep. It provides the few BSD
+//  functions that are not part of older versions of glibc.
+//
+
+#ifndef SP_COMPAT_H
+#define SP_COMPAT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 36))
+static __inline__ uint32_t arc4random(void)
+{
+    return ((uint32_t)random() << 16) ^ (uint32_t)random();
+}
+#endif
+
+#endif
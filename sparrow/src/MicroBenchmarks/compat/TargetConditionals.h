@@ -0,0 +1,17 @@
+//
+//  TargetConditionals.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//
+
+#ifndef SP_COMPAT_TARGET_CONDITIONALS_H
+#define SP_COMPAT_TARGET_CONDITIONALS_H
+
+#define TARGET_OS_MAC       0
+#define TARGET_OS_IPHONE    0
+#define TARGET_OS_IOS       0
+#define TARGET_OS_TV        0
+#define TARGET_OS_SIMULATOR 0
+
+#endif
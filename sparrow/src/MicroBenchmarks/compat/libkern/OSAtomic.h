@@ -0,0 +1,61 @@
+//
+//  OSAtomic.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//  The queue functions are protected by a spin lock (like the original, they are LIFO).
+//
+
+#ifndef SP_COMPAT_OS_ATOMIC_H
+#define SP_COMPAT_OS_ATOMIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    void *opaque1;
+    long  opaque2;
+}
+OSQueueHead;
+
+#define OS_ATOMIC_QUEUE_INIT { NULL, 0 }
+
+static __inline__ void OSCompatLockQueue(OSQueueHead *list)
+{
+    while (__atomic_exchange_n(&list->opaque2, 1, __ATOMIC_ACQUIRE)) {}
+}
+
+static __inline__ void OSCompatUnlockQueue(OSQueueHead *list)
+{
+    __atomic_store_n(&list->opaque2, 0, __ATOMIC_RELEASE);
+}
+
+static __inline__ void OSAtomicEnqueue(OSQueueHead *list, void *element, size_t offset)
+{
+    OSCompatLockQueue(list);
+    *(void **)((char *)element + offset) = list->opaque1;
+    list->opaque1 = element;
+    OSCompatUnlockQueue(list);
+}
+
+static __inline__ void *OSAtomicDequeue(OSQueueHead *list, size_t offset)
+{
+    OSCompatLockQueue(list);
+    void *element = list->opaque1;
+    if (element) list->opaque1 = *(void **)((char *)element + offset);
+    OSCompatUnlockQueue(list);
+    return element;
+}
+
+static __inline__ int32_t OSAtomicIncrement32(volatile int32_t *value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static __inline__ int32_t OSAtomicDecrement32(volatile int32_t *value)
+{
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,15 @@
+//
+//  malloc.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//
+
+#ifndef SP_COMPAT_MALLOC_H
+#define SP_COMPAT_MALLOC_H
+
+#include <malloc.h>
+
+#define malloc_size(ptr) malloc_usable_size((void *)(ptr))
+
+#endif
@@ -0,0 +1,148 @@
+//
+//  simd.h
+//  Sparrow
+//
+//  Minimal stand-in for the Apple header, used when building the micro benchmarks with GNUstep.
+//  Requires clang (vector extensions and overloadable functions). Only the functions that are
+//  used by Sparrow's math classes are provided.
+//
+
+#ifndef SP_COMPAT_SIMD_H
+#define SP_COMPAT_SIMD_H
+
+#include <math.h>
+#include <stdbool.h>
+
+#define __SIMD_ATTRIBUTES__ __attribute__((__overloadable__, __always_inline__, __const__))
+#define __SIMD_INLINE__     static __inline__ __SIMD_ATTRIBUTES__
+
+typedef float vector_float3 __attribute__((__ext_vector_type__(3)));
+typedef float vector_float4 __attribute__((__ext_vector_type__(4)));
+
+typedef int   vector_int4   __attribute__((__ext_vector_type__(4)));
+
+typedef struct { vector_float4 columns[4]; } matrix_float4x4;
+
+// 'matrix_identity_float4x4' and 'matrix_almost_equal_elements' are provided by SPMatrix3D
+
+// --- vectors -------------------------------------------------------------------------------------
+
+__SIMD_INLINE__ float vector_dot(vector_float3 a, vector_float3 b)
+{
+    vector_float3 p = a * b;
+    return p.x + p.y + p.z;
+}
+
+__SIMD_INLINE__ float vector_dot(vector_float4 a, vector_float4 b)
+{
+    vector_float4 p = a * b;
+    return p.x + p.y + p.z + p.w;
+}
+
+__SIMD_INLINE__ float vector_length_squared(vector_float3 v) { return vector_dot(v, v); }
+__SIMD_INLINE__ float vector_length_squared(vector_float4 v) { return vector_dot(v, v); }
+__SIMD_INLINE__ float vector_length(vector_float3 v) { return sqrtf(vector_dot(v, v)); }
+__SIMD_INLINE__ float vector_length(vector_float4 v) { return sqrtf(vector_dot(v, v)); }
+__SIMD_INLINE__ vector_float3 vector_normalize(vector_float3 v) { return v / vector_length(v); }
+__SIMD_INLINE__ vector_float4 vector_normalize(vector_float4 v) { return v / vector_length(v); }
+
+__SIMD_INLINE__ vector_float3 vector_cross(vector_float3 a, vector_float3 b)
+{
+    return a.yzx * b.zxy - a.zxy * b.yzx;
+}
+
+__SIMD_INLINE__ bool vector_all(vector_int4 mask)
+{
+    return (mask.x & mask.y & mask.z & mask.w) < 0;
+}
+
+__SIMD_INLINE__ vector_float4 __tg_fabs(vector_float4 v)
+{
+    return (vector_float4){ fabsf(v.x), fabsf(v.y), fabsf(v.z), fabsf(v.w) };
+}
+
+// --- matrices ------------------------------------------------------------------------------------
+
+__SIMD_INLINE__ matrix_float4x4 matrix_from_columns(vector_float4 c0, vector_float4 c1,
+                                                    vector_float4 c2, vector_float4 c3)
+{
+    matrix_float4x4 m = {{ c0, c1, c2, c3 }};
+    return m;
+}
+
+__SIMD_INLINE__ matrix_float4x4 matrix_from_diagonal(vector_float4 d)
+{
+    matrix_float4x4 m = {{ (vector_float4){ d.x, 0, 0, 0 }, (vector_float4){ 0, d.y, 0, 0 },
+                           (vector_float4){ 0, 0, d.z, 0 }, (vector_float4){ 0, 0, 0, d.w } }};
+    return m;
+}
+
+__SIMD_INLINE__ vector_float4 matrix_multiply(matrix_float4x4 m, vector_float4 v)
+{
+    return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+}
+
+__SIMD_INLINE__ matrix_float4x4 matrix_multiply(matrix_float4x4 a, matrix_float4x4 b)
+{
+    return matrix_from_columns(matrix_multiply(a, b.columns[0]), matrix_multiply(a, b.columns[1]),
+                               matrix_multiply(a, b.columns[2]), matrix_multiply(a, b.columns[3]));
+}
+
+__SIMD_INLINE__ matrix_float4x4 matrix_transpose(matrix_float4x4 m)
+{
+    matrix_float4x4 t;
+    for (int i=0; i<4; ++i)
+        for (int j=0; j<4; ++j)
+            t.columns[i][j] = m.columns[j][i];
+    return t;
+}
+
+__SIMD_INLINE__ float matrix_determinant(matrix_float4x4 m)
+{
+    const vector_float4 *c = m.columns;
+    float s0 = c[0][0] * c[1][1] - c[1][0] * c[0][1];
+    float s1 = c[0][0] * c[1][2] - c[1][0] * c[0][2];
+    float s2 = c[0][0] * c[1][3] - c[1][0] * c[0][3];
+    float s3 = c[0][1] * c[1][2] - c[1][1] * c[0][2];
+    float s4 = c[0][1] * c[1][3] - c[1][1] * c[0][3];
+    float s5 = c[0][2] * c[1][3] - c[1][2] * c[0][3];
+    float c5 = c[2][2] * c[3][3] - c[3][2] * c[2][3];
+    float c4 = c[2][1] * c[3][3] - c[3][1] * c[2][3];
+    float c3 = c[2][1] * c[3][2] - c[3][1] * c[2][2];
+    float c2 = c[2][0] * c[3][3] - c[3][0] * c[2][3];
+    float c1 = c[2][0] * c[3][2] - c[3][0] * c[2][2];
+    float c0 = c[2][0] * c[3][1] - c[3][0] * c[2][1];
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+__SIMD_INLINE__ matrix_float4x4 matrix_invert(matrix_float4x4 m)
+{
+    float a[16], inv[16];
+    for (int i=0; i<16; ++i) a[i] = m.columns[i / 4][i % 4];
+
+    inv[0]  =  a[5]*a[10]*a[15] - a[5]*a[11]*a[14] - a[9]*a[6]*a[15] + a[9]*a[7]*a[14] + a[13]*a[6]*a[11] - a[13]*a[7]*a[10];
+    inv[4]  = -a[4]*a[10]*a[15] + a[4]*a[11]*a[14] + a[8]*a[6]*a[15] - a[8]*a[7]*a[14] - a[12]*a[6]*a[11] + a[12]*a[7]*a[10];
+    inv[8]  =  a[4]*a[9]*a[15]  - a[4]*a[11]*a[13] - a[8]*a[5]*a[15] + a[8]*a[7]*a[13] + a[12]*a[5]*a[11] - a[12]*a[7]*a[9];
+    inv[12] = -a[4]*a[9]*a[14]  + a[4]*a[10]*a[13] + a[8]*a[5]*a[14] - a[8]*a[6]*a[13] - a[12]*a[5]*a[10] + a[12]*a[6]*a[9];
+    inv[1]  = -a[1]*a[10]*a[15] + a[1]*a[11]*a[14] + a[9]*a[2]*a[15] - a[9]*a[3]*a[14] - a[13]*a[2]*a[11] + a[13]*a[3]*a[10];
+    inv[5]  =  a[0]*a[10]*a[15] - a[0]*a[11]*a[14] - a[8]*a[2]*a[15] + a[8]*a[3]*a[14] + a[12]*a[2]*a[11] - a[12]*a[3]*a[10];
+    inv[9]  = -a[0]*a[9]*a[15]  + a[0]*a[11]*a[13] + a[8]*a[1]*a[15] - a[8]*a[3]*a[13] - a[12]*a[1]*a[11] + a[12]*a[3]*a[9];
+    inv[13] =  a[0]*a[9]*a[14]  - a[0]*a[10]*a[13] - a[8]*a[1]*a[14] + a[8]*a[2]*a[13] + a[12]*a[1]*a[10] - a[12]*a[2]*a[9];
+    inv[2]  =  a[1]*a[6]*a[15]  - a[1]*a[7]*a[14]  - a[5]*a[2]*a[15] + a[5]*a[3]*a[14] + a[13]*a[2]*a[7]  - a[13]*a[3]*a[6];
+    inv[6]  = -a[0]*a[6]*a[15]  + a[0]*a[7]*a[14]  + a[4]*a[2]*a[15] - a[4]*a[3]*a[14] - a[12]*a[2]*a[7]  + a[12]*a[3]*a[6];
+    inv[10] =  a[0]*a[5]*a[15]  - a[0]*a[7]*a[13]  - a[4]*a[1]*a[15] + a[4]*a[3]*a[13] + a[12]*a[1]*a[7]  - a[12]*a[3]*a[5];
+    inv[14] = -a[0]*a[5]*a[14]  + a[0]*a[6]*a[13]  + a[4]*a[1]*a[14] - a[4]*a[2]*a[13] - a[12]*a[1]*a[6]  + a[12]*a[2]*a[5];
+    inv[3]  = -a[1]*a[6]*a[11]  + a[1]*a[7]*a[10]  + a[5]*a[2]*a[11] - a[5]*a[3]*a[10] - a[9]*a[2]*a[7]   + a[9]*a[3]*a[6];
+    inv[7]  =  a[0]*a[6]*a[11]  - a[0]*a[7]*a[10]  - a[4]*a[2]*a[11] + a[4]*a[3]*a[10] + a[8]*a[2]*a[7]   - a[8]*a[3]*a[6];
+    inv[11] = -a[0]*a[5]*a[11]  + a[0]*a[7]*a[9]   + a[4]*a[1]*a[11] - a[4]*a[3]*a[9]  - a[8]*a[1]*a[7]   + a[8]*a[3]*a[5];
+    inv[15] =  a[0]*a[5]*a[10]  - a[0]*a[6]*a[9]   - a[4]*a[1]*a[10] + a[4]*a[2]*a[9]  + a[8]*a[1]*a[6]   - a[8]*a[2]*a[5];
+
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+
+    matrix_float4x4 result;
+    for (int i=0; i<16; ++i) result.columns[i / 4][i % 4] = inv[i] * invDet;
+    return result;
+}
+
+#endif
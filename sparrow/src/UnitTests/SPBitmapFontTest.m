@@ -0,0 +1,324 @@
+//
+//  SPBitmapFontTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPBitmapFontTest : SPTestCase
+
+@end
+
+// incremental layout is internal API of the framework
+@interface SPBitmapFont (Internal)
+
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withWidth:(float)width height:(float)height
+                 text:(NSString *)text fontSize:(float)size color:(uint)color
+               hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+              kerning:(BOOL)kerning leading:(float)leading
+                lines:(NSMutableData *)lines numUnchangedChars:(NSInteger)numUnchangedChars;
+
+@end
+
+@implementation SPBitmapFontTest
+
+- (SPBitmapChar *)charWithID:(int)charID texture:(SPTexture *)texture
+{
+    return [[SPBitmapChar alloc] initWithID:charID texture:texture xOffset:0 yOffset:0 xAdvance:10];
+}
+
+- (void)testCharLookup
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:16 height:16];
+
+    XCTAssertEqual('A', [font charByID:'A'].charID, @"wrong char");
+    XCTAssertNil([font charByID:0x4e2d], @"char should not exist");
+
+    // far away from the other chars, and outside of the Basic Multilingual Plane
+    int charIDs[] = { 0x4e2d, 0x1f600, 0x4e2e, -5 };
+
+    for (int i=0; i<4; ++i)
+        [font addBitmapChar:[self charWithID:charIDs[i] texture:texture] charID:charIDs[i]];
+
+    for (int i=0; i<4; ++i)
+        XCTAssertEqual(charIDs[i], [font charByID:charIDs[i]].charID, @"wrong char");
+
+    XCTAssertEqual('A', [font charByID:'A'].charID, @"wrong char");
+    XCTAssertNil([font charByID:0x4e2c], @"char should not exist");
+    XCTAssertTrue([font.allCharIDs containsObject:@(0x1f600)], @"char ID missing");
+
+    // replacing a char
+    SPBitmapChar *newChar = [self charWithID:'A' texture:texture];
+    [font addBitmapChar:newChar charID:'A'];
+    XCTAssertEqual(newChar, [font charByID:'A'], @"char was not replaced");
+}
+
+- (void)testKerning
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:16 height:16];
+
+    [font addKerning:-2.0f betweenChar:'A' andChar:'V'];
+    XCTAssertEqualWithAccuracy(-2.0f, [font kerningBetweenChar:'A' andChar:'V'], E, @"wrong kerning");
+    XCTAssertEqualWithAccuracy( 0.0f, [font kerningBetweenChar:'V' andChar:'A'], E, @"wrong kerning");
+    XCTAssertEqualWithAccuracy( 0.0f, [font kerningBetweenChar:-1 andChar:'V'], E, @"wrong kerning");
+
+    // kerning of a char is taken over when it's added
+    SPBitmapChar *bitmapChar = [self charWithID:'W' texture:texture];
+    [bitmapChar addKerning:-3.0f toChar:'A'];
+    [font addBitmapChar:bitmapChar charID:'W'];
+    XCTAssertEqualWithAccuracy(-3.0f, [font kerningBetweenChar:'A' andChar:'W'], E, @"wrong kerning");
+
+    // ... and so is kerning that is added to it afterwards
+    [[font charByID:'W'] addKerning:-4.0f toChar:'V'];
+    XCTAssertEqualWithAccuracy(-4.0f, [font kerningBetweenChar:'V' andChar:'W'], E, @"wrong kerning");
+
+    // all IDs are valid keys
+    [font addKerning:-5.0f betweenChar:-1 andChar:-1];
+    XCTAssertEqualWithAccuracy(-5.0f, [font kerningBetweenChar:-1 andChar:-1], E, @"wrong kerning");
+
+    for (int i=0; i<1000; ++i)
+        [font addKerning:i betweenChar:i andChar:i+1];
+
+    for (int i=0; i<1000; ++i)
+        XCTAssertEqualWithAccuracy(i, [font kerningBetweenChar:i andChar:i+1], E, @"wrong kerning");
+}
+
+- (void)appendBlock:(uint8_t)type bytes:(const void *)bytes length:(uint32_t)length
+             toData:(NSMutableData *)data
+{
+    [data appendBytes:&type length:1];
+    [data appendBytes:&length length:4];
+    [data appendBytes:bytes length:length];
+}
+
+- (void)testBinaryFormat
+{
+    NSMutableData *data = [NSMutableData dataWithBytes:"BMF\3" length:4];
+
+    uint8_t info[] = { 20, 0, 1, 0, 100, 0, 1, 0, 0, 0, 0, 0, 0, 0, 'T', 'e', 's', 't', 0 };
+    [self appendBlock:1 bytes:info length:sizeof(info) toData:data];
+
+    uint16_t common[] = { 24, 18, 64, 64, 1, 0, 0, 0 };
+    [self appendBlock:2 bytes:common length:15 toData:data];
+
+    [self appendBlock:3 bytes:"test.png" length:9 toData:data];
+
+    // id, x, y, width, height, xoffset, yoffset, xadvance, page, channel
+    uint8_t chars[] = { 'A', 0, 0, 0,   0, 0,  0, 0,  10, 0, 12, 0,  1, 0,  2, 0,  11, 0,  0, 15,
+                        'V', 0, 0, 0,  10, 0,  0, 0,  10, 0, 12, 0,  0, 0,  2, 0,  10, 0,  0, 15 };
+    [self appendBlock:4 bytes:chars length:sizeof(chars) toData:data];
+
+    uint8_t kernings[] = { 'A', 0, 0, 0,  'V', 0, 0, 0,  0xfe, 0xff };
+    [self appendBlock:5 bytes:kernings length:sizeof(kernings) toData:data];
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:64 height:64];
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithContentsOfData:data texture:texture];
+
+    XCTAssertEqualObjects(@"Test", font.name, @"wrong name");
+    XCTAssertEqualWithAccuracy(20.0f, font.size, E, @"wrong size");
+    XCTAssertEqualWithAccuracy(24.0f, font.lineHeight, E, @"wrong line height");
+    XCTAssertEqualWithAccuracy(18.0f, font.baseline, E, @"wrong baseline");
+
+    SPBitmapChar *charV = [font charByID:'V'];
+    XCTAssertEqual(2, (int)font.allCharIDs.count, @"wrong number of chars");
+    XCTAssertEqualWithAccuracy(10.0f, charV.width, E, @"wrong width");
+    XCTAssertEqualWithAccuracy(12.0f, charV.height, E, @"wrong height");
+    XCTAssertEqualWithAccuracy( 2.0f, charV.yOffset, E, @"wrong y offset");
+    XCTAssertEqualWithAccuracy(10.0f, charV.xAdvance, E, @"wrong x advance");
+    XCTAssertEqualWithAccuracy( 1.0f, [font charByID:'A'].xOffset, E, @"wrong x offset");
+    XCTAssertEqualWithAccuracy(-2.0f, [font kerningBetweenChar:'A' andChar:'V'], E, @"wrong kerning");
+    XCTAssertEqualWithAccuracy(-2.0f, [charV kerningToChar:'A'], E, @"wrong kerning");
+}
+
+- (void)compareIncrementalLayoutOfFont:(SPBitmapFont *)font fromText:(NSString *)oldText
+                                toText:(NSString *)newText
+{
+    SPHAlign hAligns[] = { SPHAlignLeft, SPHAlignCenter, SPHAlignRight };
+    SPVAlign vAligns[] = { SPVAlignTop, SPVAlignCenter, SPVAlignBottom };
+
+    for (int h=0; h<3; ++h)
+        for (int v=0; v<3; ++v)
+            [self compareIncrementalLayoutOfFont:font fromText:oldText toText:newText
+                                          hAlign:hAligns[h] vAlign:vAligns[v]];
+}
+
+- (void)compareIncrementalLayoutOfFont:(SPBitmapFont *)font fromText:(NSString *)oldText
+                                toText:(NSString *)newText hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+{
+    NSInteger numUnchangedChars = [oldText commonPrefixWithString:newText options:NSLiteralSearch].length;
+
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    NSMutableData *lines = [NSMutableData data];
+    [font fillQuadBatch:quadBatch withWidth:40 height:200 text:oldText fontSize:-1 color:SPColorWhite
+                 hAlign:hAlign vAlign:vAlign kerning:YES leading:0 lines:lines numUnchangedChars:0];
+    [font fillQuadBatch:quadBatch withWidth:40 height:200 text:newText fontSize:-1 color:SPColorWhite
+                 hAlign:hAlign vAlign:vAlign kerning:YES leading:0 lines:lines
+      numUnchangedChars:numUnchangedChars];
+
+    // the incremental layout must match the complete one
+    SPQuadBatch *expectedQuadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:expectedQuadBatch withWidth:40 height:200 text:newText fontSize:-1
+                  color:SPColorWhite hAlign:hAlign vAlign:vAlign autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqual(expectedQuadBatch.numQuads, quadBatch.numQuads, @"wrong number of quads");
+
+    for (NSInteger i=0; i<MIN(quadBatch.numQuads, expectedQuadBatch.numQuads); ++i)
+        XCTAssertTrue([[expectedQuadBatch boundsOfQuadAtIndex:i] isEqualToRectangle:
+                       [quadBatch boundsOfQuadAtIndex:i]], @"wrong position of quad %d", (int)i);
+}
+
+- (void)testIncrementalLayout
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    NSString *text = @"THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG";
+
+    // changes in the middle of a multi-line text; the first word of a line might move up
+    [self compareIncrementalLayoutOfFont:font fromText:text
+                                  toText:@"THE QUICK RED FOX JUMPS OVER THE LAZY DOG"];
+    [self compareIncrementalLayoutOfFont:font fromText:text
+                                  toText:@"THE QUICK BROWN FOX IS JUMPING OVER THE LAZY DOG"];
+
+    // text that becomes shorter removes quads from the batch
+    [self compareIncrementalLayoutOfFont:font fromText:text toText:@"THE QUICK BROWN FOX"];
+    [self compareIncrementalLayoutOfFont:font fromText:text toText:@"THE"];
+
+    // text that grows moves the existing lines if it's not top-aligned
+    [self compareIncrementalLayoutOfFont:font fromText:text
+                                  toText:[text stringByAppendingString:@" AND THE CAT"]];
+}
+
+- (void)testAutoScale
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    NSString *text = @"THE QUICK BROWN FOX\nJUMPS OVER THE LAZY DOG";
+    float widths[]  = { 30, 45, 60, 100, 150, 400 };
+    float heights[] = { 12, 20, 30, 60, 120 };
+
+    SPQuadBatch *fullQuadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:fullQuadBatch withWidth:1000 height:1000 text:text fontSize:8
+                  color:SPColorWhite hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    NSInteger numQuads = fullQuadBatch.numQuads;
+
+    for (int w=0; w<6; ++w)
+    {
+        for (int h=0; h<5; ++h)
+        {
+            // the bisection must find the same size as a linear search
+            SPQuadBatch *expectedQuadBatch = [SPQuadBatch quadBatch];
+            for (float size=32; size > 0; size -= 1)
+            {
+                [expectedQuadBatch reset];
+                [font fillQuadBatch:expectedQuadBatch withWidth:widths[w] height:heights[h] text:text
+                           fontSize:size color:SPColorWhite hAlign:SPHAlignCenter vAlign:SPVAlignCenter
+                          autoScale:NO kerning:YES leading:0];
+
+                if (expectedQuadBatch.numQuads == numQuads) break;
+            }
+
+            SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+            [font fillQuadBatch:quadBatch withWidth:widths[w] height:heights[h] text:text fontSize:32
+                          color:SPColorWhite hAlign:SPHAlignCenter vAlign:SPVAlignCenter
+                      autoScale:YES kerning:YES leading:0];
+
+            XCTAssertEqual(numQuads, quadBatch.numQuads, @"text cut off in %.0fx%.0f", widths[w], heights[h]);
+            XCTAssertTrue([[expectedQuadBatch boundsOfQuadAtIndex:0] isEqualToRectangle:
+                           [quadBatch boundsOfQuadAtIndex:0]], @"wrong size in %.0fx%.0f", widths[w], heights[h]);
+            XCTAssertTrue([[expectedQuadBatch boundsOfQuadAtIndex:numQuads - 1] isEqualToRectangle:
+                           [quadBatch boundsOfQuadAtIndex:numQuads - 1]], @"wrong size in %.0fx%.0f",
+                          widths[w], heights[h]);
+        }
+    }
+
+    // if not even the smallest size fits, it is used anyway
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:quadBatch withWidth:2 height:3 text:text fontSize:32 color:SPColorWhite
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:YES kerning:YES leading:0];
+
+    XCTAssertGreaterThan(quadBatch.numQuads, 0, @"text not displayed");
+    XCTAssertLessThan(quadBatch.numQuads, numQuads, @"text not cut off");
+    XCTAssertEqualWithAccuracy(5.0f / 8.0f, [quadBatch boundsOfQuadAtIndex:0].height, E, @"wrong size");
+}
+
+- (void)testMultiplePages
+{
+    NSString *xml =
+        @"<font><info face='Test' size='10'/><common lineHeight='10' base='8'/>"
+        @"<pages><page id='0' file='a.png'/><page id='1' file='b.png'/></pages><chars>"
+        @"<char id='65' x='0' y='0' width='8' height='10' xoffset='0' yoffset='0' xadvance='8' page='0'/>"
+        @"<char id='66' x='0' y='0' width='8' height='10' xoffset='0' yoffset='0' xadvance='8' page='1'/>"
+        @"</chars></font>";
+
+    NSArray *textures = @[[[SPTexture alloc] initWithWidth:16 height:16],
+                          [[SPTexture alloc] initWithWidth:16 height:16]];
+
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithContentsOfData:[xml dataUsingEncoding:NSUTF8StringEncoding]
+                                                             textures:textures];
+    XCTAssertEqual(2, (int)font.textures.count, @"wrong number of pages");
+    XCTAssertEqual([textures[1] name], [font charByID:'B'].texture.name, @"wrong page");
+
+    // however often the text switches pages, there is one batch per page
+    NSMutableArray *quadBatches = [NSMutableArray array];
+    NSInteger numBatches = [font fillQuadBatches:quadBatches withWidth:100 height:20 text:@"ABAB"
+                                        fontSize:10 color:SPColorWhite hAlign:SPHAlignLeft
+                                          vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqual(2, (int)numBatches, @"wrong number of batches");
+    XCTAssertEqual(2, (int)[quadBatches[0] numQuads], @"wrong number of quads");
+    XCTAssertEqual(2, (int)[quadBatches[1] numQuads], @"wrong number of quads");
+    XCTAssertEqual([textures[1] name], [quadBatches[1] texture].name, @"wrong texture");
+
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    XCTAssertThrows([font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AB" fontSize:10
+                                  color:SPColorWhite hAlign:SPHAlignLeft vAlign:SPVAlignTop
+                              autoScale:NO kerning:YES leading:0], @"pages must not be mixed");
+}
+
+- (void)testDistanceField
+{
+    NSString *xml =
+        @"<font><info face='Test' size='10'/><common lineHeight='10' base='8'/>"
+        @"<distanceField fieldType='msdf' distanceRange='4'/><chars>"
+        @"<char id='65' x='0' y='0' width='8' height='10' xoffset='0' yoffset='0' xadvance='8' page='0'/>"
+        @"</chars></font>";
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:16 height:16];
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithContentsOfData:[xml dataUsingEncoding:NSUTF8StringEncoding]
+                                                              texture:texture];
+    XCTAssertNotNil(font.distanceFieldStyle, @"distance field not recognized");
+    XCTAssertTrue(font.distanceFieldStyle.multiChannel, @"wrong field type");
+
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AA" fontSize:10 color:SPColorWhite
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    XCTAssertTrue([font.distanceFieldStyle isEqualToStyle:quadBatch.distanceFieldStyle], @"style not applied");
+    XCTAssertNotEqual(font.distanceFieldStyle, quadBatch.distanceFieldStyle, @"style not copied");
+
+    SPSprite *sprite = [font createSpriteWithWidth:100 height:20 text:@"AA" fontSize:10 color:SPColorWhite
+                                            hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO
+                                           kerning:YES leading:0];
+    XCTAssertEqual(1, sprite.numChildren, @"chars not batched");
+    XCTAssertEqual(2, [(SPQuadBatch *)[sprite childAtIndex:0] numQuads], @"wrong number of quads");
+    XCTAssertTrue([font.distanceFieldStyle isEqualToStyle:[(SPQuadBatch *)[sprite childAtIndex:0] distanceFieldStyle]],
+                  @"style not applied to sprite");
+
+    // batches with equal styles can be combined, others can't
+    SPDistanceFieldStyle *outlined = [font.distanceFieldStyle copy];
+    XCTAssertFalse([quadBatch isStateChangeWithTinted:NO texture:texture alpha:1.0f premultipliedAlpha:texture.premultipliedAlpha
+                                            blendMode:quadBatch.blendMode distanceFieldStyle:outlined numQuads:1]);
+
+    outlined.outlineWidth = 0.2f;
+    XCTAssertTrue([quadBatch isStateChangeWithTinted:NO texture:texture alpha:1.0f premultipliedAlpha:texture.premultipliedAlpha
+                                           blendMode:quadBatch.blendMode distanceFieldStyle:outlined numQuads:1]);
+    XCTAssertTrue([quadBatch isStateChangeWithTinted:NO texture:texture alpha:1.0f premultipliedAlpha:texture.premultipliedAlpha
+                                           blendMode:quadBatch.blendMode numQuads:1]);
+}
+
+@end
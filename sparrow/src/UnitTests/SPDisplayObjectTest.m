@@ -366,4 +366,27 @@
     XCTAssertEqualObjects(@"hugo", sprite.name, @"wrong name");
 }
 
-@end
\ No newline at end of file
+- (void)testChangeVersion
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:50];
+    [sprite addChild:quad];
+    
+    NSUInteger spriteVersion = sprite.changeVersion;
+    NSUInteger quadVersion = quad.changeVersion;
+    
+    quad.x = 10.0f;
+    XCTAssertEqual(quadVersion, quad.changeVersion, @"own transformation changed version");
+    XCTAssertNotEqual(spriteVersion, sprite.changeVersion, @"child transformation not detected");
+    
+    spriteVersion = sprite.changeVersion;
+    quad.color = 0xff0000;
+    XCTAssertNotEqual(quadVersion, quad.changeVersion, @"color change not detected");
+    XCTAssertEqual(quad.changeVersion, sprite.changeVersion, @"version not propagated to parent");
+    
+    spriteVersion = sprite.changeVersion;
+    [quad removeFromParent];
+    XCTAssertNotEqual(spriteVersion, sprite.changeVersion, @"removal not detected");
+}
+
+@end
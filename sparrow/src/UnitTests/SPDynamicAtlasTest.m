@@ -0,0 +1,129 @@
+//
+//  SPDynamicAtlasTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPDynamicAtlasTest : SPTestCase
+
+@end
+
+@implementation SPDynamicAtlasTest
+
+- (SPTexture *)textureWithWidth:(float)width height:(float)height
+{
+    return [[SPTexture alloc] initWithWidth:width height:height draw:NULL];
+}
+
+- (void)testAddTexture
+{
+    SPDynamicAtlas *atlas = [SPDynamicAtlas atlasWithPageWidth:128 height:128];
+    SPSubTexture *a = [atlas addTexture:[self textureWithWidth:60 height:40] name:@"a"];
+    SPSubTexture *b = [atlas addTexture:[self textureWithWidth:30 height:50] name:@"b"];
+
+    XCTAssertEqual(2, atlas.numTextures, @"wrong number of textures");
+    XCTAssertEqual(1, atlas.numPages, @"wrong number of pages");
+    XCTAssertEqual(a, [atlas textureByName:@"a"], @"wrong texture");
+    XCTAssertEqualWithAccuracy(60.0f, a.width,  E, @"wrong width");
+    XCTAssertEqualWithAccuracy(50.0f, b.height, E, @"wrong height");
+    XCTAssertEqual(a.parent, b.parent, @"textures not on the same page");
+    XCTAssertFalse([a.region intersectsRectangle:b.region], @"textures overlap");
+    XCTAssertEqualObjects((@[@"a", @"b"]), atlas.names, @"wrong names");
+
+    // a texture that doesn't fit onto the first page gets a new one
+    [atlas addTexture:[self textureWithWidth:100 height:100] name:@"c"];
+    XCTAssertEqual(2, atlas.numPages, @"no page added");
+
+    XCTAssertThrows([atlas addTexture:[self textureWithWidth:129 height:10] name:@"d"],
+                    @"texture bigger than a page accepted");
+}
+
+- (void)testReplaceTexture
+{
+    SPDynamicAtlas *atlas = [SPDynamicAtlas atlasWithPageWidth:128 height:128];
+    SPSubTexture *a = [atlas addTexture:[self textureWithWidth:100 height:100] name:@"a"];
+
+    // the area of the previous texture is reused
+    SPSubTexture *newA = [atlas addTexture:[self textureWithWidth:100 height:100] name:@"a"];
+    XCTAssertEqual(1, atlas.numPages, @"area of replaced texture not freed");
+    XCTAssertEqual(1, atlas.numTextures, @"wrong number of textures");
+    XCTAssertNotEqual(a, newA, @"texture not replaced");
+
+    // adding the stored texture again changes nothing
+    XCTAssertEqual(newA, [atlas addTexture:newA name:@"a"], @"texture replaced by itself");
+    XCTAssertEqual(1, atlas.numPages, @"wrong number of pages");
+
+    // a texture that is copied from the area it replaces needs a new one
+    SPDynamicAtlas *wideAtlas = [SPDynamicAtlas atlasWithPageWidth:256 height:128];
+    SPSubTexture *b = [wideAtlas addTexture:[self textureWithWidth:100 height:100] name:@"b"];
+    SPSubTexture *part = [SPSubTexture textureWithRegion:[SPRectangle rectangleWithX:0 y:0 width:50 height:50]
+                                               ofTexture:b];
+    SPSubTexture *newB = [wideAtlas addTexture:part name:@"b"];
+
+    XCTAssertFalse([b.region intersectsRectangle:newB.region], @"source area overwritten");
+    XCTAssertEqual(1, wideAtlas.numTextures, @"wrong number of textures");
+    XCTAssertEqual(1, wideAtlas.numPages, @"wrong number of pages");
+}
+
+- (void)testRemoveTexture
+{
+    SPDynamicAtlas *atlas = [SPDynamicAtlas atlasWithPageWidth:128 height:128];
+    [atlas addTexture:[self textureWithWidth:100 height:100] name:@"a"];
+    [atlas removeTextureByName:@"a"];
+
+    XCTAssertNil([atlas textureByName:@"a"], @"texture not removed");
+    XCTAssertEqual(0, atlas.numTextures, @"wrong number of textures");
+    XCTAssertEqualWithAccuracy(0.0f, atlas.occupancy, E, @"area not freed");
+
+    [atlas addTexture:[self textureWithWidth:100 height:100] name:@"b"];
+    XCTAssertEqual(1, atlas.numPages, @"area not reused");
+
+    [atlas removeAllTextures];
+    XCTAssertEqual(0, atlas.numPages, @"pages not removed");
+    XCTAssertEqual(0, atlas.numTextures, @"textures not removed");
+}
+
+- (void)testDefragment
+{
+    SPDynamicAtlas *atlas = [SPDynamicAtlas atlasWithPageWidth:128 height:128];
+    SPSubTexture *big    = [atlas addTexture:[self textureWithWidth:100 height:100] name:@"big"];
+    SPSubTexture *small1 = [atlas addTexture:[self textureWithWidth:60 height:60] name:@"small1"];
+    SPSubTexture *small2 = [atlas addTexture:[self textureWithWidth:60 height:60] name:@"small2"];
+    SPSubTexture *single = [atlas addTexture:[self textureWithWidth:90 height:90] name:@"single"];
+
+    XCTAssertEqual(3, atlas.numPages, @"wrong number of pages");
+    XCTAssertEqual(small1.parent, small2.parent, @"small textures not on the same page");
+
+    [atlas removeTextureByName:@"small1"];
+    [atlas defragment];
+
+    // the page of the big texture didn't change, so it's kept
+    XCTAssertEqual(3, atlas.numTextures, @"wrong number of textures");
+    XCTAssertEqual(big, [atlas textureByName:@"big"], @"unchanged page redrawn");
+
+    // the other textures moved
+    SPSubTexture *newSmall2 = [atlas textureByName:@"small2"];
+    SPSubTexture *newSingle = [atlas textureByName:@"single"];
+    XCTAssertNotEqual(small2, newSmall2, @"moved texture not redrawn");
+    XCTAssertNotEqual(single.parent, newSingle.parent, @"moved texture not redrawn");
+    XCTAssertEqualWithAccuracy(60.0f, newSmall2.width, E, @"wrong width");
+
+    for (NSString *name in atlas.names)
+        for (NSString *otherName in atlas.names)
+        {
+            SPSubTexture *texture = [atlas textureByName:name];
+            SPSubTexture *other = [atlas textureByName:otherName];
+
+            if (texture != other && texture.parent == other.parent)
+                XCTAssertFalse([texture.region intersectsRectangle:other.region], @"textures overlap");
+        }
+}
+
+@end
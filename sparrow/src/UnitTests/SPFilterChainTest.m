@@ -0,0 +1,142 @@
+//
+//  SPFilterChainTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPFilterChain (Private)
+
+- (void)updateStages;
+- (void)resetStages;
+
+@end
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPFilterChainTest : SPTestCase
+
+@end
+
+@implementation SPFilterChainTest
+
+- (void)applyColorMatrix:(SPColorMatrix *)colorMatrix toColor:(float *)color
+{
+    float *m = colorMatrix.values;
+    float result[4];
+
+    for (int i=0; i<4; ++i)
+        result[i] = m[i*5] * color[0] + m[i*5+1] * color[1] + m[i*5+2] * color[2] +
+                    m[i*5+3] * color[3] + m[i*5+4];
+
+    memcpy(color, result, sizeof(result));
+}
+
+- (void)testColorMatrixFusion
+{
+    SPColorMatrixFilter *saturation = [SPColorMatrixFilter colorMatrixFilter];
+    SPColorMatrixFilter *brightness = [SPColorMatrixFilter colorMatrixFilter];
+    SPBlurFilter *blur = [SPBlurFilter blurFilterWithBlur:2.0f];
+    [saturation adjustSaturation:-0.5f];
+    [brightness adjustBrightness:0.2f];
+
+    SPFilterChain *chain = [SPFilterChain filterChainWithFilters:@[blur, saturation, brightness]];
+    [chain updateStages];
+
+    // the matrices are applied by the final pass of the blur filter
+    XCTAssertEqual(blur.numPasses, chain.numPasses, @"color matrices got passes of their own");
+    XCTAssertNotNil(blur.outputColorMatrix, @"color matrices not merged into blur filter");
+
+    // the fused matrix must have the same effect as applying the filters one after the other
+    float fused[4]      = { 200.0f, 100.0f, 50.0f, 255.0f };
+    float sequential[4] = { 200.0f, 100.0f, 50.0f, 255.0f };
+
+    [self applyColorMatrix:blur.outputColorMatrix toColor:fused];
+    [self applyColorMatrix:saturation.colorMatrix toColor:sequential];
+    [self applyColorMatrix:brightness.colorMatrix toColor:sequential];
+
+    for (int i=0; i<4; ++i)
+        XCTAssertEqualWithAccuracy(sequential[i], fused[i], 0.01f, @"wrong fused matrix");
+
+    [chain resetStages];
+    XCTAssertNil(blur.outputColorMatrix, @"merged matrix left behind");
+
+    // without a preceding filter, the matrices share a single pass
+    SPFilterChain *matrixChain = [SPFilterChain filterChainWithFilters:@[saturation, brightness]];
+    [matrixChain updateStages];
+    XCTAssertEqual(1, matrixChain.numPasses, @"color matrices not fused");
+}
+
+- (void)testPassesAndMargins
+{
+    SPBlurFilter *blur1 = [SPBlurFilter blurFilterWithBlur:1.0f];
+    SPBlurFilter *blur2 = [SPBlurFilter blurFilterWithBlur:3.0f];
+    SPColorMatrixFilter *colorMatrix = [SPColorMatrixFilter colorMatrixFilter];
+
+    SPFilterChain *chain = [SPFilterChain filterChainWithFilters:@[blur1, blur2, colorMatrix]];
+    [chain updateStages];
+
+    XCTAssertEqual(blur1.numPasses + blur2.numPasses, chain.numPasses, @"wrong number of passes");
+    XCTAssertEqualWithAccuracy(blur1.marginX + blur2.marginX, chain.marginX, E, @"wrong marginX");
+    XCTAssertEqualWithAccuracy(blur1.marginY + blur2.marginY, chain.marginY, E, @"wrong marginY");
+
+    // each pass is forwarded to the right filter
+    for (NSInteger pass=0; pass<chain.numPasses; ++pass)
+    {
+        SPBlurFilter *expectedFilter = pass < blur1.numPasses ? blur1 : blur2;
+        NSInteger filterPass = pass < blur1.numPasses ? pass : pass - blur1.numPasses;
+        XCTAssertEqualWithAccuracy([expectedFilter resolutionForPass:filterPass],
+                                   [chain resolutionForPass:pass], E, @"wrong pass %d", (int)pass);
+    }
+
+    [chain resetStages];
+}
+
+- (void)testChangeVersion
+{
+    SPColorMatrixFilter *colorMatrix = [SPColorMatrixFilter colorMatrixFilter];
+    SPBlurFilter *blur = [SPBlurFilter blurFilter];
+    SPFilterChain *chain = [SPFilterChain filterChainWithFilters:@[colorMatrix]];
+    NSUInteger changeVersion = chain.changeVersion;
+
+    [colorMatrix adjustHue:0.5f];
+    XCTAssertNotEqual(changeVersion, chain.changeVersion, @"change of filter not detected");
+    changeVersion = chain.changeVersion;
+
+    [chain addFilter:blur];
+    XCTAssertGreaterThan(chain.changeVersion, changeVersion, @"new filter not detected");
+    changeVersion = chain.changeVersion;
+
+    [chain removeFilter:colorMatrix];
+    XCTAssertGreaterThan(chain.changeVersion, changeVersion, @"removed filter not detected");
+    changeVersion = chain.changeVersion;
+
+    [colorMatrix adjustHue:0.5f];
+    XCTAssertEqual(changeVersion, chain.changeVersion, @"removed filter still observed");
+
+    [chain removeAllFilters];
+    XCTAssertGreaterThan(chain.changeVersion, changeVersion, @"removed filters not detected");
+}
+
+- (void)testInvalidFilters
+{
+    SPColorMatrixFilter *colorMatrix = [SPColorMatrixFilter colorMatrixFilter];
+    SPFilterChain *chain = [SPFilterChain filterChain];
+    [chain addFilter:colorMatrix];
+
+    XCTAssertThrows([chain addFilter:colorMatrix], @"filter added twice");
+    XCTAssertThrows([chain addFilter:chain], @"chain added to itself");
+    XCTAssertThrows([SPFilterChain filterChainWithFilters:@[colorMatrix, colorMatrix]],
+                    @"filter added twice");
+    XCTAssertEqual(1, chain.numFilters, @"wrong number of filters");
+}
+
+@end
@@ -0,0 +1,158 @@
+//
+//  SPFragmentFilterTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPFragmentFilter (Private)
+
+- (BOOL)isAutoCacheValidWithObject:(SPDisplayObject *)object support:(SPRenderSupport *)support;
+
+@end
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPFragmentFilterTest : SPTestCase
+
+@end
+
+@implementation SPFragmentFilterTest
+{
+    SPRenderSupport *_support;
+}
+
+- (void)setUp
+{
+    _support = [[SPRenderSupport alloc] init];
+}
+
+- (BOOL)isCacheValidWithObject:(SPDisplayObject *)object
+{
+    return [object.filter isAutoCacheValidWithObject:object support:_support];
+}
+
+- (void)testAutoCacheHit
+{
+    SPSprite *sprite = [SPSprite sprite];
+    [sprite addChild:[SPQuad quadWithWidth:100 height:50]];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"cache valid before first render");
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"unchanged object not cached");
+
+    sprite.x = 20.0f;
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"translation invalidated cache");
+}
+
+- (void)testAutoCacheMissAfterChildChange
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPSprite *child = [SPSprite sprite];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:50];
+    [sprite addChild:child];
+    [child addChild:quad];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    [self isCacheValidWithObject:sprite];
+
+    quad.color = 0xff0000;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"color change of grandchild not detected");
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"cache not restored");
+
+    quad.x = 10.0f;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"movement of grandchild not detected");
+
+    [child addChild:[SPQuad quadWithWidth:10 height:10]];
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"new child not detected");
+}
+
+- (void)testAutoCacheMissAfterMaskChange
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPQuad *mask = [SPQuad quadWithWidth:50 height:50];
+    [sprite addChild:[SPQuad quadWithWidth:100 height:50]];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    [self isCacheValidWithObject:sprite];
+
+    sprite.mask = mask;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"new mask not detected");
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"cache not restored");
+
+    mask.x = 10.0f;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"movement of mask not detected");
+
+    mask.scaleX = 2.0f;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"scaling of mask not detected");
+
+    sprite.mask = nil;
+    [self isCacheValidWithObject:sprite];
+
+    mask.x = 20.0f;
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"removed mask still observed");
+}
+
+- (void)testAutoCacheMissAfterAlphaChange
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:50];
+    [sprite addChild:quad];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    [self isCacheValidWithObject:sprite];
+
+    quad.alpha = 0.5f;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"alpha change of child not detected");
+
+    _support.alpha = 0.5f;
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"translucent object cached");
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"translucent object cached");
+}
+
+- (void)testAutoCacheMissAfterRenderTextureChange
+{
+    SPRenderTexture *renderTexture = [[SPRenderTexture alloc] initWithWidth:32 height:32];
+    SPImage *image = [SPImage imageWithTexture:renderTexture];
+    SPSprite *sprite = [SPSprite sprite];
+    [sprite addChild:image];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    [self isCacheValidWithObject:sprite];
+
+    [renderTexture drawObject:[SPQuad quadWithWidth:10 height:10]];
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"drawing into render texture not detected");
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"cache not restored");
+
+    image.texture = [[SPTexture alloc] initWithWidth:32 height:32 draw:NULL];
+    [self isCacheValidWithObject:sprite];
+
+    [renderTexture clear];
+    XCTAssertTrue([self isCacheValidWithObject:sprite], @"replaced texture still observed");
+}
+
+- (void)testAutoCacheBypassedIn3D
+{
+    SPSprite3D *sprite = [SPSprite3D sprite3D];
+    [sprite addChild:[SPQuad quadWithWidth:100 height:50]];
+    sprite.filter = [SPColorMatrixFilter colorMatrixFilter];
+    sprite.filter.autoCache = YES;
+
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"3D object cached");
+    XCTAssertFalse([self isCacheValidWithObject:sprite], @"3D object cached");
+}
+
+@end
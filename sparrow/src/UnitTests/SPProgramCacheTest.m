@@ -0,0 +1,88 @@
+//
+//  SPProgramCacheTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPProgramCache (Private)
+
+- (NSString *)binaryPathForVertexShader:(NSString *)vertexShader fragmentShader:(NSString *)fragmentShader;
+
+@end
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPProgramCacheTest : SPTestCase
+
+@end
+
+@implementation SPProgramCacheTest
+{
+    SPProgramCache *_cache;
+    NSString *_vertexShader;
+    NSString *_fragmentShader;
+}
+
+- (void)setUp
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"SPProgramCacheTest"];
+    _cache = [[SPProgramCache alloc] initWithPath:path];
+    _vertexShader = [SPFragmentFilter standardVertexShader];
+    _fragmentShader = [SPFragmentFilter standardFragmentShader];
+}
+
+- (void)tearDown
+{
+    [_cache purge];
+}
+
+- (void)testFallbackWithoutBinaryFormats
+{
+    // the usual case on iOS: the driver reports no binary formats
+    if (_cache.isSupported) return;
+
+    [_cache prepareProgramForStorage:0];
+    [_cache storeProgram:0 vertexShader:_vertexShader fragmentShader:_fragmentShader];
+
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:_cache.path], @"binary stored");
+    XCTAssertEqual(0, [_cache createProgramWithVertexShader:_vertexShader fragmentShader:_fragmentShader],
+                   @"program created without binary support");
+}
+
+- (void)testInvalidBinary
+{
+    NSString *binaryPath = [_cache binaryPathForVertexShader:_vertexShader fragmentShader:_fragmentShader];
+
+    [[NSFileManager defaultManager] createDirectoryAtPath:_cache.path withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+    [[@"not a program binary" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:binaryPath atomically:YES];
+
+    // the program is then compiled from source, and the binary is replaced later
+    XCTAssertEqual(0, [_cache createProgramWithVertexShader:_vertexShader fragmentShader:_fragmentShader],
+                   @"program created from invalid binary");
+
+    if (_cache.isSupported)
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:binaryPath], @"binary not discarded");
+}
+
+- (void)testBinaryPath
+{
+    NSString *path = [_cache binaryPathForVertexShader:_vertexShader fragmentShader:_fragmentShader];
+    NSString *otherPath = [_cache binaryPathForVertexShader:_vertexShader fragmentShader:@"void main() {}"];
+
+    XCTAssertEqualObjects(_cache.path, path.stringByDeletingLastPathComponent, @"wrong directory");
+    XCTAssertEqualObjects(path, [_cache binaryPathForVertexShader:_vertexShader fragmentShader:_fragmentShader],
+                          @"path not stable");
+    XCTAssertNotEqualObjects(path, otherPath, @"sources not part of the key");
+}
+
+@end
@@ -0,0 +1,80 @@
+//
+//  SPRectanglePackerTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPRectanglePackerTest : SPTestCase
+
+@end
+
+@implementation SPRectanglePackerTest
+
+- (void)testAllocate
+{
+    SPRectanglePacker *packer = [SPRectanglePacker packerWithWidth:64 height:64];
+    NSMutableArray *rectangles = [NSMutableArray array];
+
+    for (int i=0; i<16; ++i)
+    {
+        SPRectangle *rect = [packer allocateRectangleWithWidth:16 height:16];
+        XCTAssertNotNil(rect, @"rectangle %d did not fit", i);
+        XCTAssertTrue(rect.x >= 0 && rect.right  <= 64, @"rectangle out of bounds");
+        XCTAssertTrue(rect.y >= 0 && rect.bottom <= 64, @"rectangle out of bounds");
+
+        for (SPRectangle *other in rectangles)
+            XCTAssertFalse([rect intersectsRectangle:other], @"rectangles overlap");
+
+        [rectangles addObject:rect];
+    }
+
+    XCTAssertEqualWithAccuracy(1.0f, packer.occupancy, E, @"wrong occupancy");
+    XCTAssertNil([packer allocateRectangleWithWidth:1 height:1], @"full packer accepted rectangle");
+}
+
+- (void)testTooLarge
+{
+    SPRectanglePacker *packer = [SPRectanglePacker packerWithWidth:64 height:32];
+    XCTAssertNil([packer allocateRectangleWithWidth:65 height:10], @"rectangle too wide");
+    XCTAssertNil([packer allocateRectangleWithWidth:10 height:33], @"rectangle too high");
+    XCTAssertNotNil([packer allocateRectangleWithWidth:64 height:32], @"rectangle should fit");
+}
+
+- (void)testFree
+{
+    SPRectanglePacker *packer = [SPRectanglePacker packerWithWidth:64 height:64];
+    SPRectangle *topLeft = [packer allocateRectangleWithWidth:32 height:32];
+    SPRectangle *topRight = [packer allocateRectangleWithWidth:32 height:32];
+    [packer allocateRectangleWithWidth:64 height:32];
+
+    XCTAssertNil([packer allocateRectangleWithWidth:64 height:32], @"full packer accepted rectangle");
+
+    [packer freeRectangle:topLeft];
+    [packer freeRectangle:topRight];
+
+    XCTAssertEqualWithAccuracy(0.5f, packer.occupancy, E, @"wrong occupancy");
+    XCTAssertEqual(1, packer.numFreeRectangles, @"free rectangles were not merged");
+
+    SPRectangle *rect = [packer allocateRectangleWithWidth:64 height:32];
+    XCTAssertNotNil(rect, @"freed area was not reused");
+    XCTAssertEqualWithAccuracy(0.0f, rect.y, E, @"wrong position");
+}
+
+- (void)testReset
+{
+    SPRectanglePacker *packer = [SPRectanglePacker packerWithWidth:32 height:32];
+    [packer allocateRectangleWithWidth:32 height:32];
+    [packer reset];
+
+    XCTAssertEqualWithAccuracy(0.0f, packer.occupancy, E, @"wrong occupancy");
+    XCTAssertNotNil([packer allocateRectangleWithWidth:32 height:32], @"reset packer is not empty");
+}
+
+@end
@@ -0,0 +1,149 @@
+//
+//  SPSystemFontTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPSystemFontTest : SPTestCase
+
+@end
+
+@implementation SPSystemFontTest
+
+- (void)setUp
+{
+    [SPSystemFont purgeGlyphCache];
+}
+
+- (SPRectangle *)regionOfChar:(int)charID inFont:(SPBitmapFont *)font
+{
+    return [(SPSubTexture *)[font charByID:charID].texture region];
+}
+
+- (void)testCharsOnDemand
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+
+    XCTAssertNil([font charByID:'a'], @"char created too early");
+    XCTAssertTrue([font hasCharsInString:@"ab c"], @"chars not created on demand");
+
+    SPBitmapChar *charA = [font charByID:'a'];
+    SPBitmapChar *charB = [font charByID:'b'];
+
+    XCTAssertNotNil(charA, @"char missing");
+    XCTAssertNotNil(charB, @"char missing");
+    XCTAssertNotNil([font charByID:' '], @"white space missing");
+    XCTAssertEqual(0.0f, [font charByID:' '].width, @"white space should have no glyph");
+    XCTAssertGreaterThan(charA.xAdvance, 0.0f, @"wrong advance");
+    XCTAssertEqual(charA.texture.root, charB.texture.root, @"chars not in the same cache");
+
+    // chars that are known already stay the same
+    [font prepareCharsInString:@"abc"];
+    XCTAssertEqual(charA, [font charByID:'a'], @"char was created again");
+}
+
+- (void)testGlyphsDoNotOverlap
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+    NSString *text = @"ABCDEFGHIJ";
+
+    [font prepareCharsInString:text];
+
+    for (NSInteger i=0; i<text.length; ++i)
+    {
+        SPRectangle *region = [self regionOfChar:[text characterAtIndex:i] inFont:font];
+
+        for (NSInteger j=i+1; j<text.length; ++j)
+        {
+            SPRectangle *otherRegion = [self regionOfChar:[text characterAtIndex:j] inFont:font];
+            XCTAssertFalse([region intersectsRectangle:otherRegion], @"glyphs overlap");
+        }
+    }
+}
+
+- (void)testSurrogatePairs
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+    NSString *text = @"a\U0001F600b";
+
+    [font prepareCharsInString:text];
+
+    XCTAssertNotNil([font charByID:0x1F600], @"char outside of the BMP missing");
+    XCTAssertNil([font charByID:0xD83D], @"half of a surrogate pair added as char");
+    XCTAssertEqual(3, font.allCharIDs.count, @"wrong number of chars");
+
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:quadBatch withWidth:200 height:50 text:text fontSize:20 color:0xffffff
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqual(3, quadBatch.numQuads, @"wrong number of quads");
+}
+
+- (void)testComposedCharacterSequences
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+    NSString *thumbsUp = @"\U0001F44D\U0001F3FD"; // with skin tone modifier
+    NSString *accent   = @"e\u0301";               // with combining acute accent
+
+    [font prepareCharsInString:[thumbsUp stringByAppendingString:accent]];
+    XCTAssertEqual(2, font.allCharIDs.count, @"sequences not combined");
+
+    // the same sequence gets the same ID
+    [font prepareCharsInString:[accent stringByAppendingString:thumbsUp]];
+    XCTAssertEqual(2, font.allCharIDs.count, @"sequence added twice");
+
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:quadBatch withWidth:200 height:50 text:thumbsUp fontSize:20 color:0xffffff
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqual(1, quadBatch.numQuads, @"wrong number of quads");
+}
+
+- (void)testLineBreakAfterSurrogatePairs
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+    NSString *word = @"\U0001F600\U0001F600\U0001F600";
+    NSString *text = [NSString stringWithFormat:@"%@ %@ %@", word, word, word];
+
+    [font prepareCharsInString:text];
+
+    // only one word fits into a line; the locations must not be confused by the surrogate pairs
+    float wordWidth = 3 * [font charByID:0x1F600].xAdvance;
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+    [font fillQuadBatch:quadBatch withWidth:wordWidth * 1.5f height:500 text:text fontSize:20
+                  color:0xffffff hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:NO
+                leading:0];
+
+    XCTAssertEqual(9, quadBatch.numQuads, @"wrong number of quads");
+
+    SPRectangle *firstQuad  = [quadBatch boundsOfQuadAtIndex:0];
+    SPRectangle *fourthQuad = [quadBatch boundsOfQuadAtIndex:3];
+    XCTAssertEqualWithAccuracy(firstQuad.x, fourthQuad.x, E, @"second word not on a new line");
+    XCTAssertGreaterThan(fourthQuad.y, firstQuad.y, @"second word not on a new line");
+}
+
+- (void)testPurgeGlyphCache
+{
+    SPSystemFont *font = [SPSystemFont fontWithName:@"Helvetica" size:20];
+    [font prepareCharsInString:@"a"];
+    SPTexture *oldCache = [font charByID:'a'].texture.root;
+
+    [SPSystemFont purgeGlyphCache];
+    [font prepareCharsInString:@"b"];
+
+    XCTAssertNotEqual(oldCache, [font charByID:'b'].texture.root, @"cache not replaced");
+    XCTAssertNil([font charByID:'a'], @"char of the old cache still referenced");
+
+    [font prepareCharsInString:@"a"];
+    XCTAssertEqual([font charByID:'a'].texture.root, [font charByID:'b'].texture.root,
+                   @"char not added to the new cache");
+}
+
+@end
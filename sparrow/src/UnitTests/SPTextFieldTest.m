@@ -0,0 +1,149 @@
+//
+//  SPTextFieldTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.10.26.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// -------------------------------------------------------------------------------------------------
+
+@interface Sparrow (Private)
+
++ (void)setCurrentController:(SPViewController *)controller;
+
+@end
+
+// -------------------------------------------------------------------------------------------------
+
+@interface SPTextFieldTest : SPTestCase
+
+@end
+
+@implementation SPTextFieldTest
+{
+    SPViewController *_previousController;
+}
+
+- (void)setUp
+{
+    // the controller is never deallocated, since that would reset the current context
+    static SPViewController *controller = nil;
+
+    _previousController = Sparrow.currentController;
+
+    if (!controller) controller = [[SPViewController alloc] init];
+    else [controller makeCurrent];
+}
+
+- (void)tearDown
+{
+    [Sparrow setCurrentController:_previousController];
+}
+
+- (SPTextField *)asynchronousTextFieldWithText:(NSString *)text
+{
+    SPTextField *textField = [SPTextField textFieldWithWidth:200 height:20 text:text
+                                                    fontName:SPBitmapFontMiniName
+                                                    fontSize:SPNativeFontSize color:SPColorWhite];
+    textField.asynchronous = YES;
+    return textField;
+}
+
+- (NSInteger)numQuadsOfTextField:(SPTextField *)textField
+{
+    NSInteger numQuads = 0;
+
+    for (NSInteger i=0; i<textField.numChildren; ++i)
+    {
+        SPDisplayObject *child = [textField childAtIndex:i];
+        if ([child isKindOfClass:[SPQuadBatch class]])
+            numQuads += [(SPQuadBatch *)child numQuads];
+    }
+
+    return numQuads;
+}
+
+- (void)waitForResourceQueue
+{
+    // the queue is serial, so this block runs after the ones the text fields enqueued; and the
+    // main queue then processes their results first, too.
+    XCTestExpectation *expectation = [self expectationWithDescription:@"resource queue"];
+
+    [Sparrow.currentController executeInResourceQueue:^
+     {
+         dispatch_async(dispatch_get_main_queue(), ^{ [expectation fulfill]; });
+     }];
+
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testAsynchronousRedraw
+{
+    SPTextField *textField = [self asynchronousTextFieldWithText:@"HELLO"];
+    [textField boundsInSpace:textField];
+
+    XCTAssertEqual(0, [self numQuadsOfTextField:textField], @"contents created synchronously");
+
+    [self waitForResourceQueue];
+    XCTAssertEqual(5, [self numQuadsOfTextField:textField], @"contents not adopted");
+}
+
+- (void)testSupersededRedraw
+{
+    SPTextField *textField = [self asynchronousTextFieldWithText:@"HELLO"];
+    [textField boundsInSpace:textField];
+
+    // a change while the contents are created is picked up by the next redraw
+    textField.text = @"HELLO WORLD";
+    [textField boundsInSpace:textField];
+
+    [self waitForResourceQueue];
+    XCTAssertEqual(5, [self numQuadsOfTextField:textField], @"wrong contents adopted");
+
+    [textField boundsInSpace:textField];
+    [self waitForResourceQueue];
+    XCTAssertEqual(10, [self numQuadsOfTextField:textField], @"change not picked up");
+}
+
+- (void)testCancelledRedraw
+{
+    SPTextField *textField = [self asynchronousTextFieldWithText:@"HELLO"];
+    [textField boundsInSpace:textField];
+
+    // text bounds need the contents right away, so they are created synchronously
+    textField.text = @"HI";
+    SPRectangle *textBounds = textField.textBounds;
+    SPDisplayObject *contents = [textField childAtIndex:0];
+
+    XCTAssertEqual(2, [self numQuadsOfTextField:textField], @"contents not created");
+
+    // the contents that were created in the meantime are outdated and must not be adopted
+    [self waitForResourceQueue];
+    XCTAssertEqual(contents, [textField childAtIndex:0], @"outdated contents adopted");
+    XCTAssertTrue([textBounds isEqualToRectangle:textField.textBounds], @"wrong text bounds");
+}
+
+- (void)testAutoSizeBounds
+{
+    SPTextField *textField = [self asynchronousTextFieldWithText:@"HELLO"];
+    textField.autoSize = SPTextFieldAutoSizeHorizontal;
+
+    SPTextField *expectedTextField = [self asynchronousTextFieldWithText:@"HELLO"];
+    expectedTextField.asynchronous = NO;
+    expectedTextField.autoSize = SPTextFieldAutoSizeHorizontal;
+
+    // the size of an auto-sized text field is never outdated
+    XCTAssertEqualWithAccuracy(expectedTextField.width, textField.width, E, @"wrong width");
+    XCTAssertEqual(5, [self numQuadsOfTextField:textField], @"contents not created");
+
+    textField.text = expectedTextField.text = @"HELLO WORLD";
+    XCTAssertEqualWithAccuracy(expectedTextField.width, textField.width, E, @"outdated width");
+}
+
+@end
@@ -57,4 +57,102 @@
     XCTAssertTrue([expectedNames isEqualToArray:names], @"wrong names array");
 }
 
+- (void)testCachedTextures
+{
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithTexture:texture];
+
+    [atlas addRegion:[SPRectangle rectangleWithX:0  y:0 width:10 height:10] withName:@"walk_10"];
+    [atlas addRegion:[SPRectangle rectangleWithX:10 y:0 width:10 height:10] withName:@"walk_9"];
+
+    SPTexture *walk9 = [atlas textureByName:@"walk_9"];
+    XCTAssertEqual(walk9, [atlas textureByName:@"walk_9"], @"subtexture was not cached");
+
+    NSArray *expectedNames = @[@"walk_9", @"walk_10"];
+    XCTAssertTrue([expectedNames isEqualToArray:[atlas namesStartingWith:@"walk"]], @"wrong names");
+    XCTAssertEqual(walk9, [atlas texturesStartingWith:@"walk"][0], @"subtexture was not cached");
+    XCTAssertEqual([atlas texturesStartingWith:@"walk"], [atlas texturesStartingWith:@"walk"],
+                   @"textures were not cached");
+
+    [atlas addRegion:[SPRectangle rectangleWithX:20 y:0 width:10 height:10] withName:@"walk_1"];
+    [atlas addRegion:[SPRectangle rectangleWithX:30 y:0 width:10 height:10] withName:@"walk_9"];
+    [atlas addRegion:[SPRectangle rectangleWithX:40 y:0 width:10 height:10] withName:@"walk"];
+
+    expectedNames = @[@"walk", @"walk_1", @"walk_9", @"walk_10"];
+    XCTAssertTrue([expectedNames isEqualToArray:[atlas namesStartingWith:@"walk"]], @"wrong names");
+    XCTAssertNotEqual(walk9, [atlas textureByName:@"walk_9"], @"replaced region kept its texture");
+    XCTAssertEqual(4, [atlas texturesStartingWith:@"walk"].count, @"outdated textures");
+}
+
+- (void)appendRegionWithName:(uint32_t)nameOffset length:(uint32_t)nameLength x:(float)x
+                      toData:(NSMutableData *)data
+{
+    uint32_t name[] = { nameOffset, nameLength };
+    float values[] = { x, 0, 10, 20, 0, 0, 0, 0 };
+    uint32_t rotated = 0;
+
+    [data appendBytes:name length:sizeof(name)];
+    [data appendBytes:values length:sizeof(values)];
+    [data appendBytes:&rotated length:sizeof(rotated)];
+}
+
+- (void)testBinaryFormat
+{
+    // header: magic, version, number of regions, image path (offset and length)
+    uint32_t header[] = { 1, 3, 0, 0 };
+    NSMutableData *data = [NSMutableData dataWithBytes:"SPTA" length:4];
+    [data appendBytes:header length:sizeof(header)];
+
+    // the regions are sorted by name; the string table follows them
+    [self appendRegionWithName:0 length:4 x:0  toData:data];
+    [self appendRegionWithName:4 length:6 x:10 toData:data];
+    [self appendRegionWithName:10 length:6 x:20 toData:data];
+    [data appendBytes:"idlewalk_1walk_2" length:16];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"atlas.atlas"];
+    [data writeToFile:path atomically:YES];
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithContentsOfFile:path texture:texture];
+
+    XCTAssertEqual(3, atlas.numTextures, @"wrong texture count");
+    XCTAssertEqualWithAccuracy(20.0f, [atlas regionByName:@"walk_2"].x, E, @"wrong region");
+    XCTAssertNil([atlas regionByName:@"walk"], @"found a missing region");
+    XCTAssertNil([atlas frameByName:@"idle"], @"wrong frame");
+
+    NSArray *expectedNames = @[@"walk_1", @"walk_2"];
+    XCTAssertTrue([expectedNames isEqualToArray:[atlas namesStartingWith:@"walk"]], @"wrong names");
+
+    [atlas removeRegion:@"idle"];
+    XCTAssertEqual(2, atlas.numTextures, @"wrong texture count");
+    XCTAssertEqualWithAccuracy(10.0f, [atlas regionByName:@"walk_1"].x, E, @"wrong region");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testBinaryFormatWithInvalidName
+{
+    uint32_t header[] = { 1, 2, 0, 0 };
+    NSMutableData *data = [NSMutableData dataWithBytes:"SPTA" length:4];
+    [data appendBytes:header length:sizeof(header)];
+
+    // the second name reaches beyond the end of the file
+    [self appendRegionWithName:0 length:4 x:0  toData:data];
+    [self appendRegionWithName:4 length:9 x:10 toData:data];
+    [data appendBytes:"idlewalk" length:8];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"invalid.atlas"];
+    [data writeToFile:path atomically:YES];
+
+    // the names are only checked when they are read
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithContentsOfFile:path texture:texture];
+
+    XCTAssertEqual(2, atlas.numTextures, @"wrong texture count");
+    XCTAssertThrows([atlas regionByName:@"walk"], @"invalid name accepted");
+    XCTAssertThrows([atlas namesStartingWith:@"walk"], @"invalid name accepted");
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
 @end
\ No newline at end of file
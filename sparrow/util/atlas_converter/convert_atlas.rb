@@ -0,0 +1,78 @@
+#!/usr/bin/env ruby
+
+#
+#  convert_atlas.rb
+#  Sparrow
+#
+#  Created by Daniel Sperl on 20.10.26.
+#  Copyright 2011-2015 Gamua. All rights reserved.
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the Simplified BSD License.
+#
+
+#  This script converts a texture atlas XML file to the binary atlas format of Sparrow, which
+#  loads much faster. See README for more information.
+
+require "rexml/document"
+
+MAGIC = "SPTA"
+VERSION = 1
+
+if $*.count == 0
+  puts "Usage: convert_atlas.rb input.xml [output.atlas]"
+  exit
+end
+
+# get commandline-arguments
+input_file_path = $*[0]
+output_file_path = $*.count >= 2 ? $*[1] : input_file_path.sub(/\.xml$/i, '') + '.atlas'
+
+if !File.exist?(input_file_path)
+  puts "File #{input_file_path} not found!"
+  exit
+end
+
+puts "Parsing #{input_file_path} ..."
+
+xml_doc = REXML::Document.new(File.read(input_file_path))
+atlas_element = xml_doc.root
+image_path = (atlas_element.attributes['imagePath'] || '').b
+
+regions = atlas_element.get_elements('SubTexture').collect do |element|
+  attributes = element.attributes
+  value = lambda { |name| (attributes[name] || 0).to_f }
+  {
+    :name => attributes['name'].b,
+    :values => %w(x y width height frameX frameY frameWidth frameHeight).collect { |name| value.call(name) },
+    :rotated => attributes['rotated'] == 'true' ? 1 : 0
+  }
+end
+
+# Sparrow finds a region with a binary search, comparing the UTF-8 bytes of the names
+regions.sort! { |r1, r2| r1[:name] <=> r2[:name] }
+
+strings = image_path.dup
+regions.each do |region|
+  region[:name_offset] = strings.bytesize
+  strings << region[:name]
+end
+
+# the format is little endian: a header, the regions and a table with all strings
+output = [MAGIC, VERSION, regions.count, 0, image_path.bytesize].pack('a4VVVV')
+
+regions.each do |region|
+  output << [region[:name_offset], region[:name].bytesize].pack('VV')
+  output << region[:values].pack('e8')
+  output << [region[:rotated]].pack('V')
+end
+
+output << strings
+
+puts "Saving output to #{output_file_path} ..."
+
+File.open output_file_path, 'wb' do |file|
+  file << output
+end
+
+puts "Finished successfully (#{regions.count} regions)."